@@ -29,6 +29,9 @@
 #define TESEO_HAL_CONFIG_H
 
 #include <iostream>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace stm {
 namespace config {
@@ -47,8 +50,31 @@ struct Configuration {
     struct Device {
         std::string tty; ///< TTY connected to Teseo
         unsigned int speed; ///< Serial port baudrate
+        std::string capture; ///< RX/TX capture file, empty to disable the capture
+        unsigned int capture_size; ///< Capture file size in bytes
+        unsigned int max_speed; ///< Highest baudrate negotiated at runtime, 0 to disable
+        unsigned int speed_threshold; ///< Line utilization (percent) triggering a baudrate upgrade
+        std::string epoch_end; ///< Sentence ending each fix epoch (e.g. "GLGSV"), learned when empty
+        unsigned int sv_status_interval; ///< Minimum interval between satellite status reports, in milliseconds
+        bool sentence_cache; ///< Reuse the decoded satellite update of repeated sentences
+        bool nmea_output; ///< Send the NMEA sentences to the framework
+        bool satellite_status; ///< Send the satellite status to the framework
+        bool queued_callbacks; ///< Call the slow slots from the event loop workers instead of the decoder thread
+        unsigned int worker_threads; ///< Number of event loop worker threads
     } device;
 
+    /**
+     * Thread settings, from the [threads.<thread name>] tables
+     */
+    struct ThreadSettings {
+        std::string policy; ///< Scheduling policy: "other", "batch", "idle", "fifo" or "rr", empty to inherit
+        int priority; ///< Real-time priority for "fifo" and "rr", nice value for "other" and "batch"
+        std::vector<unsigned int> affinity; ///< CPUs the thread may run on, empty for all CPUs
+        unsigned int stack_size; ///< Stack size in bytes, 0 for the system default
+    };
+
+    std::map<std::string, ThreadSettings> threads; ///< Thread settings by thread name
+
     /**
      * Constellations supports
      */
@@ -57,6 +57,52 @@ T get_or_default(cpptoml::option<T> opt, const T & defaultValue)
 #define READ_VAL(key, def) \
     config.key = get_or_default(cfg.get_qualified_as<decltype(def)>(#key), def)
 
+static void readThreads(const cpptoml::table & cfg)
+{
+    config.threads.clear();
+    config.threads[CFG_DEF_THREADS_READER_NAME] =
+        {CFG_DEF_THREADS_READER_POLICY, CFG_DEF_THREADS_READER_PRIORITY, {}, 0};
+    config.threads[CFG_DEF_THREADS_DECODER_NAME] =
+        {CFG_DEF_THREADS_DECODER_POLICY, CFG_DEF_THREADS_DECODER_PRIORITY, {}, 0};
+
+    auto threads = cfg.get_table("threads");
+
+    if(!threads)
+        return;
+
+    for(const auto & entry : *threads)
+    {
+        auto table = entry.second->as_table();
+
+        if(!table)
+        {
+            ALOGW("Ignore threads.%s, it isn't a table", entry.first.c_str());
+            continue;
+        }
+
+        // Unset keys keep the default settings of the thread
+        auto & thread = config.threads[entry.first];
+
+        thread.policy = get_or_default(table->get_as<string>("policy"), thread.policy);
+        thread.priority = get_or_default(table->get_as<int>("priority"), thread.priority);
+        thread.stack_size = get_or_default(table->get_as<unsigned int>("stack_size"), thread.stack_size);
+
+        if(auto affinity = table->get_array_of<int64_t>("affinity"))
+        {
+            thread.affinity.clear();
+
+            for(int64_t cpu : *affinity)
+            {
+                if(cpu >= 0)
+                    thread.affinity.push_back(static_cast<unsigned int>(cpu));
+                else
+                    ALOGW("Ignore invalid CPU %lld in threads.%s.affinity",
+                        static_cast<long long>(cpu), entry.first.c_str());
+            }
+        }
+    }
+}
+
 const Configuration & read(const string & path)
 {
     ALOGI("Parse configuration file: %s", path.c_str());
@@ -68,6 +114,19 @@ const Configuration & read(const string & path)
     ALOGI("Read configuration");
     READ_VAL(device.tty, CFG_DEF_DEVICE_TTY);
     READ_VAL(device.speed, CFG_DEF_DEVICE_SPEED);
+    READ_VAL(device.capture, CFG_DEF_DEVICE_CAPTURE);
+    READ_VAL(device.capture_size, CFG_DEF_DEVICE_CAPTURE_SIZE);
+    READ_VAL(device.max_speed, CFG_DEF_DEVICE_MAX_SPEED);
+    READ_VAL(device.speed_threshold, CFG_DEF_DEVICE_SPEED_THRESHOLD);
+    READ_VAL(device.epoch_end, CFG_DEF_DEVICE_EPOCH_END);
+    READ_VAL(device.sv_status_interval, CFG_DEF_DEVICE_SV_STATUS_INTERVAL);
+    READ_VAL(device.sentence_cache, CFG_DEF_DEVICE_SENTENCE_CACHE);
+    READ_VAL(device.nmea_output, CFG_DEF_DEVICE_NMEA_OUTPUT);
+    READ_VAL(device.satellite_status, CFG_DEF_DEVICE_SATELLITE_STATUS);
+    READ_VAL(device.queued_callbacks, CFG_DEF_DEVICE_QUEUED_CALLBACKS);
+    READ_VAL(device.worker_threads, CFG_DEF_DEVICE_WORKER_THREADS);
+
+    readThreads(cfg);
 
     READ_VAL(constellations.gps,     CFG_DEF_CONSTELLATIONS_GPS);
     READ_VAL(constellations.glonass, CFG_DEF_CONSTELLATIONS_GLONASS);
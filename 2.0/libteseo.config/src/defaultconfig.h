@@ -30,6 +30,25 @@
 
 #define CFG_DEF_DEVICE_TTY std::string("/dev/ttyAMA2")
 #define CFG_DEF_DEVICE_SPEED 115200
+#define CFG_DEF_DEVICE_CAPTURE std::string("")
+#define CFG_DEF_DEVICE_CAPTURE_SIZE 4194304
+#define CFG_DEF_DEVICE_MAX_SPEED 0
+#define CFG_DEF_DEVICE_SPEED_THRESHOLD 70
+#define CFG_DEF_DEVICE_EPOCH_END std::string("")
+#define CFG_DEF_DEVICE_SV_STATUS_INTERVAL 0
+#define CFG_DEF_DEVICE_SENTENCE_CACHE false
+#define CFG_DEF_DEVICE_NMEA_OUTPUT true
+#define CFG_DEF_DEVICE_SATELLITE_STATUS true
+#define CFG_DEF_DEVICE_QUEUED_CALLBACKS true
+#define CFG_DEF_DEVICE_WORKER_THREADS 2
+
+// The UART reader and the decoder must keep up with the receiver when the CPU is loaded
+#define CFG_DEF_THREADS_READER_NAME     std::string("ByteStreamReader")
+#define CFG_DEF_THREADS_READER_POLICY   std::string("fifo")
+#define CFG_DEF_THREADS_READER_PRIORITY 2
+#define CFG_DEF_THREADS_DECODER_NAME     std::string("teseo-decoder")
+#define CFG_DEF_THREADS_DECODER_POLICY   std::string("fifo")
+#define CFG_DEF_THREADS_DECODER_PRIORITY 1
 
 
 #define CFG_DEF_DATA_ASSISTANCE_ENABLED false
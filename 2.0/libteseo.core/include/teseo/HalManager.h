@@ -40,6 +40,7 @@ namespace stm {
 
 namespace device {
 class AbstractDevice;
+class BaudRateNegotiator;
 } // namespace device
 
 namespace decoder {
@@ -67,6 +68,11 @@ namespace straw {
 class StrawEngine;
 } // namespace straw
 
+namespace thread {
+class EventLoop;
+class Strand;
+} // namespace thread
+
 namespace ril {
 class Ril_If;
 } // namespace ril
@@ -105,11 +111,28 @@ private:
 
 	stream::IByteStream * byteStream;
 
+	device::BaudRateNegotiator * baudRateNegotiator;
+
 	stagps::StagpsEngine * stagpsEngine;
 
 	geofencing::GeofencingManager * geofencingManager;
 
 	straw::StrawEngine *rawMeasurement;
+
+	/**
+	 * HAL event loop, its workers run the slow slots and the short jobs
+	 */
+	thread::EventLoop * eventLoop;
+
+	/**
+	 * Strands of the slow slots, nullptr when the callbacks are called on the decoder thread
+	 */
+	thread::Strand * callbackStrand;
+
+	thread::Strand * geofencingStrand;
+
+	thread::Strand * rawMeasurementStrand;
+
 	stm::ril::Ril_If * rilIf;
 
 	stm::ni::Ni_If * niIf;
@@ -117,8 +140,14 @@ private:
 	stm::agps::Agps_If * AgpsIf;
 
 
+	void initThreads();
+
+	void initEventLoop();
+
 	void initUtils();
 
+	void initStrands();
+
 	void initDevice();
 
 	void initStagps();
@@ -40,6 +40,7 @@
 #include <teseo/model/NmeaMessage.h>
 #include <teseo/model/Location.h>
 #include <teseo/model/SatInfo.h>
+#include <teseo/model/SatelliteTable.h>
 #include <teseo/geofencing/model.h>
 #include <teseo/utils/Thread.h>
 
@@ -135,9 +136,9 @@ namespace gps {
 
 	void sendLocationUpdate(const Location & loc);
 
-	void sendSatelliteListUpdate(const std::map<SatIdentifier, SatInfo> & satellites);
+	void sendSatelliteListUpdate(const SatelliteTable & satellites);
 
-	void sendSatelliteListUpdate_2_0(const std::map<SatIdentifier, SatInfo> & satellites);
+	void sendSatelliteListUpdate_2_0(const SatelliteTable & satellites);
 
 	void sendCapabilities(uint32_t capabilities);
 
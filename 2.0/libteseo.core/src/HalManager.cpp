@@ -37,6 +37,9 @@
 #include <teseo/utils/http.h>
 #include <teseo/model/GpsState.h>
 #include <teseo/utils/IByteStream.h>
+#include <teseo/utils/Executor.h>
+#include <teseo/utils/EventLoop.h>
+#include <teseo/utils/Thread.h>
 #include <teseo/utils/IStream.h>
 #include <teseo/device/AbstractDevice.h>
 #include <teseo/protocol/AbstractDecoder.h>
@@ -45,6 +48,7 @@
 #include <teseo/utils/NmeaStream.h>
 #include <teseo/protocol/NmeaDecoder.h>
 #include <teseo/device/NmeaDevice.h>
+#include <teseo/device/BaudRateNegotiator.h>
 #include <teseo/protocol/NmeaEncoder.h>
 #include <teseo/geofencing/manager.h>
 
@@ -67,6 +71,23 @@
 namespace stm {
 
 using namespace stm::device;
+using thread::QueuePolicy;
+
+/**
+ * @brief      Queue the slot calls to an executor, or call it directly without executor
+ */
+template<typename ...Targs>
+static std::shared_ptr<GenericSlot<void (Targs...)>> queuedOn(
+	thread::IExecutor * executor,
+	const std::shared_ptr<GenericSlot<void (Targs...)>> & slot,
+	QueuePolicy policy,
+	std::size_t capacity = 1)
+{
+	if(executor == nullptr)
+		return slot;
+
+	return SlotFactory::queued(*executor, slot, policy, capacity);
+}
 
 HalManager HalManager::instance;
 
@@ -76,6 +97,11 @@ HalManager::HalManager() :
 	ALOGI("Create HAL manager");
 
 	device = nullptr;
+	baudRateNegotiator = nullptr;
+	eventLoop = nullptr;
+	callbackStrand = nullptr;
+	geofencingStrand = nullptr;
+	rawMeasurementStrand = nullptr;
 
 	setCapabilites.connect(SlotFactory::create(&(LocServiceProxy::gps::sendCapabilities)));
 
@@ -100,7 +126,10 @@ int HalManager::init(const sp<IGnssCallback>& cb)
 
 	ALOGI("Initialize modules");
 
+	initThreads();
+	initEventLoop();
 	initUtils();
+	initStrands();
 	initDevice();
 	initGeofencing();
 	initRawMeasurement();
@@ -128,6 +157,16 @@ int HalManager::init(const sp<IGnssCallback>& cb)
 
 void HalManager::cleanup(void)
 {
+	// Deliver the pending calls while their receivers still exist
+	for(auto strand : {callbackStrand, geofencingStrand, rawMeasurementStrand})
+	{
+		if(strand != nullptr)
+		{
+			strand->deactivate();
+			strand->waitIdle();
+		}
+	}
+
 #ifdef STAGPS_ENABLED
 	if(config::get().stagps.enable)
 	{
@@ -164,11 +203,26 @@ void HalManager::cleanup(void)
 	rawMeasurement = nullptr;
 #endif
 
+	// Its thread uses the byte stream and the device
+	if(baudRateNegotiator != nullptr)
+	{
+		baudRateNegotiator->stop();
+		delete baudRateNegotiator;
+		baudRateNegotiator = nullptr;
+	}
+
 	delete stream;
 	delete byteStream;
 	delete decoder;
 	delete device;
 
+	for(auto strand : {callbackStrand, geofencingStrand, rawMeasurementStrand})
+		delete strand;
+
+	callbackStrand = nullptr;
+	geofencingStrand = nullptr;
+	rawMeasurementStrand = nullptr;
+
 	geofencingManager = nullptr;
 	stream = nullptr;
 	byteStream = nullptr;
@@ -176,6 +230,24 @@ void HalManager::cleanup(void)
 	device = nullptr;
 
 	utils::http_cleanup();
+
+	// Last, the components above may use it until they are deleted
+	if(eventLoop != nullptr)
+	{
+		eventLoop->stop();
+		eventLoop->join();
+		delete eventLoop;
+		eventLoop = nullptr;
+	}
+}
+
+void HalManager::initEventLoop()
+{
+	ALOGI("Init event loop");
+	eventLoop = new thread::EventLoop("teseo-events", config::get().device.worker_threads);
+
+	if(eventLoop->start() != 0)
+		ALOGE("Unable to start the event loop");
 }
 
 void HalManager::initUtils()
@@ -184,16 +256,69 @@ void HalManager::initUtils()
 	utils::Wakelock::acquire.connect(SlotFactory::create(LocServiceProxy::gps::acquireWakelock));
 	utils::Wakelock::release.connect(SlotFactory::create(LocServiceProxy::gps::releaseWakelock));
 
-	utils::http_init();
+	utils::http_init(*eventLoop);
+}
+
+void HalManager::initThreads()
+{
+	ALOGI("Init thread settings");
+
+	for(const auto & entry : config::get().threads)
+	{
+		const auto & thread = entry.second;
+		ThreadSettings settings;
+
+		if(!ThreadSettings::parsePolicy(thread.policy, settings.policy))
+		{
+			ALOGE("Invalid scheduling policy '%s' for thread %s, keep the default one",
+				thread.policy.c_str(), entry.first.c_str());
+		}
+
+		settings.priority = thread.priority;
+		settings.affinity = thread.affinity;
+		settings.stackSize = thread.stack_size;
+
+		Thread::setSettings(entry.first, settings);
+	}
+}
+
+void HalManager::initStrands()
+{
+	if(!config::get().device.queued_callbacks)
+	{
+		ALOGI("Callbacks are called on the decoder thread");
+		return;
+	}
+
+	callbackStrand = new thread::Strand("teseo-callbacks", *eventLoop);
+	geofencingStrand = new thread::Strand("teseo-geofencing", *eventLoop);
+
+#ifdef STRAW_ENABLED
+	rawMeasurementStrand = new thread::Strand("teseo-straw", *eventLoop);
+#endif
 }
 
 void HalManager::initDevice()
 {
 	ALOGI("Init device");
 	device = new NmeaDevice();
-	decoder = new decoder::NmeaDecoder(*device);
+	decoder = new decoder::NmeaDecoder(
+		*device,
+		config::get().device.epoch_end,
+		config::get().device.sentence_cache);
 	encoder = new protocol::NmeaEncoder();
-	byteStream = new stream::UartByteStream(config::get().device.tty, config::get().device.speed);
+	auto uart = new stream::UartByteStream(config::get().device.tty, config::get().device.speed);
+	byteStream = uart;
+
+	if(!config::get().device.capture.empty())
+	{
+		auto recorder = std::make_shared<stream::capture::CaptureRecorder>();
+
+		if(recorder->open(config::get().device.capture, config::get().device.capture_size))
+			uart->setCaptureRecorder(recorder);
+		else
+			ALOGE("Unable to create capture file %s", config::get().device.capture.c_str());
+	}
 	stream = new stream::NmeaStream();
 
 
@@ -216,15 +341,59 @@ void HalManager::initDevice()
 	device->stopNavigation.connect(SlotFactory::create(*decoder, &decoder::AbstractDecoder::stop));
 	device->stopNavigation.connect(SlotFactory::create(*byteStream, &stream::IByteStream::stop));
 
+	// Strands are active while the navigation is started, the queued slots are called directly otherwise
+	for(auto strand : {callbackStrand, geofencingStrand, rawMeasurementStrand})
+	{
+		if(strand == nullptr)
+			continue;
+
+		device->startNavigation.connect(SlotFactory::create(*strand, &thread::Strand::activate));
+		device->stopNavigation.connect(SlotFactory::create(*strand, &thread::Strand::deactivate));
+	}
+
+	// Runtime baudrate upgrade, running while the navigation is started
+	baudRateNegotiator = nullptr;
+	if(config::get().device.max_speed > config::get().device.speed)
+	{
+		baudRateNegotiator = new BaudRateNegotiator(
+			*device,
+			*byteStream,
+			config::get().device.max_speed,
+			config::get().device.speed_threshold);
+
+		device->onNmea.connect(SlotFactory::create(*baudRateNegotiator, &BaudRateNegotiator::onNmea));
+		device->startNavigation.connect(SlotFactory::create(*baudRateNegotiator, &BaudRateNegotiator::start));
+		device->stopNavigation.connect(SlotFactory::create(*baudRateNegotiator, &BaudRateNegotiator::stop));
+	}
+
 	// Data model updates
 	auto & gpsSignals = LocServiceProxy::gps::getSignals();
 	gpsSignals.start.connect(SlotFactory::create(*device, &AbstractDevice::start));
 	gpsSignals.stop.connect(SlotFactory::create(*device, &AbstractDevice::stop));
 
-	device->onNmea.connect(SlotFactory::create(LocServiceProxy::gps::sendNmea));
-	device->locationUpdate.connect(SlotFactory::create(LocServiceProxy::gps::sendLocationUpdate));
-	device->satelliteListUpdate.connect(SlotFactory::create(LocServiceProxy::gps::sendSatelliteListUpdate));
-	device->statusUpdate.connect(SlotFactory::create(LocServiceProxy::gps::sendStatusUpdate));
+	// Framework callbacks, a slow binder call doesn't delay the decoding of the next sentences
+	unsigned int frameworkProducts = AbstractDevice::PRODUCT_LOCATION;
+
+	if(config::get().device.nmea_output)
+	{
+		device->onNmea.connect(queuedOn(callbackStrand,
+			SlotFactory::create(LocServiceProxy::gps::sendNmea), QueuePolicy::DROP_OLDEST, 64));
+	}
+
+	device->locationUpdate.connect(queuedOn(callbackStrand,
+		SlotFactory::create(LocServiceProxy::gps::sendLocationUpdate), QueuePolicy::DROP_OLDEST, 4));
+
+	if(config::get().device.satellite_status)
+	{
+		device->satelliteListUpdate.connect(queuedOn(callbackStrand,
+			SlotFactory::create(LocServiceProxy::gps::sendSatelliteListUpdate), QueuePolicy::COALESCE));
+		frameworkProducts |= AbstractDevice::PRODUCT_SATELLITES;
+	}
+
+	device->setDemand("framework", frameworkProducts);
+
+	device->statusUpdate.connect(queuedOn(callbackStrand,
+		SlotFactory::create(LocServiceProxy::gps::sendStatusUpdate), QueuePolicy::NEVER_DROP, 8));
 
 	device->requestUtcTime.connect(SlotFactory::create(LocServiceProxy::gps::requestUtcTime));
 
@@ -307,7 +476,10 @@ void HalManager::initGeofencing()
     geofencingSignals.pauseGeofence.connect(SlotFactory::create(*geofencingManager, &GeofencingManager::pause));
     geofencingSignals.resumeGeofence.connect(SlotFactory::create(*geofencingManager, &GeofencingManager::resume));
 
-    device->locationUpdate.connect(SlotFactory::create(*geofencingManager, &GeofencingManager::onLocationUpdate));
+    // Only the latest location matters to check the geofences
+    device->locationUpdate.connect(queuedOn(geofencingStrand,
+        SlotFactory::create(*geofencingManager, &GeofencingManager::onLocationUpdate), QueuePolicy::COALESCE));
+    device->setDemand("geofencing", AbstractDevice::PRODUCT_LOCATION);
     device->statusUpdate.connect(SlotFactory::create(*geofencingManager, &GeofencingManager::onDeviceStatusUpdate));
 }
 
@@ -327,7 +499,10 @@ void HalManager::initRawMeasurement(void)
 	rawMeasurement->sendMeasurements.connect(SlotFactory::create(LocServiceProxy::measurement::sendMeasurements));
 	rawMeasurement->sendNavigationMessages.connect(SlotFactory::create(LocServiceProxy::navigationMessage::sendNavigationMessages));
 
-	device->onNmea.connect(SlotFactory::create(*rawMeasurement, &StrawEngine::onNmeaMessage));
+	// The raw measurement engine only reads proprietary sentences
+	device->connectNmea(queuedOn(rawMeasurementStrand,
+			SlotFactory::create(*rawMeasurement, &StrawEngine::onNmeaMessage), QueuePolicy::NEVER_DROP, 64),
+		model::SentenceFilter().family(utils::SentenceFamily::PROPRIETARY));
 
 	auto & navSignals = LocServiceProxy::navigationMessage::getSignals();
 	navSignals.init.connect(SlotFactory::create(*rawMeasurement, &StrawEngine::initNavigationMessages));
@@ -32,6 +32,11 @@
 #include <teseo/LocServiceProxy.h>
 
 #include <string.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <unordered_map>
 #include <string_view>
 #include <vector>
@@ -44,7 +49,6 @@ namespace stm {
 namespace LocServiceProxy {
 
 sp<IGnssCallback> sGnssCallback = nullptr;
-std::vector<std::unique_ptr<Thread::ThreadFuncArgs>> sThreadFuncArgsList;
 
 sp<IAGnssCallback> sAGnssCallback = nullptr;
 sp<IAGnssRilCallback> sAGnssRilCallback = nullptr;
@@ -55,7 +59,7 @@ sp<IGnssNavigationMessageCallback> sGnssNavigationMsgCallback = nullptr;
 
 pthread_t createThreadCb(const char* name, void (*start)(void*), void* arg) {
 
-    return Thread::createPthread(name, start, arg, &sThreadFuncArgsList);
+    return Thread::createPthread(name, start, arg);
 }
 
 void openDevice(void)
@@ -91,15 +95,18 @@ Signals & getSignals()
 
 int onInit(const sp<IGnssCallback>& cb)
 {
+	svStatusReset = true;
 	sGnssCallback = cb;
-	signals.init.emit(sGnssCallback);
+	// The HAL event loop is started during the initialization
 	Thread::setCreateThreadCb(createThreadCb);
+	signals.init.emit(sGnssCallback);
 
 	return 0;
 }
 
 int onStart(void)
 {
+	svStatusReset = true;
 	signals.start.emit();
 
 	return 0;
@@ -160,10 +167,16 @@ int onGetGNSSConstellationMask(void)
 
 void sendNmea(GnssUtcTime timestamp, const NmeaMessage & nmea)
 {
-	std::string asString = nmea.toString();
+	// HIDL external strings must be NUL terminated, the raw sentence is copied in a buffer reused
+	// for each sentence. Sentences are sent from the event loop workers, or from the decoder
+	// thread when the callbacks aren't queued: each thread has its own buffer.
+	static thread_local std::string buffer;
+
+	ByteView raw = nmea.raw();
+	buffer.assign(reinterpret_cast<const char *>(raw.data()), raw.size());
 
 	android::hardware::hidl_string nmeaString;
-	nmeaString.setToExternal(asString.c_str(), asString.size());
+	nmeaString.setToExternal(buffer.c_str(), buffer.size());
 
 	sGnssCallback->gnssNmeaCb(timestamp, nmeaString);
 }
@@ -197,85 +210,104 @@ void sendLocationUpdate(const Location & loc)
 	sGnssCallback->gnssLocationCb_2_0(location);
 }
 
-void sendSatelliteListUpdate(const std::map<SatIdentifier, SatInfo>& satellites)
-{
-	GnssSvInfo_2_0 svInfo;
-	std::vector<GnssSvInfo_2_0> svInfoList;
-
-	int gpsSats = 0;
-	int sbaSats = 0;
-	int gloSats = 0;
-	int qzsSats = 0;
-	int beiSats = 0;
-	int galSats = 0;
-	int irnSats = 0;
-	int otherSats = 0;
-	int totalSats = 0;
-
-    auto action = [&] (auto & p) {
-        p.second.copyToGnssSvInfo(&svInfo.v1_0);
-        svInfo.constellation = p.second.getId().getConstellation();
-        svInfoList.push_back(svInfo);
-
-        switch(p.second.getId().getConstellation()) {
-            case GnssConstellationType::GPS:
-                gpsSats++;
-                svInfo.constellation = GnssConstellationType::GPS;
-                break;
-            case GnssConstellationType::SBAS:
-                sbaSats++;
-                svInfo.constellation = GnssConstellationType::SBAS;
-                break;
-            case GnssConstellationType::GLONASS:
-                gloSats++;
-                svInfo.constellation = GnssConstellationType::GLONASS;
-                break;
-            case GnssConstellationType::QZSS:
-                qzsSats++;
-                svInfo.constellation = GnssConstellationType::QZSS;
-                break;
-            case GnssConstellationType::BEIDOU:
-                beiSats++;
-                svInfo.constellation = GnssConstellationType::BEIDOU;
-                break;
-            case GnssConstellationType::GALILEO:
-                galSats++;
-                svInfo.constellation = GnssConstellationType::GALILEO;
-                break;
-            case GnssConstellationType::IRNSS:
-                irnSats++;
-                svInfo.constellation = GnssConstellationType::IRNSS;
-                break;
-            default:
-                otherSats++;
-                break;
-        }
-        totalSats++;
-    };
-
-	if(satellites.size() < static_cast<uint32_t>(GnssMax::SVS_COUNT))
+/**
+ * Satellite status reporting state, guarded by svStatusMutex
+ *
+ * The status is built in one of two preallocated lists, then compared to the last sent list:
+ * unchanged lists aren't sent again. The status is sent from the event loop workers, or from the
+ * decoder thread when the callbacks aren't queued, so two updates may be sent concurrently.
+ */
+static struct {
+	std::array<GnssSvInfo_2_0, static_cast<std::size_t>(GnssMax::SVS_COUNT)> lists[2];
+	std::size_t sizes[2];
+	std::size_t sent;
+	bool hasSent;
+	std::chrono::steady_clock::time_point lastSend;
+} svStatus = {};
+
+static std::mutex svStatusMutex;
+
+/**
+ * Set from the binder threads to send the next satellite status even if unchanged
+ */
+static std::atomic<bool> svStatusReset(true);
+
+static bool sameSvInfo(const GnssSvInfo_2_0 & a, const GnssSvInfo_2_0 & b)
+{
+	return a.constellation == b.constellation &&
+	       a.v1_0.svid == b.v1_0.svid &&
+	       a.v1_0.cN0Dbhz == b.v1_0.cN0Dbhz &&
+	       a.v1_0.elevationDegrees == b.v1_0.elevationDegrees &&
+	       a.v1_0.azimuthDegrees == b.v1_0.azimuthDegrees &&
+	       a.v1_0.svFlag == b.v1_0.svFlag;
+}
+
+void sendSatelliteListUpdate(const SatelliteTable & satellites)
+{
+	// Held until the callback returns, the HIDL vector points to the preallocated list
+	std::lock_guard<std::mutex> lock(svStatusMutex);
+
+	// Satellite count per constellation, unknown constellations are counted in index 0
+	std::array<int, static_cast<std::size_t>(GnssConstellationType::IRNSS) + 1> counts = {};
+
+	const std::size_t next = svStatus.sent ^ 1;
+	auto & list = svStatus.lists[next];
+	std::size_t size = 0;
+
+	// Satellites are ordered by PRN, the list is truncated to GnssMax::SVS_COUNT satellites
+	for(const SatInfo & sat : satellites)
 	{
-		std::for_each(satellites.begin(), satellites.end(), action);
+		if(size == list.size())
+			break;
+
+		GnssSvInfo_2_0 & svInfo = list[size++];
+		sat.copyToGnssSvInfo(&svInfo.v1_0);
+		svInfo.constellation = sat.getId().getConstellation();
+
+		std::size_t index = static_cast<std::size_t>(svInfo.constellation);
+		counts[index < counts.size() ? index : 0]++;
 	}
-	else
+
+	svStatus.sizes[next] = size;
+
+	if(svStatusReset.exchange(false))
+		svStatus.hasSent = false;
+
+	if(svStatus.hasSent)
 	{
-		auto it = satellites.begin();
-		for(uint32_t i = 0; i < static_cast<uint32_t>(GnssMax::SVS_COUNT); i++) {
-			action(*it);
-			++it;
-		}
+		const auto & last = svStatus.lists[svStatus.sent];
+
+		// Nothing changed since the last report
+		if(size == svStatus.sizes[svStatus.sent] &&
+		   std::equal(list.begin(), list.begin() + size, last.begin(), sameSvInfo))
+			return;
+
+		// Changes are reported at the next epoch after the minimum interval
+		auto interval = std::chrono::milliseconds(config::get().device.sv_status_interval);
+
+		if(std::chrono::steady_clock::now() - svStatus.lastSend < interval)
+			return;
 	}
 
-	ALOGI("Send satellite list: %d satellites, %d gps, %d sbas, %d glonass, %d qzss, %d beidou, %d galileo, %d irnss, %d others",
-		totalSats,
-        gpsSats,
-        sbaSats,
-        gloSats,
-        qzsSats,
-        beiSats,
-        galSats,
-        irnSats,
-        otherSats);
+	svStatus.sent = next;
+	svStatus.hasSent = true;
+	svStatus.lastSend = std::chrono::steady_clock::now();
+
+	ALOGI("Send satellite list: %zu satellites, %d gps, %d sbas, %d glonass, %d qzss, %d beidou, %d galileo, %d irnss, %d others",
+		size,
+		counts[static_cast<std::size_t>(GnssConstellationType::GPS)],
+		counts[static_cast<std::size_t>(GnssConstellationType::SBAS)],
+		counts[static_cast<std::size_t>(GnssConstellationType::GLONASS)],
+		counts[static_cast<std::size_t>(GnssConstellationType::QZSS)],
+		counts[static_cast<std::size_t>(GnssConstellationType::BEIDOU)],
+		counts[static_cast<std::size_t>(GnssConstellationType::GALILEO)],
+		counts[static_cast<std::size_t>(GnssConstellationType::IRNSS)],
+		counts[0]);
+
+	// The HIDL vector points to the preallocated list
+	android::hardware::hidl_vec<GnssSvInfo_2_0> svInfoList;
+	svInfoList.setToExternal(list.data(), size);
+
 	sGnssCallback->gnssSvStatusCb_2_0(svInfoList);
 }
 
@@ -28,17 +28,23 @@
 #ifndef TESEO_HAL_ABSTRACT_DEVICE_H
 #define TESEO_HAL_ABSTRACT_DEVICE_H
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #include <teseo/utils/any.h>
 #include <teseo/utils/result.h>
 #include <teseo/utils/Signal.h>
+#include <teseo/utils/SeqLock.h>
 #include <teseo/model/Message.h>
 #include <teseo/model/NmeaMessage.h>
 #include <teseo/model/Location.h>
 #include <teseo/model/SatInfo.h>
+#include <teseo/model/SatelliteTable.h>
+#include <teseo/model/SentenceFilter.h>
 #include <teseo/model/Version.h>
 #include <teseo/model/Stagps.h>
 #include <teseo/utils/Thread.h>
@@ -66,23 +72,105 @@ namespace device {
 class AbstractDevice :
 	public Trackable
 {
-private:
-	const static ByteVector nmeaSequenceStart;
+public:
+	/**
+	 * @brief      Data products computed by the decoders, as bit field
+	 *
+	 * @details    A product is demanded while a consumer declared it with setDemand(). The decoders
+	 * feeding only products nobody demands are skipped.
+	 */
+	enum DataProduct : unsigned int {
+		PRODUCT_NONE       = 0,
+		PRODUCT_LOCATION   = 1, ///< locationUpdate
+		PRODUCT_SATELLITES = 2  ///< satelliteListUpdate
+	};
+
+	using NmeaSlot = GenericSlot<void (GnssUtcTime, const NmeaMessage &)>;
 
+	/**
+	 * @brief      Device state published at the end of each epoch
+	 */
+	struct Snapshot {
+		ValueContainer<GnssUtcTime> timestamp;
+
+		ValueContainer<Location> location;
+
+		SatelliteTable satellites;
+	};
+
+private:
 	// ======================== Data Model =====================
+	// Written by the decoder thread only, other threads read the published snapshots
 
 	ValueContainer<GnssUtcTime> timestamp;
 
+	/**
+	 * Location of the last published epoch
+	 */
 	ValueContainer<Location> location;
 
-	ValueContainer<std::map<SatIdentifier, SatInfo>> satellites;
+	/**
+	 * Location of the current epoch, updated in place by the decoders
+	 */
+	Location epochLocation;
+
+	bool epochLocationUpdated;
+
+	SatelliteTable satellites;
+
+	/**
+	 * Published fix, small enough to be copied by each scalar getter
+	 */
+	struct PublishedFix {
+		uint32_t epoch;
+		ValueContainer<GnssUtcTime> timestamp;
+		ValueContainer<Location> location;
+	};
 
-	ValueContainer<std::unordered_map<std::string, model::Version>> versions;
+	/**
+	 * Published satellite table, only copied by the readers of the satellites
+	 */
+	struct PublishedSatellites {
+		uint32_t epoch;
+		SatelliteTable satellites;
+	};
+
+	uint32_t publishedEpochs;
+
+	utils::SeqLock<PublishedFix> publishedFix;
+
+	utils::SeqLock<PublishedSatellites> publishedSatellites;
+
+	using VersionMap = std::unordered_map<std::string, model::Version>;
+
+	/**
+	 * Product versions, replaced as a whole on each new version with std::atomic_store
+	 */
+	std::shared_ptr<const VersionMap> versions;
 
-	int gnssConstMask;
+	std::atomic<int> gnssConstMask;
 
 	DrInfo drInfo;
 
+	struct NmeaSubscription {
+		model::SentenceFilter filter;
+		NmeaSlot::ptr slot;
+	};
+
+	std::vector<NmeaSubscription> nmeaSubscriptions;
+
+	std::mutex demandMutex;
+
+	/**
+	 * Products declared by each consumer
+	 */
+	std::map<std::string, unsigned int> demands;
+
+	/**
+	 * Union of the declared products, read by the decoder thread
+	 */
+	std::atomic<unsigned int> demanded;
+
 protected:
 
 	// Allow NmeaDecoder to use emitNmea
@@ -105,18 +193,24 @@ protected:
 	void setTimestamp(GnssUtcTime timestamp);
 
 	/**
-	 * @brief      Set the device location.
+	 * @brief      Get the location of the current epoch
+	 *
+	 * @details    The decoders update the returned location in place. It starts from the last
+	 * published location and is published as a whole by publishEpoch().
 	 *
-	 * @param[in]  loc New device location
+	 * @return     The location of the current epoch
 	 */
-	void setLocation(const Location & loc);
+	Location & buildLocation();
 
 	/**
-	 * @brief      Add or update satellite
+	 * @brief      Get a satellite to update in place, insert it if needed
 	 *
-	 * @param[in]  sat New satellite information to store
+	 * @param[in]  id    Identifier of the satellite to update
+	 *
+	 * @return     The satellite information and true if it was inserted. The satellite information
+	 * is nullptr when the PRN is unknown.
 	 */
-	void addSatellite(const SatInfo & sat);
+	std::pair<SatInfo *, bool> updateSatellite(const SatIdentifier & id);
 
 	/**
 	 * @brief      Clear the satellite list
@@ -128,6 +222,9 @@ protected:
 	/**
 	 * @brief      Emit a NMEA message
 	 *
+	 * @details    The message is sent to the onNmea slots, and to the subscribers whose filter
+	 * matches it.
+	 *
 	 * @param[in]  nmea  The nmea message to emit
 	 */
 	void emitNmea(const NmeaMessage & nmea);
@@ -139,9 +236,11 @@ protected:
 	void update();
 
 	/**
-	 * @brief Trigger device update if sentence id is equal to trigger
+	 * @brief      Publish the current epoch
+	 * @details    Publish the location of the current epoch and the device snapshot, trigger the
+	 * device update, then clear the satellite list before the next epoch.
 	 */
-	void updateIfStartSentenceId(const ByteVector & sentenceId);
+	void publishEpoch();
 
 public:
 
@@ -150,6 +249,43 @@ public:
 	 */
 	virtual ~AbstractDevice() { }
 
+	/**
+	 * @brief      Declare the data products a consumer needs
+	 *
+	 * @details    A consumer declares the products it uses, and declares PRODUCT_NONE when it stops
+	 * using them. A slot connected to an update signal doesn't demand the product by itself.
+	 *
+	 * @param[in]  consumer  The consumer name
+	 * @param[in]  products  Combination of DataProduct values
+	 */
+	void setDemand(const std::string & consumer, unsigned int products);
+
+	/**
+	 * @brief      Get the data products demanded by the consumers
+	 *
+	 * @return     Combination of DataProduct values
+	 */
+	unsigned int demandedProducts() const;
+
+	/**
+	 * @brief      Subscribe to some NMEA sentences
+	 *
+	 * @details    Unlike onNmea slots, the slot is only called for the sentences matching the filter.
+	 * Subscriptions must be made before the decoding starts.
+	 *
+	 * @param[in]  slot    The slot to call
+	 * @param[in]  filter  The sentences to send to the slot
+	 */
+	void connectNmea(const NmeaSlot::ptr & slot, const model::SentenceFilter & filter);
+
+	/**
+	 * @brief      Gets the device state of the last published epoch
+	 *
+	 * @details    Can be called from any thread, it never blocks the decoder. The fix and the
+	 * satellite table are published separately, the other getters only copy the part they read.
+	 */
+	Snapshot getSnapshot() const;
+
 	/**
 	 * @brief      Gets the current utc-time as reported by the Teseo
 	 *
@@ -265,7 +401,7 @@ public:
 	Signal<int> stopNavigation;
 
 	/**
-	 * NMEA signal
+	 * NMEA signal, emitted for all the sentences
 	 */
 	Signal<void, GnssUtcTime, const NmeaMessage &> onNmea;
 
@@ -277,7 +413,7 @@ public:
 	/**
 	 * Satellite list update signal
 	 */
-	Signal<void, const std::map<SatIdentifier, SatInfo> &> satelliteListUpdate;
+	Signal<void, const SatelliteTable &> satelliteListUpdate;
 
 	Signal<void, GnssStatusValue> statusUpdate;
 
@@ -0,0 +1,193 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @brief Runtime UART baudrate negotiation
+ * @file BaudRateNegotiator.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2016, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_DEVICE_BAUDRATE_NEGOTIATOR_H
+#define TESEO_HAL_DEVICE_BAUDRATE_NEGOTIATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+
+#include <teseo/utils/Thread.h>
+#include <teseo/utils/Channel.h>
+#include <teseo/utils/Signal.h>
+#include <teseo/model/NmeaMessage.h>
+#include <teseo/utils/Gnss_2_0.h>
+
+namespace stm {
+namespace stream {
+class IByteStream;
+} // namespace stream
+
+namespace device {
+
+class AbstractDevice;
+
+/**
+ * @brief      Runtime baudrate upgrade
+ *
+ * @details    The negotiator samples the number of bytes received on the UART every second. When
+ * the average line utilization stays above the configured threshold, the Teseo is switched to the
+ * next speed of its NMEA port speed ladder (CDB 102) and the UART follows. The new speed is
+ * validated by receiving valid NMEA sentences, otherwise the previous speed is restored. If the
+ * link is lost, for example because the Teseo kept a speed saved during a previous session, every
+ * supported speed is probed until the link is back.
+ */
+class BaudRateNegotiator :
+	public Trackable,
+	public Thread
+{
+private:
+	AbstractDevice & device;
+
+	stream::IByteStream & byteStream;
+
+	unsigned int maxSpeed;
+
+	unsigned int threshold;
+
+	/**
+	 * Wake up channel, used to interrupt waits when the negotiator is stopped
+	 */
+	thread::Channel<int> wakeupChannel;
+
+	std::atomic<bool> stopRequested;
+
+	std::mutex lifecycleMutex;
+
+	/**
+	 * True between start() and stop(), even before the thread runs
+	 */
+	bool started;
+
+	/**
+	 * Number of valid NMEA sentences decoded
+	 */
+	std::atomic<uint64_t> validSentences;
+
+	/**
+	 * Speeds the Teseo failed to switch to, they are not tried again
+	 */
+	std::set<unsigned int> failedSpeeds;
+
+	/**
+	 * @brief      Wait for a given duration
+	 *
+	 * @return     False if the negotiator was stopped during the wait
+	 */
+	bool wait(std::chrono::milliseconds duration);
+
+	/**
+	 * @brief      Wait for valid NMEA sentences at the current UART speed
+	 *
+	 * @return     True if the link is working
+	 */
+	bool verifyLink();
+
+	/**
+	 * @brief      Request the Teseo to use a new NMEA port speed
+	 *
+	 * @details    The speed is saved in the Teseo configuration and applied by a software reset.
+	 */
+	void sendSpeedChange(unsigned int speed);
+
+	/**
+	 * @brief      Switch Teseo and UART to a higher speed
+	 *
+	 * @return     True if the link works at the new speed
+	 */
+	bool upgrade(unsigned int speed);
+
+	/**
+	 * @brief      Look for the speed used by the Teseo
+	 *
+	 * @return     True if the link has been recovered
+	 */
+	bool probe();
+
+	/**
+	 * @brief      Get the next speed in the ladder, 0 if there is none
+	 */
+	unsigned int nextSpeed(unsigned int speed) const;
+
+protected:
+	virtual void run();
+
+public:
+	/**
+	 * @brief      Baudrate negotiator constructor
+	 *
+	 * @param      device      The device used to send the speed change commands
+	 * @param      byteStream  The UART byte stream
+	 * @param[in]  maxSpeed    The highest speed to negotiate
+	 * @param[in]  threshold   Line utilization, in percent, triggering an upgrade
+	 */
+	BaudRateNegotiator(
+		AbstractDevice & device,
+		stream::IByteStream & byteStream,
+		unsigned int maxSpeed,
+		unsigned int threshold);
+
+	virtual ~BaudRateNegotiator();
+
+	/**
+	 * @brief      Start the negotiator thread
+	 *
+	 * @details    The stop request is cleared before the thread is created, so a stop() following
+	 * closely isn't lost.
+	 *
+	 * @return     0 on success, 1 on failure
+	 */
+	int start();
+
+	/**
+	 * @brief      Stop the negotiator thread and wait for its end
+	 *
+	 * @details    It waits for the thread even if it didn't run yet.
+	 *
+	 * @return     0 on success, -1 if the thread is already stopped
+	 */
+	virtual int stop();
+
+	/**
+	 * @brief      NMEA sentence slot, used to validate the link
+	 */
+	void onNmea(GnssUtcTime timestamp, const NmeaMessage & nmea);
+
+	/**
+	 * @brief      Get the Teseo CDB 102 value of a speed
+	 *
+	 * @return     The CDB 102 value, or -1 if the speed isn't supported
+	 */
+	static int speedCode(unsigned int speed);
+};
+
+} // namespace device
+} // namespace stm
+
+#endif // TESEO_HAL_DEVICE_BAUDRATE_NEGOTIATOR_H
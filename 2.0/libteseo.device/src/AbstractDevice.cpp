@@ -40,9 +40,12 @@ using namespace stm::model;
 namespace stm {
 namespace device {
 
-const ByteVector AbstractDevice::nmeaSequenceStart {'G', 'G', 'A'};
-
-AbstractDevice::AbstractDevice()
+AbstractDevice::AbstractDevice() :
+	epochLocationUpdated(false),
+	publishedEpochs(0),
+	versions(std::make_shared<const VersionMap>()),
+	gnssConstMask(0),
+	demanded(PRODUCT_NONE)
 { }
 
 void AbstractDevice::init()
@@ -51,24 +54,20 @@ void AbstractDevice::init()
 	gnssConstMask = 0;
 }
 
-void AbstractDevice::setLocation(const Location & loc)
+Location & AbstractDevice::buildLocation()
 {
-	location.set(loc);
+	epochLocationUpdated = true;
+	return epochLocation;
 }
 
-void AbstractDevice::addSatellite(const SatInfo & sat)
+std::pair<SatInfo *, bool> AbstractDevice::updateSatellite(const SatIdentifier & id)
 {
-	if(!satellites)
-		satellites.set(std::map<SatIdentifier, SatInfo>());
-
-	auto & sats = *satellites;
-	sats[sat.getId()] = sat;
+	return satellites.insert(id);
 }
 
 void AbstractDevice::clearSatelliteList()
 {
-	satellites->clear();
-	satellites.invalidate();
+	satellites.clear();
 }
 
 DrInfo & AbstractDevice::getDrInfo()
@@ -76,38 +75,50 @@ DrInfo & AbstractDevice::getDrInfo()
 	return this->drInfo;
 }
 
+AbstractDevice::Snapshot AbstractDevice::getSnapshot() const
+{
+	PublishedFix fix;
+	PublishedSatellites sats;
+
+	// The satellites are published first, retry until both parts come from the same epoch
+	do
+	{
+		publishedFix.load(fix);
+		publishedSatellites.load(sats);
+	}
+	while(fix.epoch != sats.epoch);
+
+	return {fix.timestamp, fix.location, sats.satellites};
+}
+
 Result<GnssUtcTime, ValueStatus> AbstractDevice::getTimestamp() const
 {
-	if(this->timestamp)
-		return *timestamp;
+	PublishedFix fix = publishedFix.load();
 
-	return timestamp.getStatus();
+	if(fix.timestamp)
+		return *fix.timestamp;
+
+	return fix.timestamp.getStatus();
 }
 
 Result<Location, ValueStatus> AbstractDevice::getLocation() const
 {
-	if(this->location)
-		return *location;
+	PublishedFix fix = publishedFix.load();
+
+	if(fix.location)
+		return *fix.location;
 
-	return location.getStatus();
+	return fix.location.getStatus();
 }
 
 Result<SatInfo, ValueStatus> AbstractDevice::getSatellite(const SatIdentifier & id) const
 {
-	if(!satellites)
-		return ValueStatus::NOT_AVAILABLE;
+	PublishedSatellites sats = publishedSatellites.load();
 
-	auto & sats = *satellites;
-	auto it = sats.find(id);
+	if(const SatInfo * sat = sats.satellites.find(id))
+		return *sat;
 
-	if(it != sats.end())
-	{
-		return it->second;
-	}
-	else
-	{
-		return ValueStatus::NOT_AVAILABLE;
-	}
+	return ValueStatus::NOT_AVAILABLE;
 }
 
 void AbstractDevice::update()
@@ -120,16 +131,24 @@ void AbstractDevice::update()
 	satelliteListUpdate(this->satellites);
 }
 
-void AbstractDevice::updateIfStartSentenceId(const ByteVector & sentenceId)
+void AbstractDevice::publishEpoch()
 {
-	if(sentenceId == nmeaSequenceStart)
+	// Publish the epoch location in one copy, readers never see a partially decoded epoch
+	if(epochLocationUpdated)
 	{
-		// Trigger updates
-		update();
-
-		// Clear data before starting new sequence
-		this->clearSatelliteList();
+		location.set(epochLocation);
+		epochLocationUpdated = false;
 	}
+
+	publishedEpochs++;
+	publishedSatellites.store({publishedEpochs, satellites});
+	publishedFix.store({publishedEpochs, timestamp, location});
+
+	// Trigger updates
+	update();
+
+	// Clear data before starting new sequence
+	this->clearSatelliteList();
 }
 
 int AbstractDevice::start()
@@ -164,29 +183,69 @@ int AbstractDevice::stop()
 void AbstractDevice::setTimestamp(GnssUtcTime t)
 {
 	timestamp = t;
-	location->timestamp(t);
+	buildLocation().timestamp(t);
 }
 
 void AbstractDevice::emitNmea(const NmeaMessage & nmea)
 {
-	onNmea(timestamp, nmea);
+	if(onNmea.isConnected())
+		onNmea(timestamp, nmea);
+
+	for(const auto & subscription : nmeaSubscriptions)
+	{
+		if(subscription.filter.matches(nmea) && subscription.slot->isValid())
+			subscription.slot->call(timestamp, nmea);
+	}
+}
+
+void AbstractDevice::setDemand(const std::string & consumer, unsigned int products)
+{
+	std::lock_guard<std::mutex> lock(demandMutex);
+
+	if(products == PRODUCT_NONE)
+		demands.erase(consumer);
+	else
+		demands[consumer] = products;
+
+	unsigned int all = PRODUCT_NONE;
+
+	for(const auto & demand : demands)
+		all |= demand.second;
+
+	ALOGI("Consumer %s demands 0x%x, demanded products: 0x%x", consumer.c_str(), products, all);
+	demanded.store(all, std::memory_order_relaxed);
+}
+
+unsigned int AbstractDevice::demandedProducts() const
+{
+	return demanded.load(std::memory_order_relaxed);
+}
+
+void AbstractDevice::connectNmea(const NmeaSlot::ptr & slot, const model::SentenceFilter & filter)
+{
+	nmeaSubscriptions.push_back({filter, slot});
 }
 
 Result<Version, ValueStatus>
 	AbstractDevice::getProductVersion(const std::string & productName) const
 {
-	if(versions->size() == 0)
-		return ValueStatus::NOT_AVAILABLE;
+	std::shared_ptr<const VersionMap> current = std::atomic_load(&versions);
 
-	if(versions->count(productName) == 0)
+	auto it = current->find(productName);
+
+	if(it == current->end())
 		return ValueStatus::NOT_AVAILABLE;
 
-	return versions->at(productName);
+	return it->second;
 }
 
 void AbstractDevice::newVersionNumber(const model::Version & version)
 {
-	(*versions)[version.getProduct()] = version;
+	// Versions are rarely received, copy the map so readers keep a consistent one
+	auto updated = std::make_shared<VersionMap>(*std::atomic_load(&versions));
+	(*updated)[version.getProduct()] = version;
+	std::atomic_store(&versions, std::shared_ptr<const VersionMap>(std::move(updated)));
+
 	onVersionNumber(version);
 }
 
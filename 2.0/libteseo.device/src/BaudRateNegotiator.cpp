@@ -0,0 +1,370 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @brief Runtime UART baudrate negotiation
+ * @file BaudRateNegotiator.cpp
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2016, STMicroelectronics, All rights reserved.
+ */
+
+#include <teseo/device/BaudRateNegotiator.h>
+
+#define LOG_TAG "teseo_hal_BaudRateNegotiator"
+#include <log/log.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <teseo/device/AbstractDevice.h>
+#include <teseo/model/Message.h>
+#include <teseo/utils/IByteStream.h>
+
+namespace stm {
+namespace device {
+
+using namespace std::chrono;
+using model::Message;
+using model::MessageId;
+
+/**
+ * Teseo NMEA port speed ladder, with the matching CDB 102 values
+ */
+static const std::vector<std::pair<unsigned int, int>> speedLadder = {
+	{9600,   0x5},
+	{19200,  0x7},
+	{38400,  0x8},
+	{57600,  0x9},
+	{115200, 0xA},
+	{230400, 0xB},
+	{460800, 0xC},
+	{921600, 0xD}
+};
+
+/**
+ * Line utilization sampling period
+ */
+static constexpr milliseconds SAMPLE_PERIOD(1000);
+
+/**
+ * Number of samples in the utilization moving average
+ */
+static constexpr unsigned int SAMPLE_WINDOW = 5;
+
+/**
+ * Time for the Teseo to apply the new speed after the software reset
+ */
+static constexpr milliseconds RESET_DELAY(200);
+
+/**
+ * Maximum time to receive VERIFY_SENTENCES valid sentences after a speed change
+ */
+static constexpr milliseconds VERIFY_TIMEOUT(3000);
+
+static constexpr uint64_t VERIFY_SENTENCES = 3;
+
+/**
+ * Number of sampling periods without valid sentence before the link is considered lost
+ */
+static constexpr unsigned int LINK_LOSS_PERIODS = 5;
+
+/**
+ * Probing backoff bounds, when no speed works
+ */
+static constexpr milliseconds PROBE_BACKOFF_MIN(1000);
+
+static constexpr milliseconds PROBE_BACKOFF_MAX(60000);
+
+BaudRateNegotiator::BaudRateNegotiator(
+	AbstractDevice & device,
+	stream::IByteStream & byteStream,
+	unsigned int maxSpeed,
+	unsigned int threshold) :
+	Trackable(),
+	Thread("teseo-baudrate"),
+	device(device),
+	byteStream(byteStream),
+	maxSpeed(maxSpeed),
+	threshold(threshold),
+	wakeupChannel("BaudRateNegotiator::wakeupChannel", 4, thread::FullPolicy::DROP_NEWEST),
+	stopRequested(false),
+	started(false),
+	validSentences(0)
+{ }
+
+BaudRateNegotiator::~BaudRateNegotiator()
+{ }
+
+int BaudRateNegotiator::speedCode(unsigned int speed)
+{
+	for(const auto & s : speedLadder)
+	{
+		if(s.first == speed)
+			return s.second;
+	}
+
+	return -1;
+}
+
+unsigned int BaudRateNegotiator::nextSpeed(unsigned int speed) const
+{
+	for(const auto & s : speedLadder)
+	{
+		if(s.first > speed && s.first <= maxSpeed && failedSpeeds.count(s.first) == 0)
+			return s.first;
+	}
+
+	return 0;
+}
+
+bool BaudRateNegotiator::wait(milliseconds duration)
+{
+	std::vector<int> wakeups;
+	wakeupChannel.receiveMany(wakeups, duration);
+	return !stopRequested;
+}
+
+bool BaudRateNegotiator::verifyLink()
+{
+	const uint64_t start = validSentences;
+	const auto deadline = steady_clock::now() + VERIFY_TIMEOUT;
+
+	while(steady_clock::now() < deadline)
+	{
+		if(!wait(milliseconds(100)))
+			return false;
+
+		if(validSentences - start >= VERIFY_SENTENCES)
+			return true;
+	}
+
+	return false;
+}
+
+void BaudRateNegotiator::sendSpeedChange(unsigned int speed)
+{
+	char code[4];
+	snprintf(code, sizeof(code), "%X", speedCode(speed));
+
+	Message setPar;
+	setPar.id = MessageId::SetPar;
+	setPar.parameters.push_back(utils::createFromString("1102"));
+	setPar.parameters.push_back(utils::createFromString(code));
+	device.sendMessageRequest(setPar);
+
+	Message savePar;
+	savePar.id = MessageId::SavePar;
+	device.sendMessageRequest(savePar);
+
+	Message systemReset;
+	systemReset.id = MessageId::SystemReset;
+	device.sendMessageRequest(systemReset);
+}
+
+bool BaudRateNegotiator::upgrade(unsigned int speed)
+{
+	const unsigned int previous = byteStream.baudrate();
+
+	ALOGI("Line utilization above %u%%, switch from %u to %u bauds", threshold, previous, speed);
+
+	sendSpeedChange(speed);
+
+	// The commands are written at the current speed before the UART switches
+	if(!wait(RESET_DELAY))
+		return false;
+
+	if(byteStream.setBaudrate(speed) && verifyLink())
+	{
+		ALOGI("Link established at %u bauds", speed);
+		return true;
+	}
+
+	ALOGW("No valid sentence at %u bauds, back to %u bauds", speed, previous);
+	failedSpeeds.insert(speed);
+
+	if(!stopRequested && byteStream.setBaudrate(previous) && verifyLink())
+		return false;
+
+	// The Teseo may have applied the speed change partially, look for it
+	probe();
+	return false;
+}
+
+bool BaudRateNegotiator::probe()
+{
+	milliseconds backoff = PROBE_BACKOFF_MIN;
+	const unsigned int highest = std::max(maxSpeed, byteStream.baudrate());
+
+	while(!stopRequested)
+	{
+		for(const auto & s : speedLadder)
+		{
+			if(s.first > highest)
+				continue;
+
+			ALOGI("Probe link at %u bauds", s.first);
+
+			if(!byteStream.setBaudrate(s.first))
+				continue;
+
+			if(verifyLink())
+			{
+				ALOGI("Link recovered at %u bauds", s.first);
+				return true;
+			}
+
+			if(stopRequested)
+				return false;
+		}
+
+		ALOGW("Link not recovered, next probe in %lld ms", static_cast<long long>(backoff.count()));
+
+		if(!wait(backoff))
+			return false;
+
+		backoff = std::min(backoff * 2, PROBE_BACKOFF_MAX);
+	}
+
+	return false;
+}
+
+void BaudRateNegotiator::run()
+{
+	ALOGI("Start baudrate negotiator thread, max speed %u bauds, threshold %u%%",
+		maxSpeed, threshold);
+
+	unsigned int utilization = 0;
+	unsigned int samples = 0;
+	unsigned int silentPeriods = 0;
+	uint64_t lastBytes = byteStream.rxByteCount();
+	uint64_t lastSentences = validSentences;
+	auto lastSample = steady_clock::now();
+
+	while(wait(SAMPLE_PERIOD))
+	{
+		const auto now = steady_clock::now();
+		const uint64_t bytes = byteStream.rxByteCount();
+		const uint64_t sentences = validSentences;
+		const unsigned int speed = byteStream.baudrate();
+		const auto elapsed = duration_cast<milliseconds>(now - lastSample).count();
+
+		bool speedChanged = false;
+
+		if(sentences == lastSentences)
+		{
+			if(++silentPeriods >= LINK_LOSS_PERIODS)
+			{
+				ALOGW("No valid sentence received for %u s, probe link", silentPeriods);
+				probe();
+				speedChanged = true;
+			}
+		}
+		else if(speed != 0 && elapsed > 0)
+		{
+			silentPeriods = 0;
+
+			// 10 bits per byte on the wire: start bit, 8 data bits, stop bit
+			const uint64_t sample = (bytes - lastBytes) * 10 * 100 * 1000 /
+				(static_cast<uint64_t>(speed) * static_cast<uint64_t>(elapsed));
+
+			utilization = (utilization * (SAMPLE_WINDOW - 1) + static_cast<unsigned int>(sample)) /
+				SAMPLE_WINDOW;
+
+			if(++samples >= SAMPLE_WINDOW && utilization >= threshold)
+			{
+				const unsigned int next = nextSpeed(speed);
+
+				if(next != 0)
+				{
+					upgrade(next);
+					speedChanged = true;
+				}
+			}
+		}
+
+		if(speedChanged)
+		{
+			utilization = 0;
+			samples = 0;
+			silentPeriods = 0;
+		}
+
+		lastBytes = byteStream.rxByteCount();
+		lastSentences = validSentences;
+		lastSample = steady_clock::now();
+	}
+
+	ALOGI("End of baudrate negotiator thread");
+}
+
+int BaudRateNegotiator::start()
+{
+	std::lock_guard<std::mutex> lock(lifecycleMutex);
+
+	if(started)
+	{
+		ALOGW("Baudrate negotiator thread is already started.");
+		return 1;
+	}
+
+	stopRequested = false;
+
+	if(Thread::start() != 0)
+		return 1;
+
+	started = true;
+	return 0;
+}
+
+int BaudRateNegotiator::stop()
+{
+	std::lock_guard<std::mutex> lock(lifecycleMutex);
+
+	if(started)
+	{
+		ALOGI("Stop baudrate negotiator thread");
+
+		stopRequested = true;
+		wakeupChannel.send(1);
+
+		// The thread may not run yet, wait on its handle rather than on its running state
+		join();
+		started = false;
+
+		return 0;
+	}
+	else
+	{
+		ALOGW("Baudrate negotiator thread is already stopped.");
+		return -1;
+	}
+}
+
+void BaudRateNegotiator::onNmea(GnssUtcTime timestamp, const NmeaMessage & nmea)
+{
+	(void)(timestamp);
+	(void)(nmea);
+
+	validSentences.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace device
+} // namespace stm
@@ -29,6 +29,7 @@
 #define TESEO_HAL_MODEL_COORDINATE
 
 #include <teseo/utils/ByteVector.h>
+#include <teseo/utils/ByteView.h>
 
 namespace stm {
 
@@ -108,7 +109,7 @@ public:
 	 * @param[in]  coordinate  The coordinate string
 	 * @param[in]  direction   The direction character
 	 */
-	DegreeMinuteCoordinate(const ByteVector & coordinate, uint8_t direction);
+	DegreeMinuteCoordinate(ByteView coordinate, uint8_t direction);
 
 	int getDegree() const { return degree; }
 
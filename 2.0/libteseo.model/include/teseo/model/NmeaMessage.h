@@ -28,38 +28,136 @@
 #ifndef TESEO_HAL_NMEA_MESSAGE_H
 #define TESEO_HAL_NMEA_MESSAGE_H
 
-#include <vector>
+#include <array>
+#include <cstdint>
 #include <string>
 #include <teseo/utils/ByteVector.h>
+#include <teseo/utils/ByteView.h>
 
 #include "TalkerId.h"
 
+/**
+ * @brief      Maximal number of parameters stored in an NMEA message, extra parameters are ignored
+ */
+#define NMEA_MESSAGE_MAX_FIELDS 64
+
 namespace stm {
 
 /**
  * @brief      NMEA message wrapper
+ *
+ * @details    The message keeps a reference on the framed sentence bytes (`$<address>,<parameters>*<checksum>`)
+ * and a table with the offset and length of each parameter. The sentence id and the parameters are
+ * views over the sentence bytes, building a message doesn't allocate memory. The views are valid as
+ * long as the message exists.
  */
 struct NmeaMessage {
+private:
+	struct Field {
+		uint16_t offset;
+		uint16_t length;
+	};
+
+	ByteVectorPtr bytes;
+
+	std::array<Field, NMEA_MESSAGE_MAX_FIELDS> fields;
+
+	std::size_t fieldCount;
+
+	mutable std::string asString;
+
+	void parseFields();
+
 public:
-	NmeaMessage(
-		const model::TalkerId talkerId, const ByteVector & sentenceId,
-		const std::vector<ByteVector> & parameters, const uint8_t crc);
+	/**
+	 * @brief      Read-only sequence of the message parameters
+	 */
+	class Parameters {
+	private:
+		const NmeaMessage & msg;
 
-	NmeaMessage(const NmeaMessage & other);
+	public:
+		class const_iterator {
+		private:
+			const Parameters * params;
+
+			std::size_t index;
+
+		public:
+			const_iterator(const Parameters * params, std::size_t index) :
+				params(params), index(index)
+			{ }
+
+			ByteView operator*() const { return (*params)[index]; }
+
+			const_iterator & operator++() { ++index; return *this; }
+
+			const_iterator operator+(std::size_t n) const { return const_iterator(params, index + n); }
+
+			bool operator==(const const_iterator & other) const { return index == other.index; }
+
+			bool operator!=(const const_iterator & other) const { return index != other.index; }
+
+			bool operator<(const const_iterator & other) const { return index < other.index; }
+
+			bool operator>=(const const_iterator & other) const { return index >= other.index; }
+		};
 
-	NmeaMessage(NmeaMessage && other);
+		explicit Parameters(const NmeaMessage & msg) : msg(msg) { }
+
+		std::size_t size() const { return msg.fieldCount; }
+
+		bool empty() const { return msg.fieldCount == 0; }
+
+		/**
+		 * @brief      Get a parameter
+		 *
+		 * @return     View over the parameter, empty if pos is out of range
+		 */
+		ByteView operator[](std::size_t pos) const;
+
+		/**
+		 * @brief      Get a parameter
+		 *
+		 * @throw      std::out_of_range if pos is out of range
+		 */
+		ByteView at(std::size_t pos) const;
+
+		const_iterator begin() const { return const_iterator(this, 0); }
+
+		const_iterator end() const { return const_iterator(this, msg.fieldCount); }
+	};
+
+	/**
+	 * @brief      Build a message from a framed sentence
+	 *
+	 * @param[in]  sentence  The sentence, `$<address>[,<parameters>]*<checksum>` with a valid checksum
+	 */
+	explicit NmeaMessage(ByteVectorPtr sentence);
+
+	NmeaMessage(const NmeaMessage & other);
 
 	const model::TalkerId talkerId;
 
-	const ByteVector sentenceId;
+	const ByteView sentenceId;
 
-	const std::vector<const ByteVector> parameters;
+	const Parameters parameters;
 
 	const uint8_t crc;
 
+	/**
+	 * @brief      Get the whole sentence, from '$' to the checksum
+	 *
+	 * @details    The view is the framed sentence as received from the Teseo, use it to forward the
+	 * sentence without building its string.
+	 */
+	ByteView raw() const;
+
 	/**
 	 * @brief      Returns a string representation of the object.
 	 *
+	 * @details    The string is built from raw() on first use.
+	 *
 	 * @return     String representation of the object.
 	 */
 	const std::string & toString() const;
@@ -67,14 +165,11 @@ public:
 	/**
 	 * @brief      Returns a C-string representation of the object.
 	 *
+	 * @details    The string is built on first use.
+	 *
 	 * @return     C-String representation of the object.
 	 */
 	const char * toCString() const;
-
-private:
-	std::string asString;
-
-	void updateString();
 };
 
 } // namespace stm
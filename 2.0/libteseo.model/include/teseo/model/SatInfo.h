@@ -30,6 +30,71 @@
 
 namespace stm {
 
+/* This value is based on ST GNSS NMEA specification and commands Rev 3.44
+ * from GNSS_NMEA_Interface_344.pdf
+ * which released for STA8089-90 Binary Image v4.5.12.4
+ */
+constexpr int16_t PRN_GPS_MIN = 1,
+                  PRN_GPS_MAX = 32,
+                  PRN_SBA_MIN = 33,
+                  PRN_SBA_MAX = 51,
+                  PRN_GLO_MIN = 65,
+                  PRN_GLO_MAX = 92,
+                  PRN_BEI_MIN = 141,
+                  PRN_BEI_MAX = 172,
+                  PRN_QZS_MIN = 183,
+                  PRN_QZS_MAX = 197,
+                  PRN_GAL_MIN = 301,
+                  PRN_GAL_MAX = 336,
+                  PRN_IRN_MIN = 801,
+                  PRN_IRN_MAX = 807;
+
+/**
+ * @brief      Get the constellation of a PRN
+ *
+ * @details    Compile-time classification used to build the PRN lookup table, use
+ * prn2constellation() at runtime.
+ *
+ * @return     The PRN constellation, UNKNOWN for invalid PRNs
+ */
+constexpr GnssConstellationType classifyPrn(int16_t prn)
+{
+	if(PRN_GPS_MIN <= prn && prn <= PRN_GPS_MAX) return GnssConstellationType::GPS;
+	if(PRN_SBA_MIN <= prn && prn <= PRN_SBA_MAX) return GnssConstellationType::SBAS;
+	if(PRN_GLO_MIN <= prn && prn <= PRN_GLO_MAX) return GnssConstellationType::GLONASS;
+	if(PRN_BEI_MIN <= prn && prn <= PRN_BEI_MAX) return GnssConstellationType::BEIDOU;
+	if(PRN_QZS_MIN <= prn && prn <= PRN_QZS_MAX) return GnssConstellationType::QZSS;
+	if(PRN_GAL_MIN <= prn && prn <= PRN_GAL_MAX) return GnssConstellationType::GALILEO;
+	if(PRN_IRN_MIN <= prn && prn <= PRN_IRN_MAX) return GnssConstellationType::IRNSS;
+
+	switch (prn)
+	{
+		// EGNOS
+		case 120: 	//EGNOS   Inmarsat 3f2 (AOR-E) 	 15.5° W
+		case 123:   //EGNOS   Astra 5B               31.5° E
+		case 136:   //EGNOS   Test-mode sat
+
+		// GAGAN
+		case 127: 	//GAGAN   Inmarsat 4f1           64.0° E
+
+		// MSAS
+		case 129: 	//MSAS    MTSAT 1R               140.0° E
+		case 137: 	//MSAS    MTSAT 2                145.0° E
+
+		// WAAS
+		case 135: 	//WAAS 	  Galaxy 15 (Intelsat)   133.0° W
+		case 138: 	//WAAS    Anik F1R (Telesat)     107.3° W
+
+		// Deprecated satellites
+		case 124: 	//EGNOS   Artemis                21.5° E
+		case 126: 	//EGNOS   Inmarsat 4f2 (IOR-W)   25.1° E
+
+			return GnssConstellationType::SBAS;
+	}
+
+	return GnssConstellationType::UNKNOWN;
+}
+
 GnssConstellationType prn2constellation(int16_t prn);
 int16_t prn2svid(GnssConstellationType constellation, int16_t prn);
 
@@ -46,7 +111,7 @@ public:
 
 	SatIdentifier(GnssConstellationType constellation, int16_t svid);
 
-	SatIdentifier(const SatIdentifier & other);
+	SatIdentifier(const SatIdentifier & other) = default;
 
 	int16_t getPrn() const
 	{ return prn; }
@@ -57,7 +122,7 @@ public:
 	GnssConstellationType getConstellation() const
 	{ return constellation; }
 
-	SatIdentifier & operator = (const SatIdentifier & other);
+	SatIdentifier & operator = (const SatIdentifier & other) = default;
 
 	bool operator == (const SatIdentifier & other) const;
 
@@ -126,7 +191,9 @@ public:
 		bool hasAlmanac = true,
 		bool usedInFix = true);
 
-	SatInfo(const SatInfo & other);
+	SatInfo(const SatInfo & other) = default;
+
+	SatInfo & operator = (const SatInfo & other) = default;
 
 	const SatIdentifier & getId() const;
 
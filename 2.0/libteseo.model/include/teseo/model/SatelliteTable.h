@@ -0,0 +1,241 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Fixed-slot satellite table
+ * @file SatelliteTable.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_MODEL_SATELLITE_TABLE_H
+#define TESEO_HAL_MODEL_SATELLITE_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+#include "SatInfo.h"
+
+namespace stm {
+
+namespace __private {
+
+/**
+ * Highest PRN known by classifyPrn()
+ */
+constexpr int16_t PRN_LOOKUP_MAX = PRN_IRN_MAX;
+
+constexpr std::size_t knownPrnCount()
+{
+	std::size_t count = 0;
+
+	for(int16_t prn = 0; prn <= PRN_LOOKUP_MAX; prn++)
+	{
+		if(classifyPrn(prn) != GnssConstellationType::UNKNOWN)
+			count++;
+	}
+
+	return count;
+}
+
+/**
+ * @brief      PRN to slot lookup, built at compile time
+ *
+ * @details    Slots are allocated to the known PRNs in increasing PRN order.
+ */
+struct PrnLookup {
+	static constexpr std::size_t SLOTS = knownPrnCount();
+
+	static constexpr uint8_t NO_SLOT = UINT8_MAX;
+
+	static_assert(SLOTS < NO_SLOT, "Too many PRNs for the PRN lookup");
+
+	std::array<uint8_t, PRN_LOOKUP_MAX + 1> slotOfPrn;
+
+	std::array<GnssConstellationType, SLOTS> constellationOfSlot;
+
+	constexpr PrnLookup() :
+		slotOfPrn(),
+		constellationOfSlot()
+	{
+		std::size_t slot = 0;
+
+		for(int16_t prn = 0; prn <= PRN_LOOKUP_MAX; prn++)
+		{
+			GnssConstellationType constellation = classifyPrn(prn);
+
+			if(constellation == GnssConstellationType::UNKNOWN)
+			{
+				slotOfPrn[prn] = NO_SLOT;
+			}
+			else
+			{
+				slotOfPrn[prn] = static_cast<uint8_t>(slot);
+				constellationOfSlot[slot] = constellation;
+				slot++;
+			}
+		}
+	}
+};
+
+} // namespace __private
+
+/**
+ * @brief      Fixed-slot satellite table
+ *
+ * @details    The table has one slot per known PRN, found with a lookup table computed at compile
+ * time. It never allocates: satellites are updated in place and the table is cleared by
+ * incrementing its generation, a slot holds a satellite only when its generation is the table one.
+ * Iteration visits the satellites in increasing PRN order. Satellites with an unknown PRN can't be
+ * stored.
+ */
+class SatelliteTable {
+public:
+	static constexpr std::size_t SLOTS = __private::PrnLookup::SLOTS;
+
+private:
+	static constexpr __private::PrnLookup lookup = __private::PrnLookup();
+
+	struct Slot {
+		SatInfo info;
+		uint32_t generation;
+	};
+
+	std::array<Slot, SLOTS> slots;
+
+	uint32_t currentGeneration;
+
+	std::size_t count;
+
+	static std::size_t slotOf(int16_t prn)
+	{
+		if(prn < 0 || prn > __private::PRN_LOOKUP_MAX)
+			return SLOTS;
+
+		uint8_t slot = lookup.slotOfPrn[prn];
+		return slot == __private::PrnLookup::NO_SLOT ? SLOTS : slot;
+	}
+
+public:
+	/**
+	 * @brief      Constant iterator over the stored satellites
+	 */
+	class const_iterator {
+	private:
+		const SatelliteTable * table;
+		std::size_t slot;
+
+		void skipEmpty()
+		{
+			while(slot < SLOTS && table->slots[slot].generation != table->currentGeneration)
+				slot++;
+		}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = SatInfo;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const SatInfo *;
+		using reference = const SatInfo &;
+
+		const_iterator(const SatelliteTable * table, std::size_t slot) :
+			table(table),
+			slot(slot)
+		{
+			skipEmpty();
+		}
+
+		reference operator * () const { return table->slots[slot].info; }
+		pointer operator -> () const { return &table->slots[slot].info; }
+
+		const_iterator & operator ++ ()
+		{
+			slot++;
+			skipEmpty();
+			return *this;
+		}
+
+		const_iterator operator ++ (int)
+		{
+			const_iterator old = *this;
+			++(*this);
+			return old;
+		}
+
+		bool operator == (const const_iterator & other) const { return slot == other.slot; }
+		bool operator != (const const_iterator & other) const { return slot != other.slot; }
+	};
+
+	SatelliteTable();
+
+	/**
+	 * @brief      Get the constellation of a PRN
+	 *
+	 * @return     The PRN constellation, UNKNOWN for invalid PRNs
+	 */
+	static GnssConstellationType constellationOf(int16_t prn)
+	{
+		std::size_t slot = slotOf(prn);
+		return slot < SLOTS ? lookup.constellationOfSlot[slot] : GnssConstellationType::UNKNOWN;
+	}
+
+	/**
+	 * @brief      Find a satellite
+	 *
+	 * @return     The satellite information, nullptr if it isn't in the table
+	 */
+	SatInfo * find(const SatIdentifier & id);
+
+	const SatInfo * find(const SatIdentifier & id) const;
+
+	/**
+	 * @brief      Find a satellite, insert it if it isn't in the table
+	 *
+	 * @return     The satellite information and true if it was inserted. The satellite information
+	 * is nullptr when the PRN is unknown.
+	 */
+	std::pair<SatInfo *, bool> insert(const SatIdentifier & id);
+
+	/**
+	 * @brief      Remove all the satellites
+	 */
+	void clear();
+
+	/**
+	 * @brief      Get the table generation, incremented on each clear
+	 */
+	uint32_t generation() const { return currentGeneration; }
+
+	std::size_t size() const { return count; }
+
+	bool empty() const { return count == 0; }
+
+	const_iterator begin() const { return const_iterator(this, 0); }
+
+	const_iterator end() const { return const_iterator(this, SLOTS); }
+};
+
+} // namespace stm
+
+#endif // TESEO_HAL_MODEL_SATELLITE_TABLE_H
@@ -0,0 +1,178 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief NMEA sentence filter
+ * @file SentenceFilter.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_MODEL_SENTENCE_FILTER_H
+#define TESEO_HAL_MODEL_SENTENCE_FILTER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <teseo/utils/ByteView.h>
+#include <teseo/utils/SentenceTable.h>
+
+#include "NmeaMessage.h"
+#include "TalkerId.h"
+
+namespace stm {
+namespace model {
+
+/**
+ * @brief      Get the family of a message sentence ID
+ */
+inline utils::SentenceFamily sentenceFamilyOf(const NmeaMessage & msg)
+{
+	return msg.talkerId == TalkerId::PSTM ?
+		utils::SentenceFamily::PROPRIETARY : utils::SentenceFamily::STANDARD;
+}
+
+/**
+ * @brief      Set of NMEA sentences a subscriber needs
+ *
+ * @details    Sentences are matched on their family and sentence ID, whatever the talker: a filter
+ * on the standard "GSV" sentence matches GPGSV and GLGSV. A filter can also accept a whole family.
+ * It holds up to MAX_SENTENCES sentence IDs, adding more sentences makes the filter accept their
+ * whole family.
+ */
+class SentenceFilter {
+public:
+	static constexpr std::size_t MAX_SENTENCES = 16;
+
+private:
+	std::array<uint64_t, MAX_SENTENCES> keys;
+
+	std::size_t count;
+
+	bool standardFamily;
+
+	bool proprietaryFamily;
+
+	bool & familyFlag(utils::SentenceFamily family)
+	{
+		return family == utils::SentenceFamily::PROPRIETARY ? proprietaryFamily : standardFamily;
+	}
+
+	bool familyFlag(utils::SentenceFamily family) const
+	{
+		return family == utils::SentenceFamily::PROPRIETARY ? proprietaryFamily : standardFamily;
+	}
+
+public:
+	/**
+	 * @brief      Create a filter matching no sentence
+	 */
+	SentenceFilter() :
+		keys(),
+		count(0),
+		standardFamily(false),
+		proprietaryFamily(false)
+	{ }
+
+	/**
+	 * @brief      Create a filter matching all the sentences
+	 */
+	static SentenceFilter all()
+	{
+		return SentenceFilter()
+			.family(utils::SentenceFamily::STANDARD)
+			.family(utils::SentenceFamily::PROPRIETARY);
+	}
+
+	/**
+	 * @brief      Accept all the sentences of a family
+	 */
+	SentenceFilter & family(utils::SentenceFamily family)
+	{
+		familyFlag(family) = true;
+		return *this;
+	}
+
+	/**
+	 * @brief      Accept a sentence
+	 *
+	 * @param[in]  family  The sentence family
+	 * @param[in]  id      The sentence ID, without talker ID: "GSV", "TG"
+	 */
+	SentenceFilter & sentence(utils::SentenceFamily family, const char * id)
+	{
+		if(count == MAX_SENTENCES)
+			return this->family(family);
+
+		keys[count++] = utils::sentenceKey(family, id, std::strlen(id));
+		return *this;
+	}
+
+	/**
+	 * @brief      Accept a standard sentence
+	 */
+	SentenceFilter & standard(const char * id)
+	{
+		return sentence(utils::SentenceFamily::STANDARD, id);
+	}
+
+	/**
+	 * @brief      Accept a proprietary sentence
+	 */
+	SentenceFilter & proprietary(const char * id)
+	{
+		return sentence(utils::SentenceFamily::PROPRIETARY, id);
+	}
+
+	bool matchesAll() const
+	{
+		return standardFamily && proprietaryFamily;
+	}
+
+	bool matches(utils::SentenceFamily family, ByteView id) const
+	{
+		if(familyFlag(family))
+			return true;
+
+		// Hashed keys of long sentence IDs may collide, a filter may accept a few extra sentences
+		const uint64_t key = utils::sentenceKey(family, id.data(), id.size());
+
+		for(std::size_t i = 0; i < count; i++)
+		{
+			if(keys[i] == key)
+				return true;
+		}
+
+		return false;
+	}
+
+	bool matches(const NmeaMessage & msg) const
+	{
+		return matches(sentenceFamilyOf(msg), msg.sentenceId);
+	}
+};
+
+} // namespace model
+} // namespace stm
+
+#endif // TESEO_HAL_MODEL_SENTENCE_FILTER_H
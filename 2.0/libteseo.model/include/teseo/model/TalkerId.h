@@ -29,6 +29,7 @@
 #define TESEO_HAL_MODEL_TALKER_ID_H
 
 #include <teseo/utils/ByteVector.h>
+#include <teseo/utils/ByteView.h>
 
 namespace stm {
 namespace model {
@@ -113,7 +114,7 @@ const char * TalkerIdToString(TalkerId id);
  *
  * @return     The talker id value
  */
-TalkerId ByteVectorToTalkerId(const ByteVector & bytes);
+TalkerId ByteVectorToTalkerId(ByteView bytes);
 
 } // namespace model
 } // namespace stm
@@ -122,7 +122,7 @@ DegreeMinuteCoordinate::DegreeMinuteCoordinate(int deg, double min, CoordinateDi
 	degree(deg), minute(min), direction(dir)
 { }
 
-DegreeMinuteCoordinate::DegreeMinuteCoordinate(const ByteVector & coordinate, uint8_t dir) :
+DegreeMinuteCoordinate::DegreeMinuteCoordinate(ByteView coordinate, uint8_t dir) :
 	ICoordinate(),
 	degree(0), minute(0), direction(CoordinateDirectionParse(dir))
 {
@@ -131,16 +131,19 @@ DegreeMinuteCoordinate::DegreeMinuteCoordinate(const ByteVector & coordinate, ui
 	// find . in coordinate
 	for(dotPos = 0; dotPos < coordinate.size() && coordinate[dotPos] != '.'; dotPos++);
 
-	int offset = (dotPos > 4) ? 3 : 2;
+	// The two digits before the decimal point are the minutes
+	if(dotPos < 2)
+		throw std::runtime_error("Unable to parse coordinate");
 
-	if(auto opt = utils::byteVectorParse<int>(coordinate.begin(), coordinate.begin() + offset))
-		degree = *opt;
-	else
+	const std::size_t minutePos = dotPos - 2;
+	int32_t deg = 0;
+
+	if(minutePos > 0 && utils::parseNumber(coordinate.subview(0, minutePos), deg) != utils::ParseStatus::OK)
 		throw std::runtime_error("Unable to parse degree");
 
-	if(auto opt = utils::byteVectorParse<double>(coordinate.begin() + offset, coordinate.end()))
-		minute = *opt;
-	else
+	degree = deg;
+
+	if(utils::parseNumber(coordinate.subview(minutePos), minute) != utils::ParseStatus::OK)
 		throw std::runtime_error("Unable to parse minute");
 }
 
@@ -26,61 +26,136 @@
  */
 
 #include <teseo/model/NmeaMessage.h>
-#include <sstream>
+
+#include <cstring>
+#include <stdexcept>
 
 #include <teseo/model/TalkerId.h>
 
 namespace stm {
 
-NmeaMessage::NmeaMessage(
-	const model::TalkerId talkerId, const ByteVector & sentenceId,
-	const std::vector<ByteVector> & parameters, const uint8_t crc) :
-	talkerId(talkerId), sentenceId(sentenceId),
-	parameters(parameters.begin(), parameters.end()),
-	crc(crc)
+/**
+ * @brief      Get the sentence body, between '$' and '*'
+ */
+static ByteView bodyOf(const ByteVector & bytes)
 {
-	updateString();
+	if(bytes.size() < 4)
+		return ByteView();
+
+	return ByteView(bytes.data() + 1, bytes.size() - 4);
 }
 
-NmeaMessage::NmeaMessage(const NmeaMessage & other) :
-	talkerId(other.talkerId), sentenceId(other.sentenceId),
-	parameters(other.parameters),
-	crc(other.crc), asString(other.asString)
-{ }
+/**
+ * @brief      Get the sentence address: talker id and sentence id
+ */
+static ByteView addressOf(const ByteVector & bytes)
+{
+	ByteView body = bodyOf(bytes);
+	const uint8_t * comma = static_cast<const uint8_t *>(std::memchr(body.data(), ',', body.size()));
 
-NmeaMessage::NmeaMessage(NmeaMessage && other) :
-	talkerId(other.talkerId), sentenceId(other.sentenceId),
-	parameters(std::move(other.parameters)),
-	crc(other.crc), asString(std::move(other.asString))
-{ }
+	return comma ? ByteView(body.begin(), comma) : body;
+}
 
-const std::string & NmeaMessage::toString() const
+static ByteView sentenceIdOf(const ByteVector & bytes)
 {
-	return asString;
+	ByteView address = addressOf(bytes);
+	std::size_t talkerIdSize = model::ByteVectorToTalkerId(address) == model::TalkerId::PSTM ? 4 : 2;
+
+	return address.subview(talkerIdSize);
 }
 
-const char * NmeaMessage::toCString() const
+static uint8_t crcOf(const ByteVector & bytes)
 {
-	return asString.c_str();
+	if(bytes.size() < 2)
+		return 0;
+
+	return utils::asciiToByte(bytes[bytes.size() - 2], bytes[bytes.size() - 1]);
 }
 
-void NmeaMessage::updateString()
+NmeaMessage::NmeaMessage(ByteVectorPtr sentence) :
+	bytes(sentence),
+	fieldCount(0),
+	talkerId(model::ByteVectorToTalkerId(addressOf(*bytes))),
+	sentenceId(sentenceIdOf(*bytes)),
+	parameters(*this),
+	crc(crcOf(*bytes))
+{
+	parseFields();
+}
+
+NmeaMessage::NmeaMessage(const NmeaMessage & other) :
+	bytes(other.bytes),
+	fields(other.fields),
+	fieldCount(other.fieldCount),
+	asString(other.asString),
+	talkerId(other.talkerId),
+	sentenceId(other.sentenceId),
+	parameters(*this),
+	crc(other.crc)
+{ }
+
+void NmeaMessage::parseFields()
 {
-	std::ostringstream buffer;
-	char crcStr[3] = {0};
+	ByteView body = bodyOf(*bytes);
+	ByteView address = addressOf(*bytes);
 
-	snprintf(crcStr, 3, "%02X", crc);
+	// Parameters start after the address and its comma
+	if(address.size() == body.size())
+		return;
 
-	buffer << '$' << model::TalkerIdToString(talkerId) << sentenceId;
+	const uint8_t * base = bytes->data();
+	const uint8_t * it = address.end() + 1;
+	const uint8_t * end = body.end();
 
-	for(auto bv : parameters)
+	while(fieldCount < NMEA_MESSAGE_MAX_FIELDS)
 	{
-		buffer << ',' << bv;
+		const uint8_t * comma = static_cast<const uint8_t *>(std::memchr(it, ',', end - it));
+		const uint8_t * fieldEnd = comma ? comma : end;
+
+		fields[fieldCount].offset = static_cast<uint16_t>(it - base);
+		fields[fieldCount].length = static_cast<uint16_t>(fieldEnd - it);
+		fieldCount++;
+
+		if(comma == nullptr)
+			break;
+
+		it = comma + 1;
 	}
+}
+
+ByteView NmeaMessage::Parameters::operator[](std::size_t pos) const
+{
+	if(pos >= msg.fieldCount)
+		return ByteView(msg.bytes->data(), std::size_t(0));
+
+	const Field & f = msg.fields[pos];
+	return ByteView(msg.bytes->data() + f.offset, f.length);
+}
+
+ByteView NmeaMessage::Parameters::at(std::size_t pos) const
+{
+	if(pos >= msg.fieldCount)
+		throw std::out_of_range("NmeaMessage::Parameters::at");
+
+	return (*this)[pos];
+}
+
+ByteView NmeaMessage::raw() const
+{
+	return ByteView(*bytes);
+}
 
-	buffer << '*' << crcStr;
+const std::string & NmeaMessage::toString() const
+{
+	if(asString.empty())
+		asString = utils::bytesToString(raw());
 
-	asString = buffer.str();
+	return asString;
+}
+
+const char * NmeaMessage::toCString() const
+{
+	return toString().c_str();
 }
 
-} // namespace stm
\ No newline at end of file
+} // namespace stm
@@ -0,0 +1,95 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Fixed-slot satellite table
+ * @file SatelliteTable.cpp
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#include <teseo/model/SatelliteTable.h>
+
+namespace stm {
+
+SatelliteTable::SatelliteTable() :
+	currentGeneration(1),
+	count(0)
+{
+	for(auto & slot : slots)
+		slot.generation = 0;
+}
+
+SatInfo * SatelliteTable::find(const SatIdentifier & id)
+{
+	std::size_t slot = slotOf(id.getPrn());
+
+	if(slot >= SLOTS || slots[slot].generation != currentGeneration)
+		return nullptr;
+
+	return &slots[slot].info;
+}
+
+const SatInfo * SatelliteTable::find(const SatIdentifier & id) const
+{
+	std::size_t slot = slotOf(id.getPrn());
+
+	if(slot >= SLOTS || slots[slot].generation != currentGeneration)
+		return nullptr;
+
+	return &slots[slot].info;
+}
+
+std::pair<SatInfo *, bool> SatelliteTable::insert(const SatIdentifier & id)
+{
+	std::size_t slot = slotOf(id.getPrn());
+
+	if(slot >= SLOTS)
+		return {nullptr, false};
+
+	Slot & s = slots[slot];
+
+	if(s.generation == currentGeneration)
+		return {&s.info, false};
+
+	s.info = SatInfo(id);
+	s.generation = currentGeneration;
+	count++;
+
+	return {&s.info, true};
+}
+
+void SatelliteTable::clear()
+{
+	currentGeneration++;
+	count = 0;
+
+	// Generation wrapped around, old slots could look current
+	if(currentGeneration == 0)
+	{
+		for(auto & slot : slots)
+			slot.generation = 0;
+
+		currentGeneration = 1;
+	}
+}
+
+} // namespace stm
@@ -47,7 +47,7 @@ const char * TalkerIdToString(TalkerId id)
 	return talkerStrings[static_cast<uint8_t>(id)];
 }
 
-TalkerId ByteVectorToTalkerId(const ByteVector & bytes)
+TalkerId ByteVectorToTalkerId(ByteView bytes)
 {
 	if(bytes.size() < 2)
 		return TalkerId::INVALID;
@@ -47,7 +47,7 @@ class AbstractDecoder:
 	public Thread
 {
 private:
-	thread::Channel<ByteVector *> bytesChannel;
+	thread::Channel<ByteVectorPtr> bytesChannel;
 
 	bool stopDecoder;
 
@@ -0,0 +1,170 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief NMEA epoch boundary detection
+ * @file EpochDetector.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_DECODER_EPOCH_DETECTOR_H
+#define TESEO_HAL_DECODER_EPOCH_DETECTOR_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include <teseo/model/NmeaMessage.h>
+#include <teseo/model/TalkerId.h>
+
+namespace stm {
+namespace decoder {
+
+/**
+ * @brief      NMEA epoch boundary detector
+ *
+ * @details    The Teseo outputs one burst of sentences per fix. The detector tells the decoder when
+ * the current epoch is complete, so the device can publish it without waiting for the next one.
+ *
+ * An epoch is complete when its terminal sentence is decoded. A GSV sentence is only terminal when
+ * it is the last one of its group (sentence index equal to sentence count). The terminal sentence
+ * is either configured, or learned: when the same sentence ends two consecutive epochs, it is used
+ * as terminal for the following epochs.
+ *
+ * A new epoch starts when the GGA or RMC time changes, or on GGA without time. If the previous
+ * epoch wasn't published yet it is published at this point, before decoding the new epoch: this
+ * is the fallback behavior, one epoch late.
+ */
+class EpochDetector {
+public:
+	/**
+	 * Actions to perform for a sentence, as a bit field
+	 */
+	enum Action : unsigned int {
+		NONE           = 0,
+		PUBLISH_BEFORE = 1, ///< Publish the previous epoch before decoding the sentence
+		PUBLISH_AFTER  = 2  ///< Publish the current epoch after decoding the sentence
+	};
+
+	struct Stats {
+		uint64_t earlyEpochs;    ///< Epochs published on their terminal sentence
+		uint64_t fallbackEpochs; ///< Epochs published when the next epoch started
+	};
+
+private:
+	/**
+	 * Sentence address, talker and sentence ID
+	 */
+	struct Address {
+		model::TalkerId talker;
+		uint64_t key;
+
+		bool operator==(const Address & other) const
+		{
+			return talker == other.talker && key == other.key;
+		}
+
+		bool operator!=(const Address & other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	Address configured;
+
+	bool hasConfigured;
+
+	Address learned;
+
+	bool hasLearned;
+
+	/**
+	 * Terminal sentence candidate and number of consecutive epochs it ended
+	 */
+	Address candidate;
+
+	unsigned int candidateEpochs;
+
+	/**
+	 * Number of consecutive epochs with sentences after the learned terminal sentence
+	 */
+	unsigned int lateEpochs;
+
+	/**
+	 * Last group end sentence of the current epoch
+	 */
+	Address last;
+
+	bool hasLast;
+
+	std::array<uint8_t, 16> lastTime;
+
+	std::size_t lastTimeLength;
+
+	bool epochOpen;
+
+	bool published;
+
+	Stats statistics;
+
+	static Address addressOf(const NmeaMessage & msg);
+
+	static bool isGroupEnd(const NmeaMessage & msg);
+
+	/**
+	 * @brief      Check if the sentence starts a new epoch, and update the last epoch time
+	 */
+	bool isEpochStart(const NmeaMessage & msg);
+
+	/**
+	 * @brief      Learn the terminal sentence from the last sentence of a finished epoch
+	 */
+	void learn();
+
+public:
+	/**
+	 * @brief      Create an epoch detector
+	 *
+	 * @param[in]  terminalSentence  Talker and sentence ID of the terminal sentence, for example
+	 * "GLGSV" or "PSTMTG". When empty, the terminal sentence is learned.
+	 */
+	explicit EpochDetector(const std::string & terminalSentence = std::string());
+
+	/**
+	 * @brief      Process a sentence
+	 *
+	 * @return     The actions to perform, combination of Action values
+	 */
+	unsigned int onSentence(const NmeaMessage & msg);
+
+	/**
+	 * @brief      Forget the current epoch and the learned terminal sentence
+	 */
+	void reset();
+
+	const Stats & stats() const { return statistics; }
+};
+
+} // namespace decoder
+} // namespace stm
+
+#endif // TESEO_HAL_DECODER_EPOCH_DETECTOR_H
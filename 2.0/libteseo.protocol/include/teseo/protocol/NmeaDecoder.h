@@ -28,50 +28,20 @@
 #ifndef TESEO_HAL_DECODER_NMEA_DECODER_H
 #define TESEO_HAL_DECODER_NMEA_DECODER_H
 
+#include <memory>
+#include <mutex>
+
 #include <teseo/utils/ByteVector.h>
 #include <teseo/device/AbstractDevice.h>
 
 #include "AbstractDecoder.h"
+#include "EpochDetector.h"
+#include "SentenceCache.h"
 
 namespace stm {
 namespace decoder {
 namespace nmea {
-
-/**
- * @brief      Extract checksum from message
- *
- * @param[in]  bytes             The message ascii string
- * @param      multipleChecksum  Flag setted to true if there is multiple checksum in the message
- * @param      noChecksum        Flag setted to true if there is no checksum in the message
- * @param      invalidChar       Flag setted to true if there are invalid characters in the checksum
- *
- * @return     The extract checksum
- */
-uint8_t extractChecksum(
-	const ByteVector & bytes,
-	bool & multipleChecksum,
-	bool & noChecksum,
-	bool & invalidChar);
-
-/**
- * @brief      Calculates the checksum.
- *
- * @param[in]  bytes  The bytes
- *
- * @return     The checksum.
- */
-uint8_t computeChecksum(const ByteVector & bytes);
-
-/**
- * @brief      Validate NMEA checksum
- *
- * @param[in]  bytes             The message ascii string
- * @param      multipleChecksum  Flag set to true if there is multiple checksum in the message
- * @param      crc               Setted to the computed checksum
- *
- * @return     True if checksum is valid, false otherwise
- */
-bool validateChecksum(const ByteVector & bytes, bool & multipleChecksum, uint8_t & crc);
+class DecodeCache;
 }
 
 /**
@@ -80,10 +50,40 @@ bool validateChecksum(const ByteVector & bytes, bool & multipleChecksum, uint8_t
 class NmeaDecoder :
 	public AbstractDecoder
 {
+public:
+	/**
+	 * @brief      Decoding statistics
+	 */
+	struct Stats {
+		EpochDetector::Stats epochs;
+		SentenceCacheStats cache; ///< Repeated sentences cache, zero when the cache is disabled
+	};
+
 private:
 	device::AbstractDevice & device;
 
+	EpochDetector epochDetector;
+
+	std::unique_ptr<nmea::DecodeCache> cache;
+
+	mutable std::mutex statsMutex;
+
+	/**
+	 * Statistics of the last published epoch, the counters themselves are owned by the decoder thread
+	 */
+	Stats statistics;
+
+	/**
+	 * @brief      Copy the decoder thread counters to the published statistics
+	 */
+	void publishStats();
+
 protected:
+	/**
+	 * @brief      Decoding task, logs the statistics when the decoder stops
+	 */
+	virtual void run();
+
 	/**
 	 * @brief      Decode one NMEA message
 	 *
@@ -95,9 +95,25 @@ public:
 	/**
 	 * @brief      Decoder constructor
 	 *
-	 * @param      device  The connected device
+	 * @param      device            The connected device
+	 * @param[in]  terminalSentence  Sentence ending each epoch, learned when empty
+	 * @param[in]  sentenceCache     Reuse the satellite update of GSV, GSA and PSTMSBAS sentences
+	 * repeated byte for byte instead of parsing them again
+	 */
+	NmeaDecoder(
+		device::AbstractDevice & device,
+		const std::string & terminalSentence = std::string(),
+		bool sentenceCache = false);
+
+	~NmeaDecoder();
+
+	/**
+	 * @brief      Get the decoding statistics
+	 *
+	 * @details    Can be called from any thread, the statistics are updated with each published
+	 * epoch.
 	 */
-	NmeaDecoder(device::AbstractDevice & device);
+	Stats stats() const;
 };
 
 } // namespace decoder
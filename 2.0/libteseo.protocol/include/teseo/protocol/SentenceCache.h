@@ -0,0 +1,173 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Repeated NMEA sentence cache
+ * @file SentenceCache.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_DECODER_SENTENCE_CACHE_H
+#define TESEO_HAL_DECODER_SENTENCE_CACHE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <teseo/utils/ByteView.h>
+
+namespace stm {
+namespace decoder {
+
+/**
+ * @brief      Sentence cache statistics
+ */
+struct SentenceCacheStats {
+	uint64_t lookups;    ///< Sentences looked up in the cache
+	uint64_t hits;       ///< Sentences found in the cache
+	uint64_t savedBytes; ///< Bytes of the sentences found in the cache, not parsed again
+
+	double hitRate() const
+	{
+		return lookups == 0 ? 0. : static_cast<double>(hits) / static_cast<double>(lookups);
+	}
+};
+
+/**
+ * @brief      Cache of decoded sentences
+ *
+ * @details    A stationary receiver repeats many sentences byte for byte from one epoch to the next.
+ * The cache stores the value decoded from a sentence so the decoder can reuse it instead of
+ * parsing the sentence again.
+ *
+ * The cache is direct mapped: the slot is selected from the sentence key, checksum and length, a
+ * new sentence replaces the one stored in its slot. A hit is confirmed by comparing the sentence
+ * bytes. Sentences longer than MAX_SENTENCE_SIZE aren't cached. It doesn't allocate.
+ *
+ * @tparam     T     The decoded value type
+ * @tparam     N     The number of slots, a power of two
+ */
+template<typename T, std::size_t N>
+class SentenceCache {
+public:
+	static constexpr std::size_t MAX_SENTENCE_SIZE = 96;
+
+private:
+	static_assert(N > 1 && (N & (N - 1)) == 0, "Sentence cache size must be a power of two");
+
+	struct Entry {
+		uint64_t key;
+		uint16_t length;
+		uint8_t crc;
+		bool used;
+		std::array<uint8_t, MAX_SENTENCE_SIZE> bytes;
+		T value;
+	};
+
+	std::array<Entry, N> entries;
+
+	SentenceCacheStats statistics;
+
+	static constexpr unsigned int slotBits()
+	{
+		unsigned int bits = 1;
+
+		while((std::size_t(1) << bits) < N)
+			bits++;
+
+		return bits;
+	}
+
+	static std::size_t slotOf(uint64_t key, uint8_t crc, std::size_t length)
+	{
+		// Fibonacci hashing, the top bits of the product are well mixed
+		const uint64_t hash = key ^ (static_cast<uint64_t>(length) << 8 | crc);
+		return static_cast<std::size_t>((hash * 0x9e3779b97f4a7c15ULL) >> (64 - slotBits())) & (N - 1);
+	}
+
+public:
+	SentenceCache() :
+		entries(),
+		statistics({0, 0, 0})
+	{ }
+
+	/**
+	 * @brief      Find the value decoded from a sentence
+	 *
+	 * @param[in]  key       The sentence key, identifying its talker and sentence ID
+	 * @param[in]  sentence  The whole sentence
+	 * @param[in]  crc       The sentence checksum
+	 *
+	 * @return     The cached value, nullptr when the sentence isn't in the cache
+	 */
+	const T * find(uint64_t key, ByteView sentence, uint8_t crc)
+	{
+		statistics.lookups++;
+
+		if(sentence.size() > MAX_SENTENCE_SIZE)
+			return nullptr;
+
+		const Entry & e = entries[slotOf(key, crc, sentence.size())];
+
+		if(!e.used || e.key != key || e.crc != crc || e.length != sentence.size() ||
+		   std::memcmp(e.bytes.data(), sentence.data(), sentence.size()) != 0)
+			return nullptr;
+
+		statistics.hits++;
+		statistics.savedBytes += sentence.size();
+
+		return &e.value;
+	}
+
+	/**
+	 * @brief      Store the value decoded from a sentence
+	 */
+	void store(uint64_t key, ByteView sentence, uint8_t crc, const T & value)
+	{
+		if(sentence.size() > MAX_SENTENCE_SIZE)
+			return;
+
+		Entry & e = entries[slotOf(key, crc, sentence.size())];
+
+		e.key = key;
+		e.length = static_cast<uint16_t>(sentence.size());
+		e.crc = crc;
+		e.used = true;
+		std::copy(sentence.begin(), sentence.end(), e.bytes.begin());
+		e.value = value;
+	}
+
+	void clear()
+	{
+		for(auto & e : entries)
+			e.used = false;
+	}
+
+	const SentenceCacheStats & stats() const { return statistics; }
+};
+
+} // namespace decoder
+} // namespace stm
+
+#endif // TESEO_HAL_DECODER_SENTENCE_CACHE_H
@@ -50,7 +50,7 @@ AbstractDecoder::~AbstractDecoder()
 
 void AbstractDecoder::run()
 {
-	ByteVector * bytes = nullptr;
+	ByteVectorPtr bytes;
 	int errcount = 0;
 
 	stopDecoder = false;
@@ -65,7 +65,12 @@ void AbstractDecoder::run()
 			bytes = bytesChannel.receive();
 
 			if(bytes != nullptr)
-				decode(ByteVectorPtr(bytes));
+			{
+				decode(bytes);
+
+				// Give the buffer back to the stream pool before waiting
+				bytes.reset();
+			}
 			else
 				ALOGW("Received nullptr, thread should stop shortly.");
 		}
@@ -95,7 +100,8 @@ void AbstractDecoder::onNewBytes(ByteVectorPtr bytes)
 {
 	if(isRunning())
 	{
-		bytesChannel.send(new ByteVector(*bytes));
+		// The stream hands over a buffer it won't modify anymore, no copy needed
+		bytesChannel.send(bytes);
 	}
 	else
 	{
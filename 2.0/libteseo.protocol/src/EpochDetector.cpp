@@ -0,0 +1,223 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief NMEA epoch boundary detection
+ * @file EpochDetector.cpp
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#include <teseo/protocol/EpochDetector.h>
+
+#define LOG_TAG "teseo_hal_EpochDetector"
+#include <log/log.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <teseo/utils/SentenceTable.h>
+
+namespace stm {
+namespace decoder {
+
+using model::TalkerId;
+using utils::SentenceFamily;
+
+/**
+ * Number of consecutive epochs ended by the same sentence before it is used as terminal sentence,
+ * and number of consecutive epochs with late sentences before the terminal sentence is forgotten
+ */
+static constexpr unsigned int LEARN_EPOCHS = 2;
+
+static const ByteView GGA(reinterpret_cast<const uint8_t *>("GGA"), 3);
+static const ByteView RMC(reinterpret_cast<const uint8_t *>("RMC"), 3);
+static const ByteView GSV(reinterpret_cast<const uint8_t *>("GSV"), 3);
+
+static uint64_t sentenceIdKey(ByteView sentenceId)
+{
+	return utils::sentenceKey(SentenceFamily::STANDARD, sentenceId.data(), sentenceId.size());
+}
+
+EpochDetector::EpochDetector(const std::string & terminalSentence) :
+	configured({TalkerId::INVALID, 0}),
+	hasConfigured(false)
+{
+	reset();
+
+	if(terminalSentence.empty())
+		return;
+
+	ByteView address(reinterpret_cast<const uint8_t *>(terminalSentence.data()), terminalSentence.size());
+	TalkerId talker = model::ByteVectorToTalkerId(address);
+
+	if(talker == TalkerId::INVALID || address.size() <= model::TalkerIdByteCount(talker))
+	{
+		ALOGE("Invalid epoch terminal sentence '%s', the terminal sentence will be learned",
+			terminalSentence.c_str());
+		return;
+	}
+
+	configured = {talker, sentenceIdKey(address.subview(model::TalkerIdByteCount(talker)))};
+	hasConfigured = true;
+
+	ALOGI("Epoch terminal sentence: %s", terminalSentence.c_str());
+}
+
+void EpochDetector::reset()
+{
+	learned = {TalkerId::INVALID, 0};
+	hasLearned = false;
+	candidate = {TalkerId::INVALID, 0};
+	candidateEpochs = 0;
+	lateEpochs = 0;
+	last = {TalkerId::INVALID, 0};
+	hasLast = false;
+	lastTimeLength = 0;
+	epochOpen = false;
+	published = false;
+	statistics = {0, 0};
+}
+
+EpochDetector::Address EpochDetector::addressOf(const NmeaMessage & msg)
+{
+	return {msg.talkerId, sentenceIdKey(msg.sentenceId)};
+}
+
+bool EpochDetector::isGroupEnd(const NmeaMessage & msg)
+{
+	// GSV: total number of sentences, sentence number, ...
+	if(msg.talkerId == TalkerId::PSTM || msg.sentenceId != GSV)
+		return true;
+
+	return msg.parameters[0] == msg.parameters[1];
+}
+
+bool EpochDetector::isEpochStart(const NmeaMessage & msg)
+{
+	if(msg.talkerId == TalkerId::PSTM)
+		return false;
+
+	const bool gga = msg.sentenceId == GGA;
+
+	if(!gga && msg.sentenceId != RMC)
+		return false;
+
+	// Both sentences start with the UTC time of the fix, it is empty until the time is known
+	ByteView time = msg.parameters[0];
+
+	if(time.empty() || time.size() > lastTime.size())
+		return gga;
+
+	const bool hasTime = lastTimeLength != 0;
+	const bool changed = !hasTime || ByteView(lastTime.data(), lastTimeLength) != time;
+
+	if(changed)
+	{
+		std::copy(time.begin(), time.end(), lastTime.begin());
+		lastTimeLength = time.size();
+	}
+
+	// The first time seen only starts an epoch on GGA, as without time
+	return changed && (hasTime || gga);
+}
+
+void EpochDetector::learn()
+{
+	if(!hasLast)
+		return;
+
+	if(published)
+	{
+		// Sentences after the learned terminal sentence, the epoch layout may have changed
+		if(!hasConfigured && hasLearned && last != learned && ++lateEpochs >= LEARN_EPOCHS)
+		{
+			ALOGW("Sentences received after the epoch terminal sentence, learn it again");
+			hasLearned = false;
+			candidateEpochs = 0;
+		}
+		else if(last == learned)
+		{
+			lateEpochs = 0;
+		}
+
+		return;
+	}
+
+	if(last == candidate)
+	{
+		candidateEpochs++;
+	}
+	else
+	{
+		candidate = last;
+		candidateEpochs = 1;
+	}
+
+	if(candidateEpochs >= LEARN_EPOCHS && !hasConfigured)
+	{
+		learned = candidate;
+		hasLearned = true;
+		lateEpochs = 0;
+	}
+}
+
+unsigned int EpochDetector::onSentence(const NmeaMessage & msg)
+{
+	unsigned int actions = NONE;
+
+	if(isEpochStart(msg))
+	{
+		if(epochOpen && !published)
+		{
+			actions |= PUBLISH_BEFORE;
+			statistics.fallbackEpochs++;
+		}
+
+		learn();
+
+		hasLast = false;
+		published = false;
+	}
+
+	epochOpen = true;
+
+	if(!isGroupEnd(msg))
+		return actions;
+
+	last = addressOf(msg);
+	hasLast = true;
+
+	if(published)
+		return actions;
+
+	if((hasConfigured && last == configured) || (!hasConfigured && hasLearned && last == learned))
+	{
+		actions |= PUBLISH_AFTER;
+		published = true;
+		statistics.earlyEpochs++;
+	}
+
+	return actions;
+}
+
+} // namespace decoder
+} // namespace stm
@@ -49,108 +49,54 @@ using namespace stm::model;
 namespace stm {
 namespace decoder {
 
-namespace nmea {
-
-uint8_t extractChecksum(
-	const ByteVector & bytes,
-	bool & multipleChecksum,
-	bool & noChecksum,
-	bool & invalidChar)
-{
-	bool checksumStart = false;
-	bool checksumFound = false;
-	uint8_t checksumIndex = 0;
-	uint8_t checksumBytes[2] = {0};
-
-	multipleChecksum = false;
-	noChecksum = false;
+NmeaDecoder::NmeaDecoder(
+	device::AbstractDevice & dev,
+	const std::string & terminalSentence,
+	bool sentenceCache) :
+	device(dev),
+	epochDetector(terminalSentence),
+	cache(sentenceCache ? std::make_unique<nmea::DecodeCache>() : nullptr),
+	statistics({{0, 0}, {0, 0, 0}})
+{ }
 
-	for(uint8_t b : bytes)
-	{
-		if(checksumStart)
-		{
-			if(checksumIndex < 2)
-			{
-				checksumBytes[checksumIndex] = b;
-				checksumIndex++;
-			}
-			else
-			{
-				checksumFound = true;
-				checksumStart = false;
-			}
-		}
-
-		if(b == '*' && !checksumFound)
-		{
-			checksumStart = true;
-			checksumIndex = 0;
-		}
-		else if(b == '*')
-		{
-			NMEA_DECODER_LOGW("Multiple checksum in sentence: '%s'", utils::bytesToString(bytes).c_str());
-			multipleChecksum = true;
-		}
-	}
+NmeaDecoder::~NmeaDecoder()
+{ }
 
-	if(checksumFound || (checksumStart && checksumIndex == 2))
-	{
-		return utils::asciiToByte(checksumBytes[0], checksumBytes[1], invalidChar);
-	}
-	else
-	{
-		NMEA_DECODER_LOGE("No checksum in sentences.");
-		noChecksum = true;
-		return 0;
-	}
+NmeaDecoder::Stats NmeaDecoder::stats() const
+{
+	std::lock_guard<std::mutex> lock(statsMutex);
+	return statistics;
 }
 
-uint8_t computeChecksum(const ByteVector & bytes)
+void NmeaDecoder::publishStats()
 {
-	bool computeCRC = false;
-	uint8_t crc = 0;
-
-	for(uint8_t b: bytes)
-	{
-		if(b == '*')
-		{
-			computeCRC = false;
-		}
-
-		if(computeCRC)
-		{
-			crc ^= b;
-		}
-
-		if(b == '$')
-		{
-			computeCRC = true;
-		}
-	}
-
-	return crc;
+	std::lock_guard<std::mutex> lock(statsMutex);
+	statistics = {epochDetector.stats(), cache ? cache->stats() : SentenceCacheStats({0, 0, 0})};
 }
 
-bool validateChecksum(const ByteVector & bytes, bool & multipleChecksum, uint8_t & crc)
+void NmeaDecoder::run()
 {
-	bool noChecksum = false, invalidChar = false;
-	uint8_t extractedCRC = extractChecksum(bytes, multipleChecksum, noChecksum, invalidChar);
-	uint8_t computedCRC = computeChecksum(bytes);
+	AbstractDecoder::run();
 
-	crc = computedCRC;
-
-	return extractedCRC == computedCRC && !noChecksum && !invalidChar;
-}
+	publishStats();
+	Stats s = stats();
 
-} // namespace nmea
+	ALOGI("Epochs published on their terminal sentence: %llu, on the next epoch: %llu",
+		static_cast<unsigned long long>(s.epochs.earlyEpochs),
+		static_cast<unsigned long long>(s.epochs.fallbackEpochs));
 
-NmeaDecoder::NmeaDecoder(device::AbstractDevice & dev) :
-	device(dev)
-{ }
+	if(cache)
+	{
+		ALOGI("Sentence cache: %llu lookups, %.1f%% hits, %llu bytes not parsed again",
+			static_cast<unsigned long long>(s.cache.lookups),
+			s.cache.hitRate() * 100.,
+			static_cast<unsigned long long>(s.cache.savedBytes));
+	}
+}
 
 void NmeaDecoder::decode(ByteVectorPtr bytesPtr)
 {
-	ByteVector & bytes = *bytesPtr;
+	const ByteVector & bytes = *bytesPtr;
 
 	// Message contains at least the following data:
 	// $PSTM...*XX
@@ -161,76 +107,39 @@ void NmeaDecoder::decode(ByteVectorPtr bytesPtr)
 		return;
 	}
 
-	// 1. Validate CRC
-	bool multipleChecksum = false;
-	uint8_t crc = 0;
-	if(!nmea::validateChecksum(bytes, multipleChecksum, crc))
+	// 1. The stream only emits framed sentences, $<body>*XX, with a valid checksum
+	if(bytes.front() != '$' || bytes[bytes.size() - 3] != '*')
 	{
-		NMEA_DECODER_LOGE("Invalid checksum in sentence: '%s'", utils::bytesToString(bytes).c_str());
+		NMEA_DECODER_LOGE("Sentence not framed by the NMEA stream: '%s'", utils::bytesToString(bytes).c_str());
 		return;
 	}
 
-	// 2. Remove CRC and $
-	if(bytes.at(0) == '$')
-		bytes.erase(bytes.begin());
-
-	if(multipleChecksum)
-	{
-		// Find first '*'
-		for(auto it = bytes.cbegin(); it != bytes.end(); ++it)
-		{
-			if(*it == '*')
-			{
-				bytes.erase(it - 1, bytes.cend());
-				break;
-			}
-		}
-	}
-	else
-	{
-		// Find last '*'
-		for(auto rit = bytes.crbegin(); rit != bytes.crend(); ++rit)
-		{
-			if(*rit == '*')
-			{
-				++rit; // <-- Move the iterator to also remove the star
-				// it.base() convert reverse iterator to "normal" iterator
-				bytes.erase(rit.base(), bytes.cend());
-				break;
-			}	
-		}
-	}
+	// 2. Index the message fields, the message references the sentence bytes
+	NmeaMessage msg(bytesPtr);
 
-
-	// 2. Split message
-	std::vector<ByteVector> pieces = utils::split(bytes, ',');
-
-	// 3. Extract TalkerID and SentenceID
-	const ByteVector & id = pieces[0];
-
-	TalkerId talkerId = ByteVectorToTalkerId(id);
-	int talkerIdSize = talkerId == TalkerId::PSTM ? 4 : 2;
-	
-	ByteVector sentenceId(id.begin() + talkerIdSize, id.end());
-	
-	// remove message identifier from pieces
-	pieces.erase(pieces.begin());
-
-	// 4. Create Message
-	NmeaMessage msg(talkerId, sentenceId, pieces, crc);
-
-	// 5. Log NMEA message
+	// 3. Log NMEA message
 	NMEA_DECODER_LOGI("NMEA: '%s'", msg.toCString());
 
-	// 6. Trigger device update before eventually decoding start sequence sentence
-	device.updateIfStartSentenceId(msg.sentenceId);
+	// 4. Publish the previous epoch before decoding the first sentence of a new one, if it
+	// wasn't published on its terminal sentence
+	unsigned int epochActions = epochDetector.onSentence(msg);
+
+	if(epochActions & EpochDetector::PUBLISH_BEFORE)
+		device.publishEpoch();
 
-	// 6. Decode message
-	nmea::decode(device, msg);
+	// 5. Decode message
+	nmea::decode(device, msg, cache.get());
 
-	// 7. Emit NMEA message
+	// 6. Emit NMEA message
 	// N.B. Decoding must occur before emit because timestamp may be updated during decode
 	device.emitNmea(msg);
+
+	// 7. Publish the epoch as soon as its terminal sentence is decoded
+	if(epochActions & EpochDetector::PUBLISH_AFTER)
+		device.publishEpoch();
+
+	if(epochActions != EpochDetector::NONE)
+		publishStats();
 }
 
 } // namespace decoder
@@ -29,23 +29,23 @@
 
 #define LOG_TAG "teseo_hal_nmea_messages"
 #include <log/log.h>
+#include <algorithm>
 #include <unordered_map>
 #include <map>
 #include <unordered_set>
 #include <mutex>
 
-#include <teseo/vendor/frozen/unordered_map.h>
-#include <teseo/vendor/frozen/string.h>
 #include <teseo/model/Coordinate.h>
 #include <teseo/model/FixAndOperatingModes.h>
 #include <teseo/model/FixQuality.h>
+#include <teseo/model/SentenceFilter.h>
 #include <teseo/model/TalkerId.h>
 #include <teseo/utils/ByteVector.h>
+#include <teseo/utils/ByteView.h>
+#include <teseo/utils/SentenceTable.h>
 #include <teseo/utils/Time.h>
 #include <teseo/utils/utils.h>
 
-using namespace frozen::string_literals;
-
 // Messages to debug
 #ifndef DISABLE_ALL_MESSAGE_DEBUGGING
 	// NMEA std. messages
@@ -74,77 +74,100 @@ using namespace stm::model;
 
 typedef void (*MessageDecoder)(AbstractDevice & dev, const NmeaMessage &);
 
-constexpr static frozen::unordered_map<frozen::string, MessageDecoder, 5> std = {
-	{"RMC"_s, &decoders::rmc},
-	{"GGA"_s, &decoders::gga},
-	{"VTG"_s, &decoders::vtg},
-	{"GSV"_s, &decoders::gsv},
-	{"GSA"_s, &decoders::gsa}
-	// Do not forget to update number of elements in map declaration
+/**
+ * Decoder and the data products it feeds, PRODUCT_NONE for decoders always called. Sentences with a
+ * parser can be served from the decode cache.
+ */
+struct MessageHandler {
+	MessageDecoder decoder;
+	unsigned int products;
+	SentenceParser parser;
 };
 
-constexpr static frozen::unordered_map<frozen::string, MessageDecoder, 10> stm = {
-	{"SBAS"_s, &decoders::sbas},
-	{"VER"_s,  &decoders::pstmver},
-	{"STAGPS8PASSRTN"_s,  &decoders::pstmstagps8passrtn},
-	{"STAGPS8PASSGENERROR"_s, &decoders::pstmstagps8passrtn},
-	{"STAGPSPASSRTN"_s,  &decoders::pstmstagpspassrtn},
-	{"STAGPSPASSGENERROR"_s, &decoders::pstmstagpspassrtn},
-	{"STAGPSSATSEEDOK"_s, &decoders::pstmstagpssatseedresponse},
-	{"STAGPSSATSEEDERROR"_s, &decoders::pstmstagpssatseedresponse},
-	{"DRCAL"_s, &decoders::drcal},
-	{"TG"_s, &decoders::tg},
-	// Do not forget to update number of elements in map declaration
+constexpr static unsigned int LOCATION = AbstractDevice::PRODUCT_LOCATION;
+constexpr static unsigned int SATELLITES = AbstractDevice::PRODUCT_SATELLITES;
+constexpr static unsigned int ALWAYS = AbstractDevice::PRODUCT_NONE;
+
+constexpr static SentenceEntry<MessageHandler> registrations[] = {
+	// NMEA standard messages, RMC sets the NMEA timestamp
+	standardSentence("RMC", MessageHandler{&decoders::rmc, ALWAYS, nullptr}),
+	standardSentence("GGA", MessageHandler{&decoders::gga, LOCATION, nullptr}),
+	standardSentence("VTG", MessageHandler{&decoders::vtg, LOCATION, nullptr}),
+	standardSentence("GSV", MessageHandler{&decoders::gsv, SATELLITES, &decoders::parseGsv}),
+	standardSentence("GSA", MessageHandler{&decoders::gsa, LOCATION | SATELLITES, &decoders::parseGsa}),
+	// STMicroelectronics proprietary messages
+	proprietarySentence("SBAS", MessageHandler{&decoders::sbas, SATELLITES, &decoders::parseSbas}),
+	proprietarySentence("VER", MessageHandler{&decoders::pstmver, ALWAYS, nullptr}),
+	proprietarySentence("STAGPS8PASSRTN", MessageHandler{&decoders::pstmstagps8passrtn, ALWAYS, nullptr}),
+	proprietarySentence("STAGPS8PASSGENERROR", MessageHandler{&decoders::pstmstagps8passrtn, ALWAYS, nullptr}),
+	proprietarySentence("STAGPSPASSRTN", MessageHandler{&decoders::pstmstagpspassrtn, ALWAYS, nullptr}),
+	proprietarySentence("STAGPSPASSGENERROR", MessageHandler{&decoders::pstmstagpspassrtn, ALWAYS, nullptr}),
+	proprietarySentence("STAGPSSATSEEDOK", MessageHandler{&decoders::pstmstagpssatseedresponse, ALWAYS, nullptr}),
+	proprietarySentence("STAGPSSATSEEDERROR", MessageHandler{&decoders::pstmstagpssatseedresponse, ALWAYS, nullptr}),
+	proprietarySentence("DRCAL", MessageHandler{&decoders::drcal, ALWAYS, nullptr}),
+	proprietarySentence("TG", MessageHandler{&decoders::tg, ALWAYS, nullptr})
 };
 
-MessageDecoder getMessageDecoder(const NmeaMessage & msg)
+constexpr static auto decoderTable = makeSentenceTable(registrations);
+
+static_assert(decoderTable.hasUniqueKeys(), "Duplicated NMEA decoder registration or sentence key collision");
+
+static MessageHandler getMessageHandler(const NmeaMessage & msg)
 {
-	frozen::string sid(bytesToString(msg.sentenceId));
+	const SentenceFamily family = sentenceFamilyOf(msg);
 
-	if(msg.talkerId == TalkerId::PSTM)
+	MessageHandler handler = decoderTable.find(family, msg.sentenceId, MessageHandler{nullptr, ALWAYS, nullptr});
+
+	#ifdef DEBUG_NMEA_DECODER
+	if(handler.decoder == nullptr)
 	{
-		auto it = stm.find(sid);
+		ALOGW("No decoder for %s message, talkerId: '%s', sentenceId: '%s'",
+			family == SentenceFamily::PROPRIETARY ? "proprietary" : "standard",
+			TalkerIdToString(msg.talkerId),
+			utils::bytesToString(msg.sentenceId).c_str());
+	}
+	#endif
 
-		#ifdef DEBUG_NMEA_DECODER
-		if(it == stm.end())
-		{
-			ALOGW("No decoder for proprietary message, talkerId: '%s', sentenceId: '%s'",
-				TalkerIdToString(msg.talkerId),
-				utils::bytesToString(msg.sentenceId).c_str());
-		}
-		#endif
+	return handler;
+}
 
-		return (it != stm.end()) ? (*it).second : nullptr;
-	}
-	else
+void decode(AbstractDevice & dev, const NmeaMessage & msg, DecodeCache * cache)
+{
+	MessageHandler h = getMessageHandler(msg);
+
+	if(h.decoder == nullptr)
 	{
-		auto it = std.find(sid);
+#ifdef DEBUG_NMEA_DECODER
+		ALOGW("Decoder is nullptr.");
+#endif
+		return;
+	}
 
-		#ifdef DEBUG_NMEA_DECODER
-		if(it == std.end())
-		{
-			ALOGW("No decoder for standard message, talkerId: '%s', sentenceId: '%s'",
-				TalkerIdToString(msg.talkerId),
-				utils::bytesToString(msg.sentenceId).c_str());
-		}
-		#endif
+	// Skip the decoders whose products nobody will see
+	if(h.products != ALWAYS && (h.products & dev.demandedProducts()) == 0)
+		return;
 
-		return (it != std.end()) ? (*it).second : nullptr;
+	if(cache == nullptr || h.parser == nullptr)
+	{
+		h.decoder(dev, msg);
+		return;
 	}
-}
 
-void decode(AbstractDevice & dev, const NmeaMessage & msg)
-{
-	MessageDecoder d = getMessageDecoder(msg);
+	// Replay the update of a sentence already received, byte for byte
+	const ByteView raw = msg.raw();
+	const uint64_t key = sentenceKey(sentenceFamilyOf(msg), msg.sentenceId.data(), msg.sentenceId.size()) ^
+		(static_cast<uint64_t>(msg.talkerId) << 32);
 
-	if(d != nullptr)
-		d(dev, msg);
-#ifdef DEBUG_NMEA_DECODER
-	else
+	if(const SatelliteSentence * cached = cache->find(key, raw, msg.crc))
 	{
-		ALOGW("Decoder is nullptr.");
+		decoders::applySatelliteSentence(dev, *cached);
+		return;
 	}
-#endif
+
+	SatelliteSentence s;
+	h.parser(msg, s);
+	cache->store(key, raw, msg.crc, s);
+	decoders::applySatelliteSentence(dev, s);
 }
 
 #ifdef MSG_DBG_RMC
@@ -168,14 +191,8 @@ void decoders::rmc(AbstractDevice & dev, const NmeaMessage & msg)
 		RMC_LOGW("Error while parsing GGA timestamp, defaulted to system now.");
 	}
 
+	// Also sets the epoch location timestamp
 	dev.setTimestamp(timestamp);
-
-	auto locResult = dev.getLocation();
-	Location loc = locResult ? *locResult : Location();
-
-	loc.timestamp(timestamp);
-
-	dev.setLocation(loc);
 }
 
 #ifdef MSG_DBG_GGA
@@ -189,20 +206,29 @@ void decoders::gga(AbstractDevice & dev, const NmeaMessage & msg)
 {
 	GGA_LOGI("Decode GGA: %s", msg.toString().c_str());
 
-	DegreeMinuteCoordinate lat(msg.parameters[1], msg.parameters[2][0]);
-	DegreeMinuteCoordinate lon(msg.parameters[3], msg.parameters[4][0]);
-	FixQuality quality = FixQualityFromInt(msg.parameters[5][0] - '0');
-	double HDOP = utils::byteVectorParse<double>(msg.parameters[7]).value_or(0);
-	double altitude = utils::byteVectorParse<double>(msg.parameters[8]).value_or(0);
+	// Position fields are empty while there is no fix
+	double latitude = 0., longitude = 0.;
+	bool hasPosition =
+		utils::parseCoordinate(msg.parameters[1], msg.parameters[2], latitude) == utils::ParseStatus::OK &&
+		utils::parseCoordinate(msg.parameters[3], msg.parameters[4], longitude) == utils::ParseStatus::OK;
 
-	auto locResult = dev.getLocation();
-	Location loc = locResult ? *locResult : Location();
+	int32_t qualityValue = 0;
+	FixQuality quality = FixQuality::Invalid;
+
+	if(utils::parseNumber(msg.parameters[5], qualityValue) == utils::ParseStatus::OK && qualityValue >= 0)
+		quality = FixQualityFromInt(static_cast<uint8_t>(std::min<int32_t>(qualityValue, UINT8_MAX)));
+
+	double HDOP = 0., altitude = 0.;
+	utils::parseNumber(msg.parameters[7], HDOP);
+	utils::parseNumber(msg.parameters[8], altitude);
+
+	Location & loc = dev.buildLocation();
 
 	loc.quality(quality);
 
 	dev.getDrInfo().setGgaFixQual(quality);
 
-	if(quality == FixQuality::Invalid)
+	if(quality == FixQuality::Invalid || !hasPosition)
 	{
 		loc.invalidateLocation();
 		loc.invalidateAltitude();
@@ -210,13 +236,10 @@ void decoders::gga(AbstractDevice & dev, const NmeaMessage & msg)
 	}
 	else
 	{
-		loc.location(lat.asDecimalDegree().value(),
-		             lon.asDecimalDegree().value());
+		loc.location(latitude, longitude);
 		loc.altitude(altitude);
 		loc.accuracy(HDOP);
 	}
-
-	dev.setLocation(loc);
 }
 
 #ifdef MSG_DBG_VTG
@@ -240,8 +263,7 @@ void decoders::vtg(AbstractDevice & dev, const NmeaMessage & msg)
 	if(msg.parameters.size() > 9)
 		faaMode = utils::byteVectorParse<int>(msg.parameters[9]).value_or(0);
 
-	auto locResult = dev.getLocation();
-	Location loc = locResult ? *locResult : Location();
+	Location & loc = dev.buildLocation();
 
 	if(faaMode != 'N')
 	{
@@ -253,8 +275,6 @@ void decoders::vtg(AbstractDevice & dev, const NmeaMessage & msg)
 		loc.invalidateSpeed();
 		loc.invalidateBearing();
 	}
-
-	dev.setLocation(loc);
 }
 
 #ifdef MSG_DBG_GSV
@@ -269,8 +289,8 @@ void decoders::vtg(AbstractDevice & dev, const NmeaMessage & msg)
 template<typename T>
 void gsv_empty_or_set_helper(
 	T & out,
-	std::vector<const ByteVector>::iterator & it,
-	std::vector<const ByteVector>::iterator end,
+	NmeaMessage::Parameters::const_iterator & it,
+	NmeaMessage::Parameters::const_iterator end,
 	bool & emptyValue, T defaultValue)
 {
 	if(it >= end)
@@ -296,8 +316,8 @@ void gsv_empty_or_set_helper(
 template<typename T>
 bool gsv_empty_or_set_helper(
 	T & out,
-	std::vector<const ByteVector>::iterator & it,
-	std::vector<const ByteVector>::iterator end,
+	NmeaMessage::Parameters::const_iterator & it,
+	NmeaMessage::Parameters::const_iterator end,
 	bool & emptyValue)
 {
 	if(it >= end)
@@ -328,9 +348,19 @@ bool gsv_empty_or_set_helper(
 }
 
 void decoders::gsv(AbstractDevice & dev, const NmeaMessage & msg)
+{
+	SatelliteSentence s;
+	parseGsv(msg, s);
+	applySatelliteSentence(dev, s);
+}
+
+void decoders::parseGsv(const NmeaMessage & msg, SatelliteSentence & out)
 {
 	GSV_LOGI("Decode GSV: %s", msg.toString().c_str());
 
+	out.type = SatelliteSentence::Type::GSV;
+	out.count = 0;
+
 	// First three parameters are unused
 	auto it = msg.parameters.begin() + 3;
 
@@ -338,8 +368,8 @@ void decoders::gsv(AbstractDevice & dev, const NmeaMessage & msg)
 	//int sentenceId         = utils::byteVectorParse<int>(*it); // unused
 	//int NumberOfSatellites = utils::byteVectorParseInt(msg.parameters[2]); // unused
 
-	// Extract and update or insert satellites
-	while(it != msg.parameters.end())
+	// Extract satellites
+	while(it != msg.parameters.end() && out.count < out.satellites.size())
 	{
 		bool emptyValue = false, notTracked = false;
 		int16_t prn;
@@ -365,26 +395,7 @@ void decoders::gsv(AbstractDevice & dev, const NmeaMessage & msg)
 		}
 		else
 		{
-			SatIdentifier id(prn);
-
-			auto result = dev.getSatellite(id);
-			SatInfo s = result ? *result : SatInfo(id);
-
-			s.setElevation(elevation)
-			 .setAzimuth(azimuth)
-			 .setSnr(snr)
-			 .setTracked(!notTracked);
-
-			dev.addSatellite(s);
-
-			GSV_LOGI("%s sat prn %d: elevation: %f, azimuth: %f, snr: %f, tracked: %s",
-				result ? "Update" : "Insert new",
-				s.getId().getPrn(),
-				elevation,
-				azimuth,
-				snr,
-				!notTracked ? "true" : "false"
-			);
+			out.satellites[out.count++] = {prn, elevation, azimuth, snr, !notTracked, false};
 		}
 	}
 }
@@ -399,44 +410,36 @@ void decoders::gsv(AbstractDevice & dev, const NmeaMessage & msg)
 #define GSA_LOGE(...)
 #endif
 void decoders::gsa(AbstractDevice & dev, const NmeaMessage & msg)
+{
+	SatelliteSentence s;
+	parseGsa(msg, s);
+	applySatelliteSentence(dev, s);
+}
+
+void decoders::parseGsa(const NmeaMessage & msg, SatelliteSentence & out)
 {
 	GSA_LOGI("Decode GSA: %s", msg.toString().c_str());
 
+	out.type = SatelliteSentence::Type::GSA;
+	out.count = 0;
+
 	// First two parameters are unused
 	auto it = msg.parameters.begin() + 1;
 
 	// Selection mode: Auto or Manual - unused
 	//char selectionMode = (*it).at(0);
 
-	// Mode: 1 = no fix / 2 = 2D fix / 3 = 3D fix - unused
-	FixMode mode = FixModeFromChar((*it).at(0));
+	// Mode: 1 = no fix / 2 = 2D fix / 3 = 3D fix
+	out.mode = FixModeFromChar((*it).at(0));
 	++it;
 
-	// Update fix mode
-	auto locResult = dev.getLocation();
-	Location loc = locResult ? *locResult : Location();
-	loc.fixMode(mode);
-	dev.getDrInfo().setGsaFixMode(mode);
-	dev.setLocation(loc);
-
-	// Update satellites usage informations
+	// Satellites used in fix
 	for(int i = 0; i < 12; i++)
 	{
 		if((*it).size() > 0)
 		{
 			if(auto opt = utils::byteVectorParse<int>(*it))
-			{
-				SatIdentifier id(*opt);
-
-				auto result = dev.getSatellite(id);
-				SatInfo s = result ? *result : SatInfo(id);
-
-				s.setUsedInFix(true)
-				.setAlmanac(true)
-				.setEphemeris(true);
-
-				dev.addSatellite(s);
-			}
+				out.satellites[out.count++] = {static_cast<int16_t>(*opt), 0., 0., 0., false, true};
 		}
 
 		++it;
@@ -453,16 +456,27 @@ void decoders::gsa(AbstractDevice & dev, const NmeaMessage & msg)
 #define SBAS_LOGE(...)
 #endif
 void decoders::sbas(AbstractDevice & dev, const NmeaMessage & msg)
+{
+	SatelliteSentence s;
+	parseSbas(msg, s);
+	applySatelliteSentence(dev, s);
+}
+
+void decoders::parseSbas(const NmeaMessage & msg, SatelliteSentence & out)
 {
 	SBAS_LOGI("Decode SBAS: %s", msg.toString().c_str());
+
+	out.type = SatelliteSentence::Type::SBAS;
+	out.count = 0;
+
 	auto it = msg.parameters.begin();
 
 	bool used    = utils::byteVectorParse<bool>(*it).value_or(true); ++it;
 	bool tracked = utils::byteVectorParse<bool>(*it).value_or(true); ++it;
 
-	SatIdentifier id;
+	int16_t prn;
 	if(auto opt = utils::byteVectorParse<int>(*it))
-		id = SatIdentifier(*opt);
+		prn = static_cast<int16_t>(*opt);
 	else
 		return;
 
@@ -472,26 +486,71 @@ void decoders::sbas(AbstractDevice & dev, const NmeaMessage & msg)
 	float azimuth   = utils::byteVectorParse<float>(*it).value_or(0.); ++it;
 	float snr       = utils::byteVectorParse<float>(*it).value_or(0.); ++it;
 
-	auto result = dev.getSatellite(id);
-	SatInfo s = result ? *result : SatInfo(id);
-
-	s.setUsedInFix(used)
-	 .setAlmanac(true)
-	 .setEphemeris(true)
-	 .setElevation(elevation)
-	 .setAzimuth(azimuth)
-	 .setSnr(snr)
-	 .setTracked(tracked);
-
-	dev.addSatellite(s);
-
-	SBAS_LOGI("%s sat prn %d: elevation: %f, azimuth: %f, snr: %f, tracked: %s",
-		result ? "Update" : "Insert new",
-		id.getPrn(),
-		elevation,
-		azimuth,
-		snr,
-		tracked ? "true" : "false");
+	out.satellites[out.count++] = {prn, elevation, azimuth, snr, tracked, used};
+}
+
+void decoders::applySatelliteSentence(AbstractDevice & dev, const SatelliteSentence & s)
+{
+	if(s.type == SatelliteSentence::Type::GSA)
+	{
+		// Update fix mode
+		dev.buildLocation().fixMode(s.mode);
+		dev.getDrInfo().setGsaFixMode(s.mode);
+	}
+
+	for(uint8_t i = 0; i < s.count; i++)
+	{
+		const SatelliteSentence::Satellite & sat = s.satellites[i];
+
+		auto result = dev.updateSatellite(SatIdentifier(sat.prn));
+
+		if(!result.first)
+			continue;
+
+		switch(s.type)
+		{
+		case SatelliteSentence::Type::GSV:
+			result.first->setElevation(sat.elevation)
+			 .setAzimuth(sat.azimuth)
+			 .setSnr(sat.snr)
+			 .setTracked(sat.tracked);
+
+			GSV_LOGI("%s sat prn %d: elevation: %f, azimuth: %f, snr: %f, tracked: %s",
+				result.second ? "Insert new" : "Update",
+				sat.prn,
+				sat.elevation,
+				sat.azimuth,
+				sat.snr,
+				sat.tracked ? "true" : "false"
+			);
+			break;
+
+		case SatelliteSentence::Type::GSA:
+			// Update satellites usage informations
+			result.first->setUsedInFix(true)
+			 .setAlmanac(true)
+			 .setEphemeris(true);
+			break;
+
+		case SatelliteSentence::Type::SBAS:
+			result.first->setUsedInFix(sat.used)
+			 .setAlmanac(true)
+			 .setEphemeris(true)
+			 .setElevation(sat.elevation)
+			 .setAzimuth(sat.azimuth)
+			 .setSnr(sat.snr)
+			 .setTracked(sat.tracked);
+
+			SBAS_LOGI("%s sat prn %d: elevation: %f, azimuth: %f, snr: %f, tracked: %s",
+				result.second ? "Insert new" : "Update",
+				sat.prn,
+				sat.elevation,
+				sat.azimuth,
+				sat.snr,
+				sat.tracked ? "true" : "false");
+			break;
+		}
+	}
 }
 
 #ifdef MSG_DBG_PSTMVER
@@ -543,7 +602,7 @@ void decoders::pstmstagps8passrtn(AbstractDevice & dev, const NmeaMessage & msg)
 	{
 		STAGPS8PASSRTN_LOGI("Decode PSTMSTAGPS8PASSRTN: %s", msg.toCString());
 		STAGPS8PASSRTN_LOGI("Device id: %s - Password: %s", bytesToString(msg.parameters.at(0)).c_str(),bytesToString(msg.parameters.at(1)).c_str());
-		dev.onStagps8Answer(model::Stagps8Answer::PasswordReturnOk, {msg.parameters.at(0),msg.parameters.at(1)});
+		dev.onStagps8Answer(model::Stagps8Answer::PasswordReturnOk, {msg.parameters.at(0).toVector(), msg.parameters.at(1).toVector()});
 	}
 }
 
@@ -568,7 +627,7 @@ void decoders::pstmstagpspassrtn(AbstractDevice & dev, const NmeaMessage & msg)
 	{
 		STAGPSPASSRTN_LOGI("Decode PSTMSTAGPSPASSRTN: %s", msg.toCString());
 		STAGPSPASSRTN_LOGI("Password string: %s", bytesToString(msg.parameters.at(0)).c_str());
-		dev.onStagpsAnswer(model::StagpsAnswer::PasswordReturnOk, { msg.parameters.at(0) });
+		dev.onStagpsAnswer(model::StagpsAnswer::PasswordReturnOk, { msg.parameters.at(0).toVector() });
 	}
 }
 
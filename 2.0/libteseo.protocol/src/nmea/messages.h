@@ -28,8 +28,13 @@
 #ifndef TESEO_HAL_DECODER_NMEA_MESSAGES_H
 #define TESEO_HAL_DECODER_NMEA_MESSAGES_H
 
+#include <array>
+#include <cstdint>
+
+#include <teseo/model/FixAndOperatingModes.h>
 #include <teseo/model/NmeaMessage.h>
 #include <teseo/protocol/NmeaDecoder.h>
+#include <teseo/protocol/SentenceCache.h>
 #include <teseo/device/AbstractDevice.h>
 
 namespace stm {
@@ -38,6 +43,49 @@ namespace nmea {
 
 using namespace stm::device;
 
+/**
+ * @brief      Satellite update extracted from a GSV, GSA or PSTMSBAS sentence
+ *
+ * @details    The update only depends on the sentence bytes, so it can be cached and applied again
+ * when the same sentence is received.
+ */
+struct SatelliteSentence {
+	enum class Type : uint8_t {
+		GSV,
+		GSA,
+		SBAS
+	};
+
+	struct Satellite {
+		int16_t prn;
+		float elevation;
+		float azimuth;
+		float snr;
+		bool tracked;
+		bool used;
+	};
+
+	Type type;
+
+	/**
+	 * Fix mode, for GSA
+	 */
+	model::FixMode mode;
+
+	uint8_t count;
+
+	std::array<Satellite, 12> satellites;
+};
+
+typedef void (*SentenceParser)(const NmeaMessage & msg, SatelliteSentence & out);
+
+/**
+ * @brief      Cache of the satellite updates, keyed by sentence
+ */
+class DecodeCache :
+	public SentenceCache<SatelliteSentence, 64>
+{ };
+
 /**
  * @brief      NMEA Message decoders
  *
@@ -80,6 +128,14 @@ public:
 	 */
 	static void gsv(AbstractDevice & dev, const NmeaMessage & msg);
 
+	/**
+	 * @brief      --GSV parser
+	 *
+	 * @param[in]  msg   GSV Message to parse
+	 * @param      out   The satellite update
+	 */
+	static void parseGsv(const NmeaMessage & msg, SatelliteSentence & out);
+
 	/**
 	 * @brief      --GSA decoder
 	 *
@@ -88,6 +144,14 @@ public:
 	 */
 	static void gsa(AbstractDevice & dev, const NmeaMessage & msg);
 
+	/**
+	 * @brief      --GSA parser
+	 *
+	 * @param[in]  msg   GSA Message to parse
+	 * @param      out   The satellite update
+	 */
+	static void parseGsa(const NmeaMessage & msg, SatelliteSentence & out);
+
 	/**
 	 * @brief      PSTMSBAS decoder
 	 *
@@ -96,6 +160,22 @@ public:
 	 */
 	static void sbas(AbstractDevice & dev, const NmeaMessage & msg);
 
+	/**
+	 * @brief      PSTMSBAS parser
+	 *
+	 * @param[in]  msg   PSTMSBAS Message to parse
+	 * @param      out   The satellite update
+	 */
+	static void parseSbas(const NmeaMessage & msg, SatelliteSentence & out);
+
+	/**
+	 * @brief      Apply a satellite update parsed from a GSV, GSA or PSTMSBAS sentence
+	 *
+	 * @param      dev   Device to update
+	 * @param[in]  s     The satellite update
+	 */
+	static void applySatelliteSentence(AbstractDevice & dev, const SatelliteSentence & s);
+
 	/**
 	 * @brief      PSTMVER decoder
 	 *
@@ -148,10 +228,11 @@ public:
 /**
  * @brief      Decode an NMEA message
  *
- * @param      dev   The device to update while decoding
- * @param[in]  msg   The message to decode
+ * @param      dev    The device to update while decoding
+ * @param[in]  msg    The message to decode
+ * @param      cache  Cache of the satellite updates, nullptr to parse every sentence
  */
-void decode(AbstractDevice & dev, const NmeaMessage & msg);
+void decode(AbstractDevice & dev, const NmeaMessage & msg, DecodeCache * cache = nullptr);
 
 } // namespace nmea
 } // namespace decoder
@@ -0,0 +1,112 @@
+/*
+* This file is part of Teseo Android HAL
+*
+* Copyright (c) 2016-2018, STMicroelectronics - All Rights Reserved
+* Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+*
+* License terms: Apache 2.0.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+/**
+ * @brief Helpers shared by the unit tests
+ * @file TestHelpers.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_TEST_HELPERS_H
+#define TESEO_HAL_TEST_HELPERS_H
+
+#include <catch.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <teseo/utils/ByteVector.h>
+#include <teseo/utils/Capture.h>
+
+namespace stm {
+namespace test {
+
+/**
+ * @brief      Path of a temporary file, in TMPDIR or in the device temporary directory
+ */
+inline std::string tmpPath(const char * name)
+{
+	const char * dir = getenv("TMPDIR");
+	return std::string(dir ? dir : "/data/local/tmp") + "/" + name;
+}
+
+inline void writeFile(const std::string & path, const std::string & content)
+{
+	FILE * f = fopen(path.c_str(), "wb");
+	REQUIRE(f != nullptr);
+	fwrite(content.data(), 1, content.size(), f);
+	fclose(f);
+}
+
+/**
+ * @brief      Append a capture record to a capture file content
+ */
+inline void appendRecord(std::string & out, uint64_t timestamp, stream::capture::Direction dir, const std::string & bytes)
+{
+	stream::capture::RecordHeader header = {};
+	header.timestamp = timestamp;
+	header.length = static_cast<uint32_t>(bytes.size());
+	header.direction = static_cast<uint8_t>(dir);
+	out.append(reinterpret_cast<const char *>(&header), sizeof(header));
+	out.append(bytes);
+}
+
+/**
+ * @brief      Build a sentence with its checksum, without line ending
+ */
+inline std::string sentence(const std::string & body)
+{
+	uint8_t crc = 0;
+
+	for(char c : body)
+		crc ^= static_cast<uint8_t>(c);
+
+	char checksum[3];
+	snprintf(checksum, sizeof(checksum), "%02X", crc);
+
+	return "$" + body + "*" + checksum;
+}
+
+/**
+ * @brief      Build a sentence with its checksum and line ending
+ */
+inline std::string sentenceLine(const std::string & body)
+{
+	return sentence(body) + "\r\n";
+}
+
+/**
+ * @brief      Build a sentence with its checksum, as decoder input
+ */
+inline ByteVectorPtr sentenceBytes(const std::string & body)
+{
+	std::string s = sentence(body);
+	return std::make_shared<ByteVector>(s.begin(), s.end());
+}
+
+} // namespace test
+} // namespace stm
+
+#endif // TESEO_HAL_TEST_HELPERS_H
@@ -0,0 +1,103 @@
+/*
+* This file is part of Teseo Android HAL
+*
+* Copyright (c) 2016-2018, STMicroelectronics - All Rights Reserved
+* Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+*
+* License terms: Apache 2.0.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+#include <catch.hpp>
+
+#include <string>
+
+#include <teseo/model/NmeaMessage.h>
+
+using namespace stm;
+using namespace stm::model;
+
+namespace {
+
+ByteVectorPtr sentence(const std::string & str)
+{
+	return std::make_shared<ByteVector>(str.begin(), str.end());
+}
+
+std::string str(ByteView view)
+{
+	return utils::bytesToString(view);
+}
+
+} // namespace
+
+TEST_CASE( "NmeaMessage indexes the sentence fields", "[model][NmeaMessage]" ) {
+
+	NmeaMessage msg(sentence("$GPGSV,3,1,11,03,03,111,,04,15,270,00*7F"));
+
+	REQUIRE(msg.talkerId == TalkerId::GP);
+	REQUIRE(str(msg.sentenceId) == "GSV");
+	REQUIRE(msg.crc == 0x7F);
+
+	REQUIRE(msg.parameters.size() == 11);
+	REQUIRE(str(msg.parameters[0]) == "3");
+	REQUIRE(str(msg.parameters[5]) == "111");
+	REQUIRE(msg.parameters[6].empty());
+	REQUIRE(str(msg.parameters[10]) == "00");
+
+	// Out of range parameters are empty, at() throws
+	REQUIRE(msg.parameters[11].empty());
+	REQUIRE_THROWS_AS(msg.parameters.at(11), std::out_of_range);
+
+	std::size_t count = 0;
+	for(auto it = msg.parameters.begin(); it != msg.parameters.end(); ++it)
+		count++;
+	REQUIRE(count == 11);
+
+	REQUIRE(msg.toString() == "$GPGSV,3,1,11,03,03,111,,04,15,270,00*7F");
+}
+
+TEST_CASE( "NmeaMessage handles proprietary and parameterless sentences", "[model][NmeaMessage]" ) {
+
+	NmeaMessage ver(sentence("$PSTMVER,GNSSLIB_8.4.18.25_ARM*4B"));
+
+	REQUIRE(ver.talkerId == TalkerId::PSTM);
+	REQUIRE(str(ver.sentenceId) == "VER");
+	REQUIRE(ver.parameters.size() == 1);
+	REQUIRE(str(ver.parameters.at(0)) == "GNSSLIB_8.4.18.25_ARM");
+
+	NmeaMessage srr(sentence("$PSTMSRR*49"));
+
+	REQUIRE(str(srr.sentenceId) == "SRR");
+	REQUIRE(srr.parameters.empty());
+
+	NmeaMessage trailing(sentence("$GPGLL,,*00"));
+
+	REQUIRE(trailing.parameters.size() == 2);
+	REQUIRE(trailing.parameters[0].empty());
+	REQUIRE(trailing.parameters[1].empty());
+}
+
+TEST_CASE( "NmeaMessage copies share the sentence bytes", "[model][NmeaMessage]" ) {
+
+	ByteVectorPtr bytes = sentence("$GPRMC,123519,A,4807.038,N*00");
+	NmeaMessage * original = new NmeaMessage(bytes);
+	NmeaMessage copy(*original);
+	delete original;
+
+	REQUIRE(str(copy.sentenceId) == "RMC");
+	REQUIRE(copy.parameters.size() == 4);
+	REQUIRE(str(copy.parameters[2]) == "4807.038");
+	REQUIRE(copy.raw().data() == bytes->data());
+}
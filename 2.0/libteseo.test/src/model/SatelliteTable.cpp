@@ -0,0 +1,89 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+
+#include <vector>
+
+#include <teseo/model/SatelliteTable.h>
+
+using namespace stm;
+
+TEST_CASE( "PRN lookup matches PRN classification", "[model][SatelliteTable]" ) {
+
+	for(int16_t prn = -2; prn <= PRN_IRN_MAX + 2; prn++)
+		CHECK(SatelliteTable::constellationOf(prn) == classifyPrn(prn));
+
+	CHECK(SatelliteTable::constellationOf(PRN_GLO_MIN) == GnssConstellationType::GLONASS);
+	CHECK(SatelliteTable::constellationOf(120) == GnssConstellationType::SBAS);
+	CHECK(SatelliteTable::constellationOf(121) == GnssConstellationType::UNKNOWN);
+}
+
+TEST_CASE( "Satellite table updates satellites in place", "[model][SatelliteTable]" ) {
+
+	SatelliteTable table;
+
+	CHECK(table.empty());
+	CHECK(table.begin() == table.end());
+
+	auto gps = table.insert(SatIdentifier(12));
+	REQUIRE(gps.first != nullptr);
+	CHECK(gps.second);
+	gps.first->setSnr(40).setTracked(true);
+
+	auto again = table.insert(SatIdentifier(12));
+	CHECK(again.first == gps.first);
+	CHECK_FALSE(again.second);
+	CHECK(again.first->getSnr() == 40);
+
+	auto glonass = table.insert(SatIdentifier(GnssConstellationType::GLONASS, 3));
+	REQUIRE(glonass.first != nullptr);
+	CHECK(glonass.first->getId().getPrn() == PRN_GLO_MIN + 2);
+
+	table.insert(SatIdentifier(5));
+
+	// Unknown PRNs can't be stored
+	CHECK(table.insert(SatIdentifier(60)).first == nullptr);
+
+	CHECK(table.size() == 3);
+	CHECK(table.find(SatIdentifier(12)) == gps.first);
+	CHECK(table.find(SatIdentifier(13)) == nullptr);
+
+	// Iteration is ordered by PRN
+	std::vector<int16_t> prns;
+	for(const SatInfo & sat : table)
+		prns.push_back(sat.getId().getPrn());
+
+	CHECK(prns == std::vector<int16_t>({5, 12, PRN_GLO_MIN + 2}));
+
+	uint32_t generation = table.generation();
+	table.clear();
+
+	CHECK(table.generation() != generation);
+	CHECK(table.empty());
+	CHECK(table.begin() == table.end());
+	CHECK(table.find(SatIdentifier(12)) == nullptr);
+
+	// Reinserted satellites start from default information
+	auto reinserted = table.insert(SatIdentifier(12));
+	CHECK(reinserted.second);
+	CHECK(reinserted.first->getSnr() == -1);
+	CHECK(table.size() == 1);
+}
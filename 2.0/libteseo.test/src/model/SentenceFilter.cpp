@@ -0,0 +1,77 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+
+#include <string>
+
+#include <teseo/model/SentenceFilter.h>
+
+using namespace stm;
+using namespace stm::model;
+using stm::utils::SentenceFamily;
+
+namespace {
+
+NmeaMessage message(const std::string & str)
+{
+	return NmeaMessage(std::make_shared<ByteVector>(str.begin(), str.end()));
+}
+
+} // anonymous namespace
+
+TEST_CASE( "Sentence filter matches sentence IDs of any talker", "[model][SentenceFilter]" ) {
+
+	SentenceFilter filter = SentenceFilter().standard("GSV").proprietary("TG");
+
+	CHECK(filter.matches(message("$GPGSV,3,1,11,03,03,111,,04,15,270,00*7F")));
+	CHECK(filter.matches(message("$GLGSV,1,1,00*65")));
+	CHECK(filter.matches(message("$PSTMTG,1,2*00")));
+	CHECK_FALSE(filter.matches(message("$GPGSA,A,3*00")));
+	CHECK_FALSE(filter.matches(message("$PSTMSBAS,1,1*00")));
+	CHECK_FALSE(filter.matchesAll());
+
+	SentenceFilter none;
+	CHECK_FALSE(none.matches(message("$GPRMC,1*00")));
+
+	SentenceFilter all = SentenceFilter::all();
+	CHECK(all.matchesAll());
+	CHECK(all.matches(message("$GPRMC,1*00")));
+	CHECK(all.matches(message("$PSTMVER,1*00")));
+
+	SentenceFilter proprietary = SentenceFilter().family(SentenceFamily::PROPRIETARY);
+	CHECK(proprietary.matches(message("$PSTMVER,1*00")));
+	CHECK_FALSE(proprietary.matches(message("$GPRMC,1*00")));
+}
+
+TEST_CASE( "Full sentence filter accepts the whole family", "[model][SentenceFilter]" ) {
+
+	SentenceFilter filter;
+
+	for(std::size_t i = 0; i < SentenceFilter::MAX_SENTENCES; i++)
+		filter.proprietary("TG");
+
+	CHECK_FALSE(filter.matches(message("$PSTMVER,1*00")));
+
+	filter.proprietary("SBAS");
+
+	CHECK(filter.matches(message("$PSTMVER,1*00")));
+	CHECK_FALSE(filter.matches(message("$GPRMC,1*00")));
+}
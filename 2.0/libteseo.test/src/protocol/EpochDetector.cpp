@@ -0,0 +1,244 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+#include <TestHelpers.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <teseo/model/NmeaMessage.h>
+#include <teseo/protocol/EpochDetector.h>
+#include <teseo/utils/Capture.h>
+#include <teseo/utils/NmeaStream.h>
+#include <teseo/utils/ReplayByteStream.h>
+
+using namespace stm;
+using namespace stm::decoder;
+using namespace stm::stream;
+using namespace stm::test;
+
+namespace {
+
+constexpr int EPOCH_COUNT = 6;
+
+constexpr uint64_t EPOCH_PERIOD_NS = 1000000000;
+
+constexpr uint64_t SENTENCE_PERIOD_NS = 20000000;
+
+/**
+ * Sentences of one epoch, as output by a Teseo at 1 Hz
+ */
+std::vector<std::string> epochSentences(int epoch)
+{
+	char time[16];
+	snprintf(time, sizeof(time), "1200%02d.000", epoch);
+
+	return {
+		std::string("GPGGA,") + time + ",4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,",
+		std::string("GPRMC,") + time + ",A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W",
+		"GNGSA,A,3,04,05,09,12,,,,,,,,,2.5,1.3,2.1",
+		"GPVTG,084.4,T,,M,022.4,N,041.5,K,A",
+		"GPGSV,2,1,05,04,45,172,28,05,20,090,31,09,60,300,40,12,10,030,22",
+		"GPGSV,2,2,05,25,05,250,",
+		"GLGSV,1,1,02,65,30,120,35,66,50,200,38"
+	};
+}
+
+std::string captureFile(std::vector<uint64_t> & sentenceTimes)
+{
+	capture::FileHeader header = {};
+	std::copy(std::begin(capture::MAGIC), std::end(capture::MAGIC), header.magic);
+	header.version = capture::VERSION;
+	header.headerSize = sizeof(header);
+
+	std::string out(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	for(int epoch = 0; epoch < EPOCH_COUNT; epoch++)
+	{
+		uint64_t timestamp = EPOCH_PERIOD_NS * (epoch + 1);
+
+		for(const auto & body : epochSentences(epoch))
+		{
+			std::string bytes = sentenceLine(body);
+
+			capture::RecordHeader record = {};
+			record.timestamp = timestamp;
+			record.length = static_cast<uint32_t>(bytes.size());
+			record.direction = static_cast<uint8_t>(capture::Direction::RX);
+			out.append(reinterpret_cast<const char *>(&record), sizeof(record));
+			out.append(bytes);
+
+			sentenceTimes.push_back(timestamp);
+			timestamp += SENTENCE_PERIOD_NS;
+		}
+	}
+
+	return out;
+}
+
+/**
+ * Decoder stand-in recording when epochs are published
+ */
+struct EpochSink : public Trackable {
+	EpochDetector detector;
+
+	const std::vector<uint64_t> & sentenceTimes;
+
+	std::size_t index = 0;
+
+	uint64_t lastSentenceTime = 0;
+
+	/**
+	 * Delay between the last sentence of each epoch and its publication
+	 */
+	std::vector<uint64_t> latencies;
+
+	std::atomic<bool> done{false};
+
+	EpochSink(const std::string & terminal, const std::vector<uint64_t> & sentenceTimes) :
+		detector(terminal), sentenceTimes(sentenceTimes)
+	{ }
+
+	void onSentence(ByteVectorPtr bytes)
+	{
+		NmeaMessage msg(bytes);
+		const uint64_t now = sentenceTimes.at(index++);
+
+		unsigned int actions = detector.onSentence(msg);
+
+		if(actions & EpochDetector::PUBLISH_BEFORE)
+			latencies.push_back(now - lastSentenceTime);
+
+		lastSentenceTime = now;
+
+		if(actions & EpochDetector::PUBLISH_AFTER)
+			latencies.push_back(0);
+	}
+
+	void onEnd() { done = true; }
+};
+
+void replay(EpochSink & sink, const std::string & path)
+{
+	Thread::setCreateThreadCb(Thread::createPthread);
+
+	NmeaStream nmeaStream;
+	IStream & nmea = nmeaStream;
+	ReplayByteStream replayStream(path, ReplayPacing::AS_FAST_AS_POSSIBLE);
+
+	replayStream.newBytes.connect(SlotFactory::create(nmea, &IStream::onNewBytes));
+	nmea.newSentence.connect(SlotFactory::create(sink, &EpochSink::onSentence));
+	replayStream.endOfCapture.connect(SlotFactory::create(sink, &EpochSink::onEnd));
+
+	replayStream.start();
+
+	for(int i = 0; i < 200 && !sink.done; i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	replayStream.stop();
+	replayStream.join();
+
+	REQUIRE(sink.done);
+}
+
+} // namespace
+
+TEST_CASE( "Epochs of a replayed capture are published without delay", "[protocol][EpochDetector]" ) {
+
+	std::vector<uint64_t> sentenceTimes;
+	std::string path = tmpPath("teseo-epoch.cap");
+
+	FILE * f = fopen(path.c_str(), "wb");
+	REQUIRE(f != nullptr);
+	std::string content = captureFile(sentenceTimes);
+	fwrite(content.data(), 1, content.size(), f);
+	fclose(f);
+
+	const uint64_t epochDuration = SENTENCE_PERIOD_NS * (epochSentences(0).size() - 1);
+
+	SECTION( "Learned terminal sentence" ) {
+		EpochSink sink("", sentenceTimes);
+		replay(sink, path);
+
+		REQUIRE(sink.index == sentenceTimes.size());
+		REQUIRE(sink.latencies.size() == EPOCH_COUNT);
+
+		// The terminal sentence is learned on the two first epochs, published when the next starts
+		CHECK(sink.latencies[0] == EPOCH_PERIOD_NS - epochDuration);
+		CHECK(sink.latencies[1] == EPOCH_PERIOD_NS - epochDuration);
+
+		for(int epoch = 2; epoch < EPOCH_COUNT; epoch++)
+			CHECK(sink.latencies[epoch] == 0);
+
+		CHECK(sink.detector.stats().fallbackEpochs == 2);
+		CHECK(sink.detector.stats().earlyEpochs == EPOCH_COUNT - 2);
+	}
+
+	SECTION( "Configured terminal sentence" ) {
+		EpochSink sink("GLGSV", sentenceTimes);
+		replay(sink, path);
+
+		REQUIRE(sink.latencies.size() == EPOCH_COUNT);
+
+		for(int epoch = 0; epoch < EPOCH_COUNT; epoch++)
+			CHECK(sink.latencies[epoch] == 0);
+
+		CHECK(sink.detector.stats().fallbackEpochs == 0);
+	}
+
+	remove(path.c_str());
+}
+
+TEST_CASE( "Epoch detector handles GSV groups and time changes", "[protocol][EpochDetector]" ) {
+
+	EpochDetector detector("GPGSV");
+
+	auto process = [&] (const std::string & body) {
+		return detector.onSentence(NmeaMessage(sentenceBytes(body)));
+	};
+
+	CHECK(process("GPGGA,120000.000,,,,,0,00,,,M,,M,,") == EpochDetector::NONE);
+	CHECK(process("GPRMC,120000.000,V,,,,,,,230394,,") == EpochDetector::NONE);
+
+	// Only the last sentence of the GSV group ends the epoch
+	CHECK(process("GPGSV,2,1,05,04,45,172,28,05,20,090,31,09,60,300,40,12,10,030,22") == EpochDetector::NONE);
+	CHECK(process("GPGSV,2,2,05,25,05,250,") == EpochDetector::PUBLISH_AFTER);
+
+	// The epoch is already published
+	CHECK(process("GLGSV,1,1,00") == EpochDetector::NONE);
+
+	// RMC time change starts an epoch, even without GGA
+	CHECK(process("GPRMC,120001.000,V,,,,,,,230394,,") == EpochDetector::NONE);
+	CHECK(process("GPGGA,120001.000,,,,,0,00,,,M,,M,,") == EpochDetector::NONE);
+	CHECK(process("GPRMC,120002.000,V,,,,,,,230394,,") == EpochDetector::PUBLISH_BEFORE);
+
+	// GGA without time always starts an epoch, as before the time is known
+	CHECK(process("GPGGA,,,,,,0,00,,,M,,M,,") == EpochDetector::PUBLISH_BEFORE);
+	CHECK(process("GPGGA,,,,,,0,00,,,M,,M,,") == EpochDetector::PUBLISH_BEFORE);
+
+	CHECK(detector.stats().earlyEpochs == 1);
+	CHECK(detector.stats().fallbackEpochs == 3);
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+#include <TestHelpers.h>
+
+#include <teseo/device/NmeaDevice.h>
+#include <teseo/protocol/NmeaDecoder.h>
+
+using namespace stm;
+using namespace stm::decoder;
+using namespace stm::device;
+using namespace stm::test;
+
+namespace {
+
+/**
+ * Decoder fed directly, without the decoding thread
+ */
+class TestDecoder :
+	public NmeaDecoder
+{
+public:
+	// Each GSV group ends the epoch, so it is published right after its decoding
+	TestDecoder(AbstractDevice & device) :
+		NmeaDecoder(device, "GPGSV")
+	{ }
+
+	using NmeaDecoder::decode;
+
+	/**
+	 * Decode one epoch, a GGA sentence at the given time and a GSV group
+	 */
+	void decodeEpoch(const std::string & time)
+	{
+		decode(sentenceBytes("GPGGA," + time + ",4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"));
+		decode(sentenceBytes("GPGSV,1,1,02,05,45,120,40,12,30,240,35"));
+	}
+};
+
+} // namespace
+
+TEST_CASE( "GSV sentences are decoded only while the satellites are demanded", "[protocol][NmeaDecoder]" ) {
+
+	NmeaDevice device;
+	TestDecoder decoder(device);
+
+	// Nobody demands the satellites, the GSV decoder is skipped
+	device.setDemand("framework", AbstractDevice::PRODUCT_LOCATION);
+	decoder.decodeEpoch("120000.000");
+
+	CHECK(device.getSnapshot().satellites.empty());
+
+	device.setDemand("satellites", AbstractDevice::PRODUCT_SATELLITES);
+	decoder.decodeEpoch("120001.000");
+
+	AbstractDevice::Snapshot snapshot = device.getSnapshot();
+	REQUIRE(snapshot.satellites.size() == 2);
+	CHECK(snapshot.satellites.find(SatIdentifier(12)) != nullptr);
+
+	// The getters read the fix and the satellites of the same published epoch
+	CHECK(device.getSatellite(SatIdentifier(12)));
+	CHECK_FALSE(device.getSatellite(SatIdentifier(13)));
+	CHECK(device.getLocation());
+
+	// The last consumer of the satellites is gone
+	device.setDemand("satellites", AbstractDevice::PRODUCT_NONE);
+	decoder.decodeEpoch("120002.000");
+
+	CHECK(device.getSnapshot().satellites.empty());
+}
+
+TEST_CASE( "NmeaDecoder publishes its statistics with each epoch", "[protocol][NmeaDecoder]" ) {
+
+	NmeaDevice device;
+	TestDecoder decoder(device);
+
+	CHECK(decoder.stats().epochs.earlyEpochs == 0);
+
+	decoder.decodeEpoch("120000.000");
+	decoder.decodeEpoch("120001.000");
+
+	NmeaDecoder::Stats stats = decoder.stats();
+	CHECK(stats.epochs.earlyEpochs == 2);
+	CHECK(stats.epochs.fallbackEpochs == 0);
+	CHECK(stats.cache.lookups == 0);
+}
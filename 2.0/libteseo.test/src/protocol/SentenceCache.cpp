@@ -0,0 +1,210 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <teseo/model/NmeaMessage.h>
+#include <teseo/protocol/SentenceCache.h>
+#include <teseo/utils/ByteView.h>
+#include <teseo/utils/NumberParser.h>
+#include <teseo/utils/SentenceTable.h>
+
+using namespace stm;
+using namespace stm::decoder;
+using namespace stm::model;
+
+namespace {
+
+struct Satellites {
+	uint8_t count;
+	std::array<int16_t, 4> prn;
+	std::array<float, 4> snr;
+};
+
+using Cache = SentenceCache<Satellites, 8>;
+
+ByteVectorPtr sentence(const std::string & str)
+{
+	return std::make_shared<ByteVector>(str.begin(), str.end());
+}
+
+uint64_t keyOf(const NmeaMessage & msg)
+{
+	return utils::sentenceKey(utils::SentenceFamily::STANDARD, msg.sentenceId.data(), msg.sentenceId.size());
+}
+
+Satellites parse(const NmeaMessage & msg)
+{
+	Satellites s = {0, {}, {}};
+
+	for(std::size_t i = 3; i + 3 < msg.parameters.size() && s.count < s.prn.size(); i += 4)
+	{
+		s.prn[s.count] = utils::byteVectorParse<int16_t>(msg.parameters[i]).value_or(0);
+		s.snr[s.count] = utils::byteVectorParse<float>(msg.parameters[i + 3]).value_or(0.);
+		s.count++;
+	}
+
+	return s;
+}
+
+} // namespace
+
+TEST_CASE( "Sentence cache returns the value of identical sentences", "[protocol][SentenceCache]" ) {
+
+	Cache cache;
+
+	NmeaMessage gsv(sentence("$GPGSV,3,1,11,03,03,111,,04,15,270,00*7F"));
+
+	REQUIRE(cache.find(keyOf(gsv), gsv.raw(), gsv.crc) == nullptr);
+
+	cache.store(keyOf(gsv), gsv.raw(), gsv.crc, parse(gsv));
+
+	// Same bytes, from another buffer
+	NmeaMessage again(sentence("$GPGSV,3,1,11,03,03,111,,04,15,270,00*7F"));
+	const Satellites * s = cache.find(keyOf(again), again.raw(), again.crc);
+
+	REQUIRE(s != nullptr);
+	REQUIRE(s->count == 2);
+	REQUIRE(s->prn[0] == 3);
+	REQUIRE(s->prn[1] == 4);
+
+	// Same checksum and length but different bytes
+	NmeaMessage swapped(sentence("$GPGSV,3,1,11,04,03,111,,03,15,270,00*7F"));
+	REQUIRE(swapped.crc == gsv.crc);
+	REQUIRE(cache.find(keyOf(swapped), swapped.raw(), swapped.crc) == nullptr);
+
+	const SentenceCacheStats & stats = cache.stats();
+	REQUIRE(stats.lookups == 3);
+	REQUIRE(stats.hits == 1);
+	REQUIRE(stats.savedBytes == gsv.raw().size());
+	REQUIRE(stats.hitRate() == Approx(1. / 3.));
+
+	cache.clear();
+	REQUIRE(cache.find(keyOf(gsv), gsv.raw(), gsv.crc) == nullptr);
+}
+
+TEST_CASE( "Sentence cache keeps the sentences of an epoch", "[protocol][SentenceCache]" ) {
+
+	SentenceCache<Satellites, 64> cache;
+
+	// Same talker, sentence ID and checksum, only the length and bytes differ
+	std::vector<NmeaMessage> epoch;
+	epoch.emplace_back(sentence("$GPGSV,3,1,11,03,03,111,,04,15,270,00*7F"));
+	epoch.emplace_back(sentence("$GPGSV,3,2,11,06,01,010,00,13,06,292,00,14,25,170,00*7F"));
+	epoch.emplace_back(sentence("$GPGSV,3,3,11,16,57,208,39*7F"));
+
+	for(const auto & msg : epoch)
+		cache.store(keyOf(msg), msg.raw(), msg.crc, parse(msg));
+
+	for(const auto & msg : epoch)
+	{
+		const Satellites * s = cache.find(keyOf(msg), msg.raw(), msg.crc);
+		REQUIRE(s != nullptr);
+		REQUIRE(s->count == parse(msg).count);
+	}
+}
+
+TEST_CASE( "Sentence cache ignores long sentences", "[protocol][SentenceCache]" ) {
+
+	Cache cache;
+
+	std::string body = "$GPGSV,3,1,11";
+	while(body.size() <= Cache::MAX_SENTENCE_SIZE)
+		body += ",03,03,111,";
+	body += "*00";
+
+	NmeaMessage msg(sentence(body));
+
+	cache.store(keyOf(msg), msg.raw(), msg.crc, parse(msg));
+	REQUIRE(cache.find(keyOf(msg), msg.raw(), msg.crc) == nullptr);
+	REQUIRE(cache.stats().hits == 0);
+}
+
+TEST_CASE( "Sentence cache benchmark", "[.][benchmark][protocol][SentenceCache]" ) {
+
+	// Satellite sentences of a stationary receiver, repeated every epoch
+	const std::vector<std::string> epoch = {
+		"$GPGSV,3,1,11,03,03,111,,04,15,270,00*7F",
+		"$GPGSV,3,2,11,06,01,010,00,13,06,292,00*74",
+		"$GPGSV,3,3,11,14,25,170,00,16,57,208,39*76",
+		"$GLGSV,2,1,07,65,21,064,30,66,67,012,37,67,41,282,35,72,39,121,28*66",
+		"$GLGSV,2,2,07,73,05,028,,74,06,328,,88,50,063,25*5E",
+		"$GAGSV,1,1,04,02,54,111,36,11,40,307,33,12,16,263,27,25,30,054,33*7C"
+	};
+
+	std::vector<ByteVectorPtr> sentences;
+	for(const auto & s : epoch)
+		sentences.push_back(sentence(s));
+
+	constexpr int iterations = 20000;
+	volatile int sink = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < iterations; i++)
+	{
+		for(const auto & bytes : sentences)
+		{
+			NmeaMessage msg(bytes);
+			sink = sink + parse(msg).count;
+		}
+	}
+
+	auto parseDuration = std::chrono::steady_clock::now() - start;
+
+	SentenceCache<Satellites, 64> cache;
+	start = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < iterations; i++)
+	{
+		for(const auto & bytes : sentences)
+		{
+			NmeaMessage msg(bytes);
+			const uint64_t key = keyOf(msg) ^ (static_cast<uint64_t>(msg.talkerId) << 32);
+
+			if(const Satellites * s = cache.find(key, msg.raw(), msg.crc))
+			{
+				sink = sink + s->count;
+			}
+			else
+			{
+				Satellites parsed = parse(msg);
+				cache.store(key, msg.raw(), msg.crc, parsed);
+				sink = sink + parsed.count;
+			}
+		}
+	}
+
+	auto cacheDuration = std::chrono::steady_clock::now() - start;
+
+	const double count = static_cast<double>(iterations) * sentences.size();
+	const double parseNs = std::chrono::duration<double, std::nano>(parseDuration).count() / count;
+	const double cacheNs = std::chrono::duration<double, std::nano>(cacheDuration).count() / count;
+
+	WARN("Parse:  " << parseNs << " ns/sentence");
+	WARN("Cached: " << cacheNs << " ns/sentence, hit rate " << cache.stats().hitRate());
+
+	CHECK(cacheNs <= parseNs);
+}
@@ -0,0 +1,237 @@
+/*
+* This file is part of Teseo Android HAL
+*
+* Copyright (c) 2016-2018, STMicroelectronics - All Rights Reserved
+* Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+*
+* License terms: Apache 2.0.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+#include <catch.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <teseo/utils/IByteStream.h>
+#include <teseo/utils/UartByteStream.h>
+
+using namespace stm;
+using namespace stm::stream;
+
+namespace {
+
+ByteVectorPtr message(const std::string & str)
+{
+	return std::make_shared<ByteVector>(str.begin(), str.end());
+}
+
+/**
+ * Byte stream recording the writes, reads block until wakeup
+ */
+class FakeByteStream : public AbstractByteStream {
+private:
+	std::string streamName;
+	ByteStreamStatus streamStatus;
+	unsigned int speed;
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool awake;
+
+protected:
+	void open()
+	{
+		std::this_thread::sleep_for(openDelay);
+		streamStatus = ByteStreamStatus::OPENED;
+	}
+
+	void close() { streamStatus = ByteStreamStatus::CLOSED; }
+
+	void flush() { }
+
+	ByteView perform_read()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this] { return awake; });
+		awake = false;
+		return ByteView();
+	}
+
+	void perform_write(const std::vector<ByteVectorPtr> & messages)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		for(const auto & m : messages)
+			writes.push_back({std::chrono::steady_clock::now(), utils::bytesToString(*m)});
+		cond.notify_all();
+	}
+
+	void wakeup() noexcept
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		awake = true;
+		cond.notify_all();
+	}
+
+public:
+	struct Write {
+		std::chrono::steady_clock::time_point when;
+		std::string bytes;
+	};
+
+	std::vector<Write> writes;
+
+	std::chrono::milliseconds openDelay;
+
+	explicit FakeByteStream(unsigned int speed) :
+		streamName("fake"),
+		streamStatus(ByteStreamStatus::CLOSED),
+		speed(speed),
+		awake(false),
+		openDelay(0)
+	{ }
+
+	~FakeByteStream()
+	{
+		stop();
+		join();
+	}
+
+	const std::string & name() const { return streamName; }
+
+	ByteStreamStatus status() const { return streamStatus; }
+
+	unsigned int baudrate() const { return speed; }
+
+	void waitWrites(std::size_t count)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait_for(lock, std::chrono::seconds(2), [this, count] { return writes.size() >= count; });
+	}
+};
+
+} // namespace
+
+TEST_CASE( "ByteStreamWriter sorts messages in lanes", "[utils][ByteStream]" ) {
+
+	REQUIRE(ByteStreamWriter::laneOf(*message("$PSTMEPHEM,1,64,0102*00\r\n")) == WriteLane::BULK);
+	REQUIRE(ByteStreamWriter::laneOf(*message("$PSTMALMANAC,1,64,0102*00\r\n")) == WriteLane::BULK);
+	REQUIRE(ByteStreamWriter::laneOf(*message("$PSTMSTAGPSSATSEED,1,2,3,4,5,6,7*00\r\n")) == WriteLane::BULK);
+	REQUIRE(ByteStreamWriter::laneOf(*message("PSTMEPHEM,1,64,0102")) == WriteLane::BULK);
+
+	REQUIRE(ByteStreamWriter::laneOf(*message("$PSTMCOLD*00\r\n")) == WriteLane::CONTROL);
+	REQUIRE(ByteStreamWriter::laneOf(*message("$PSTMSRR*00\r\n")) == WriteLane::CONTROL);
+	REQUIRE(ByteStreamWriter::laneOf(*message("$PSTMEPHEMX,1*00\r\n")) == WriteLane::CONTROL);
+	REQUIRE(ByteStreamWriter::laneOf(*message("$PSTMEPHEM")) == WriteLane::CONTROL);
+	REQUIRE(ByteStreamWriter::laneOf(ByteVector()) == WriteLane::CONTROL);
+}
+
+TEST_CASE( "ByteStreamWriter paces bulk messages and lets control messages through", "[utils][ByteStream]" ) {
+
+	Thread::setCreateThreadCb(Thread::createPthread);
+
+	// 96 bytes at 9600 bauds take 100 ms on the wire
+	std::string ephemeris = "$PSTMEPHEM,1,64," + std::string(75, '0') + "*00\r\n";
+	REQUIRE(ephemeris.size() == 96);
+
+	FakeByteStream bs(9600);
+
+	bs.write(message(ephemeris));
+	bs.write(message(ephemeris));
+	bs.write(message(ephemeris));
+	bs.write(message("$PSTMSRR*00\r\n"));
+
+	bs.start();
+	bs.waitWrites(4);
+	bs.stop();
+	bs.join();
+
+	REQUIRE(bs.writes.size() == 4);
+
+	// Control message goes first, then one bulk message per line slot
+	REQUIRE(bs.writes[0].bytes == "$PSTMSRR*00\r\n");
+	REQUIRE(bs.writes[1].bytes == ephemeris);
+
+	auto gap1 = bs.writes[2].when - bs.writes[1].when;
+	auto gap2 = bs.writes[3].when - bs.writes[2].when;
+
+	REQUIRE(gap1 >= std::chrono::milliseconds(90));
+	REQUIRE(gap2 >= std::chrono::milliseconds(90));
+}
+
+TEST_CASE( "ByteStreamReader stops when asked to while the stream opens", "[utils][ByteStream]" ) {
+
+	Thread::setCreateThreadCb(Thread::createPthread);
+
+	FakeByteStream bs(9600);
+	bs.openDelay = std::chrono::milliseconds(50);
+
+	bs.start();
+	bs.stop();
+
+	// Past the open, the reader must not wait for a second wakeup
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	for(int i = 0; i < 100 && bs.isRunning(); i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	CHECK_FALSE(bs.isRunning());
+}
+
+TEST_CASE( "UartByteStream changes its speed at runtime", "[utils][ByteStream]" ) {
+
+	Thread::setCreateThreadCb(Thread::createPthread);
+
+	int master, slave;
+	char name[256];
+	REQUIRE(openpty(&master, &slave, name, nullptr, nullptr) == 0);
+
+	UartByteStream uart(name, 115200);
+
+	// Closed stream: the speed is applied at next open
+	REQUIRE(uart.setBaudrate(9600));
+	REQUIRE(uart.baudrate() == 9600);
+	REQUIRE_FALSE(uart.setBaudrate(12345));
+
+	uart.start();
+	for(int i = 0; i < 100 && uart.status() != ByteStreamStatus::OPENED; i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	REQUIRE(uart.status() == ByteStreamStatus::OPENED);
+
+	struct termios attr;
+	REQUIRE(tcgetattr(slave, &attr) == 0);
+	REQUIRE(cfgetospeed(&attr) == B9600);
+
+	REQUIRE(uart.setBaudrate(460800));
+	REQUIRE(uart.baudrate() == 460800);
+	REQUIRE(tcgetattr(slave, &attr) == 0);
+	REQUIRE(cfgetospeed(&attr) == B460800);
+	REQUIRE(cfgetispeed(&attr) == B460800);
+
+	REQUIRE_FALSE(uart.setBaudrate(12345));
+	REQUIRE(uart.baudrate() == 460800);
+
+	uart.stop();
+	uart.join();
+
+	::close(master);
+	::close(slave);
+}
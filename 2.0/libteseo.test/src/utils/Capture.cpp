@@ -0,0 +1,184 @@
+/*
+* This file is part of Teseo Android HAL
+*
+* Copyright (c) 2016-2018, STMicroelectronics - All Rights Reserved
+* Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+*
+* License terms: Apache 2.0.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+#include <catch.hpp>
+#include <TestHelpers.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <teseo/utils/Capture.h>
+
+using namespace stm;
+using namespace stm::stream;
+using namespace stm::test;
+
+namespace {
+
+std::string captureFile()
+{
+	capture::FileHeader header = {};
+	std::copy(std::begin(capture::MAGIC), std::end(capture::MAGIC), header.magic);
+	header.version = capture::VERSION;
+	header.headerSize = sizeof(header);
+
+	std::string out(reinterpret_cast<const char *>(&header), sizeof(header));
+	appendRecord(out, 1000000000, capture::Direction::RX, "$GPGGA,1*00\r\n$GP");
+	appendRecord(out, 1010000000, capture::Direction::TX, "$PSTMCOLD*00\r\n");
+	appendRecord(out, 1050000000, capture::Direction::RX, "RMC,2*00\r\n");
+	appendRecord(out, 1100000000, capture::Direction::RX, "$GPVTG,3*00\r\n");
+	return out;
+}
+
+} // namespace
+
+TEST_CASE( "CaptureReader reads capture records", "[utils][Capture]" ) {
+
+	std::string path = tmpPath("teseo-capture-reader.cap");
+	writeFile(path, captureFile());
+
+	capture::CaptureReader reader;
+	REQUIRE(reader.open(path, 115200));
+
+	capture::Record record;
+	REQUIRE(reader.next(record));
+	REQUIRE(record.direction == capture::Direction::RX);
+	REQUIRE(record.timestamp == std::chrono::seconds(1));
+	REQUIRE(record.bytes.size() == 16);
+
+	REQUIRE(reader.next(record));
+	REQUIRE(record.direction == capture::Direction::TX);
+
+	REQUIRE(reader.next(record));
+	REQUIRE(reader.next(record));
+	REQUIRE(!reader.next(record));
+
+	reader.rewind();
+	REQUIRE(reader.next(record));
+	REQUIRE(record.timestamp == std::chrono::seconds(1));
+
+	remove(path.c_str());
+}
+
+TEST_CASE( "CaptureReader reads raw NMEA logs line by line", "[utils][Capture]" ) {
+
+	std::string path = tmpPath("teseo-capture-raw.nmea");
+	writeFile(path, "$GPGGA,1*00\r\n$GPRMC,2*00\r\n$GPVTG");
+
+	capture::CaptureReader reader;
+	REQUIRE(reader.open(path, 9600));
+
+	capture::Record record;
+	REQUIRE(reader.next(record));
+	REQUIRE(record.bytes.size() == 13);
+	REQUIRE(record.timestamp.count() == 0);
+
+	// 13 bytes at 9600 bauds
+	REQUIRE(reader.next(record));
+	REQUIRE(record.timestamp == std::chrono::nanoseconds(13 * 10 * 1000000000LL / 9600));
+
+	REQUIRE(reader.next(record));
+	REQUIRE(record.bytes.size() == 6);
+	REQUIRE(!reader.next(record));
+
+	remove(path.c_str());
+}
+
+TEST_CASE( "CaptureRecorder output is read back in order", "[utils][Capture]" ) {
+
+	std::string path = tmpPath("teseo-capture-recorder.cap");
+
+	capture::CaptureRecorder recorder;
+	REQUIRE(recorder.open(path, 8192));
+
+	ByteVector rx = {'$', 'G', 'P', 'G', 'G', 'A'};
+	ByteVector tx = {'$', 'P', 'S', 'T', 'M', 'S', 'R', 'R'};
+
+	recorder.append(std::chrono::nanoseconds(10), capture::Direction::RX, rx);
+	recorder.append(std::chrono::nanoseconds(20), capture::Direction::TX, tx);
+	recorder.append(capture::Direction::RX, rx);
+	recorder.close();
+
+	capture::CaptureReader reader;
+	REQUIRE(reader.open(path, 115200));
+
+	capture::Record record;
+	REQUIRE(reader.next(record));
+	REQUIRE(record.timestamp.count() == 10);
+	REQUIRE(record.direction == capture::Direction::RX);
+	REQUIRE(record.bytes == ByteView(rx));
+
+	REQUIRE(reader.next(record));
+	REQUIRE(record.timestamp.count() == 20);
+	REQUIRE(record.direction == capture::Direction::TX);
+	REQUIRE(record.bytes == ByteView(tx));
+
+	REQUIRE(reader.next(record));
+	REQUIRE(record.timestamp.count() > 20);
+
+	REQUIRE(!reader.next(record));
+
+	remove(path.c_str());
+}
+
+TEST_CASE( "CaptureRecorder overwrites the oldest records when full", "[utils][Capture]" ) {
+
+	std::string path = tmpPath("teseo-capture-rolling.cap");
+	const std::size_t fileSize = capture::CaptureRecorder::MIN_SIZE;
+
+	capture::CaptureRecorder recorder;
+	REQUIRE(recorder.open(path, fileSize));
+
+	// 100 records of 16 + 84 bytes, about 2.5 laps of the data area
+	ByteVector payload(84, 'x');
+	for(int i = 0; i < 100; i++)
+	{
+		payload[0] = static_cast<uint8_t>(i);
+		recorder.append(std::chrono::nanoseconds(i), capture::Direction::RX, payload);
+	}
+
+	// Too large to ever fit
+	recorder.append(std::chrono::nanoseconds(100), capture::Direction::RX, ByteVector(fileSize, 'y'));
+	recorder.close();
+
+	capture::CaptureReader reader;
+	REQUIRE(reader.open(path, 115200));
+
+	capture::Record record;
+	std::vector<int> indexes;
+	while(reader.next(record))
+	{
+		REQUIRE(record.bytes.size() == 84);
+		REQUIRE(record.timestamp.count() == record.bytes[0]);
+		indexes.push_back(record.bytes[0]);
+	}
+
+	// The newest records are kept, consecutive and in order
+	REQUIRE(indexes.size() >= 35);
+	REQUIRE(indexes.back() == 99);
+	for(std::size_t i = 1; i < indexes.size(); i++)
+		REQUIRE(indexes[i] == indexes[i - 1] + 1);
+
+	remove(path.c_str());
+}
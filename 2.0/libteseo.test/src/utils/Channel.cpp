@@ -21,6 +21,15 @@
 */
 #include <catch.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
 #include <teseo/utils/Channel.h>
 
 using namespace stm;
@@ -77,4 +86,313 @@ TEST_CASE( "Channel is receiving and sending in the right order", "[thread][Chan
 		com >> output;
 
 		REQUIRE(output == 1.23456);
-}
\ No newline at end of file
+}
+TEST_CASE( "Channel receives all pending data at once", "[thread][Channel]" ) {
+
+	Channel<int> com("unit-test-com");
+
+	for(int i = 0; i < 10; i++)
+		com << i;
+
+	std::vector<int> output;
+
+	REQUIRE(com.receiveMany(output, 4) == 4);
+	REQUIRE(output == std::vector<int>({0, 1, 2, 3}));
+	REQUIRE(com.size() == 6);
+
+	REQUIRE(com.receiveMany(output) == 6);
+	REQUIRE(output.size() == 10);
+	REQUIRE(output.back() == 9);
+	REQUIRE(com.size() == 0);
+}
+
+TEST_CASE( "Channel timed receive returns on timeout", "[thread][Channel]" ) {
+
+	Channel<int> com("unit-test-com");
+	std::vector<int> output;
+
+	REQUIRE(com.receiveMany(output, std::chrono::milliseconds(10)) == 0);
+	REQUIRE(com.receiveMany(output, std::chrono::milliseconds(0)) == 0);
+
+	com << 1;
+	com << 2;
+
+	REQUIRE(com.receiveMany(output, std::chrono::milliseconds(10)) == 2);
+	REQUIRE(output == std::vector<int>({1, 2}));
+}
+
+TEST_CASE( "Channel timed receive of a single element", "[thread][Channel]" ) {
+
+	Channel<int> com("unit-test-com");
+	int output = -1;
+
+	REQUIRE_FALSE(com.receive(output, std::chrono::milliseconds(10)));
+	REQUIRE_FALSE(com.tryReceive(output));
+
+	com << 7;
+
+	REQUIRE(com.receive(output, std::chrono::milliseconds(0)));
+	REQUIRE(output == 7);
+
+	std::thread sender([&com] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		com << 8;
+	});
+
+	REQUIRE(com.receive(output, std::chrono::seconds(5)));
+	REQUIRE(output == 8);
+
+	sender.join();
+}
+
+TEST_CASE( "Channel capacity is bounded", "[thread][Channel]" ) {
+
+	Channel<int> com("unit-test-com", 6);
+
+	REQUIRE(com.capacity() == 8);
+
+	for(int i = 0; i < 8; i++)
+		REQUIRE(com.trySend(i));
+
+	REQUIRE_FALSE(com.trySend(8));
+	REQUIRE(com.size() == 8);
+
+	std::vector<int> output;
+
+	REQUIRE(com.receiveMany(output, 3) == 3);
+	REQUIRE(com.trySend(8));
+	REQUIRE(com.receiveMany(output) == 6);
+	REQUIRE(output == std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8}));
+}
+
+TEST_CASE( "Channel full policies", "[thread][Channel]" ) {
+
+	std::vector<int> output;
+
+	SECTION( "Drop newest" ) {
+		Channel<int> com("unit-test-com", 4, FullPolicy::DROP_NEWEST);
+
+		for(int i = 0; i < 6; i++)
+			REQUIRE(com.send(i) == (i < 4));
+
+		REQUIRE(com.droppedCount() == 2);
+		REQUIRE(com.receiveMany(output) == 4);
+		REQUIRE(output == std::vector<int>({0, 1, 2, 3}));
+	}
+
+	SECTION( "Drop oldest" ) {
+		Channel<int> com("unit-test-com", 4, FullPolicy::DROP_OLDEST);
+
+		for(int i = 0; i < 6; i++)
+			REQUIRE(com.send(i));
+
+		REQUIRE(com.droppedCount() == 2);
+		REQUIRE(com.receiveMany(output) == 4);
+		REQUIRE(output == std::vector<int>({2, 3, 4, 5}));
+	}
+
+	SECTION( "Block" ) {
+		Channel<int> com("unit-test-com", 4, FullPolicy::BLOCK);
+
+		for(int i = 0; i < 4; i++)
+			com << i;
+
+		std::atomic<bool> sent(false);
+
+		std::thread sender([&com, &sent] {
+			com << 4;
+			sent = true;
+		});
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		REQUIRE_FALSE(sent);
+
+		REQUIRE(com.receive() == 0);
+		sender.join();
+
+		REQUIRE(sent);
+		REQUIRE(com.droppedCount() == 0);
+		REQUIRE(com.receiveMany(output) == 4);
+		REQUIRE(output == std::vector<int>({1, 2, 3, 4}));
+	}
+}
+
+TEST_CASE( "Channel close wakes up receivers", "[thread][Channel]" ) {
+
+	Channel<int> com("unit-test-com");
+	std::vector<int> output;
+
+	com << 1;
+	com << 2;
+
+	std::thread receiver([&com, &output] {
+		while(com.receiveMany(output) != 0);
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	com.close();
+	receiver.join();
+
+	REQUIRE(com.isClosed());
+	REQUIRE(output == std::vector<int>({1, 2}));
+
+	REQUIRE_FALSE(com.send(3));
+	REQUIRE_FALSE(com.trySend(3));
+	REQUIRE(com.size() == 0);
+
+	int value = -1;
+	REQUIRE_FALSE(com.receive(value));
+	REQUIRE(com.receive() == 0);
+}
+
+TEST_CASE( "Channel keeps the order of each sender", "[thread][Channel]" ) {
+
+	constexpr int senders = 4;
+	constexpr int count = 20000;
+
+	Channel<int> com("unit-test-com", 64);
+	std::vector<std::thread> threads;
+
+	for(int s = 0; s < senders; s++)
+	{
+		threads.emplace_back([&com, s] {
+			for(int i = 0; i < count; i++)
+				com << (s * count + i);
+		});
+	}
+
+	std::vector<int> last(senders, -1);
+	std::vector<int> output;
+	int received = 0;
+	bool ordered = true;
+
+	while(received < senders * count)
+	{
+		output.clear();
+		received += com.receiveMany(output, 32);
+
+		for(int value : output)
+		{
+			int & previous = last[value / count];
+			ordered = ordered && value > previous;
+			previous = value;
+		}
+	}
+
+	for(auto & t : threads)
+		t.join();
+
+	REQUIRE(ordered);
+	REQUIRE(com.size() == 0);
+
+	for(int s = 0; s < senders; s++)
+		REQUIRE(last[s] == (s + 1) * count - 1);
+}
+
+/**
+ * Previous channel implementation: list backed queue, guarded by a mutex
+ */
+template<typename T>
+class ListChannel {
+private:
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::queue<T, std::list<T>> queue;
+
+public:
+	void send(const T & data)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			queue.push(data);
+		}
+
+		cond.notify_one();
+	}
+
+	T receive()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this] { return !this->queue.empty(); });
+
+		T data = queue.front();
+		queue.pop();
+		return data;
+	}
+
+	std::size_t receiveMany(std::vector<T> & out, std::size_t max)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this] { return !this->queue.empty(); });
+
+		std::size_t count = 0;
+
+		for(; count < max && !queue.empty(); count++)
+		{
+			out.push_back(queue.front());
+			queue.pop();
+		}
+
+		return count;
+	}
+};
+
+template<typename Com>
+static double channelThroughput(Com & com, int senders, bool batch)
+{
+	constexpr int count = 200000;
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+
+	for(int s = 0; s < senders; s++)
+	{
+		threads.emplace_back([&com] {
+			for(int i = 0; i < count; i++)
+				com.send(i);
+		});
+	}
+
+	std::vector<int> output;
+	output.reserve(64);
+	long received = 0;
+
+	while(received < static_cast<long>(senders) * count)
+	{
+		if(batch)
+		{
+			output.clear();
+			received += com.receiveMany(output, 64);
+		}
+		else
+		{
+			com.receive();
+			received++;
+		}
+	}
+
+	for(auto & t : threads)
+		t.join();
+
+	auto duration = std::chrono::steady_clock::now() - start;
+
+	return std::chrono::duration<double, std::nano>(duration).count() / received;
+}
+
+TEST_CASE( "Channel throughput benchmark", "[.][benchmark][thread][Channel]" ) {
+
+	for(int senders : {1, 4})
+	{
+		for(bool batch : {false, true})
+		{
+			ListChannel<int> list;
+			Channel<int> ring("benchmark");
+
+			const double listNs = channelThroughput(list, senders, batch);
+			const double ringNs = channelThroughput(ring, senders, batch);
+
+			WARN(senders << " sender(s), " << (batch ? "receiveMany" : "receive") << ": "
+				<< "list queue " << listNs << " ns/element, ring buffer " << ringNs << " ns/element");
+		}
+	}
+}
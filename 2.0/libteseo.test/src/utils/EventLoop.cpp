@@ -0,0 +1,275 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <teseo/utils/EventLoop.h>
+#include <teseo/utils/Executor.h>
+#include <teseo/utils/Signal.h>
+#include <teseo/utils/Thread.h>
+
+using namespace stm;
+using namespace stm::thread;
+
+namespace {
+
+template<typename Predicate>
+bool waitFor(Predicate predicate)
+{
+	for(int i = 0; i < 2000 && !predicate(); i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	return predicate();
+}
+
+void startLoop(EventLoop & loop)
+{
+	Thread::setCreateThreadCb(Thread::createPthread);
+	loop.start();
+	waitFor([&loop] { return loop.isActive(); });
+}
+
+} // namespace
+
+TEST_CASE( "Event loop runs posted tasks in order on its thread", "[utils][EventLoop]" ) {
+
+	EventLoop loop("test-loop", 1);
+
+	REQUIRE_FALSE(loop.post([] { }));
+
+	startLoop(loop);
+	REQUIRE(loop.isActive());
+
+	std::vector<int> values;
+	std::set<std::thread::id> threads;
+	std::atomic<bool> onLoop(true);
+
+	for(int i = 0; i < 100; i++)
+	{
+		REQUIRE(loop.post([&, i] {
+			values.push_back(i);
+			threads.insert(std::this_thread::get_id());
+			onLoop = onLoop && loop.isLoopThread();
+		}));
+	}
+
+	REQUIRE_FALSE(loop.isLoopThread());
+
+	loop.stop();
+	loop.join();
+
+	// Pending tasks run before the loop stops, later ones are dropped
+	REQUIRE(values.size() == 100);
+
+	for(int i = 0; i < 100; i++)
+		REQUIRE(values[i] == i);
+
+	REQUIRE(threads.size() == 1);
+	REQUIRE(threads.count(std::this_thread::get_id()) == 0);
+	REQUIRE(onLoop);
+	REQUIRE_FALSE(loop.post([] { }));
+	REQUIRE(loop.stats().tasks.count == 100);
+}
+
+TEST_CASE( "Event loop runs jobs on its workers", "[utils][EventLoop]" ) {
+
+	EventLoop loop("test-loop", 2);
+	startLoop(loop);
+
+	std::mutex mutex;
+	std::set<std::thread::id> threads;
+	std::atomic<int> concurrent(0);
+	std::atomic<int> maxConcurrent(0);
+	std::atomic<int> done(0);
+
+	for(int i = 0; i < 8; i++)
+	{
+		REQUIRE(loop.submit([&] {
+			int now = ++concurrent;
+			int seen = maxConcurrent;
+
+			while(now > seen && !maxConcurrent.compare_exchange_weak(seen, now));
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			concurrent--;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			threads.insert(std::this_thread::get_id());
+			done++;
+		}));
+	}
+
+	loop.stop();
+	loop.join();
+
+	REQUIRE(done == 8);
+	REQUIRE(threads.size() <= 2);
+	REQUIRE(maxConcurrent <= 2);
+	REQUIRE(loop.stats().jobs.count == 8);
+
+	// The loop can be started again
+	startLoop(loop);
+	REQUIRE(loop.submit([&done] { done++; }));
+	loop.stop();
+	loop.join();
+
+	REQUIRE(done == 9);
+}
+
+TEST_CASE( "Event loop timers", "[utils][EventLoop]" ) {
+
+	EventLoop loop("test-loop", 1);
+	startLoop(loop);
+
+	std::atomic<int> once(0);
+	std::atomic<int> periodic(0);
+	std::atomic<int> cancelled(0);
+
+	REQUIRE(loop.addTimer(std::chrono::milliseconds(0), std::chrono::milliseconds(0),
+		[&once] { once++; }) != -1);
+
+	EventLoop::TimerId timer = loop.addTimer(std::chrono::milliseconds(1), std::chrono::milliseconds(2),
+		[&periodic] { periodic++; });
+
+	EventLoop::TimerId late = loop.addTimer(std::chrono::seconds(10), std::chrono::milliseconds(0),
+		[&cancelled] { cancelled++; });
+
+	REQUIRE(timer != -1);
+	REQUIRE(late != -1);
+
+	REQUIRE(waitFor([&] { return once == 1 && periodic >= 3; }));
+
+	loop.cancelTimer(timer);
+	loop.cancelTimer(late);
+
+	int count = periodic;
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	REQUIRE(periodic == count);
+	REQUIRE(once == 1);
+	REQUIRE(cancelled == 0);
+
+	loop.stop();
+	loop.join();
+
+	REQUIRE(loop.stats().timers.count >= 4);
+}
+
+TEST_CASE( "Event loop watches file descriptors", "[utils][EventLoop]" ) {
+
+	EventLoop loop("test-loop", 1);
+	startLoop(loop);
+
+	int fds[2];
+	REQUIRE(pipe(fds) == 0);
+
+	std::vector<char> received;
+	std::atomic<int> calls(0);
+
+	REQUIRE(loop.watch(fds[0], EPOLLIN, [&](uint32_t events) {
+		char c;
+
+		if((events & EPOLLIN) && read(fds[0], &c, 1) == 1)
+			received.push_back(c);
+
+		calls++;
+	}));
+
+	REQUIRE_FALSE(loop.watch(fds[0], EPOLLIN, [](uint32_t) { }));
+
+	REQUIRE(write(fds[1], "ab", 2) == 2);
+	REQUIRE(waitFor([&calls] { return calls >= 2; }));
+
+	// No callback runs after unwatch
+	loop.unwatch(fds[0]);
+	int count = calls;
+
+	REQUIRE(write(fds[1], "c", 1) == 1);
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	REQUIRE(calls == count);
+
+	loop.stop();
+	loop.join();
+
+	REQUIRE(received == std::vector<char>({'a', 'b'}));
+
+	close(fds[0]);
+	close(fds[1]);
+}
+
+TEST_CASE( "Strand delivers queued slots on the event loop workers", "[utils][EventLoop]" ) {
+
+	EventLoop loop("test-loop", 2);
+	Strand strand("test-strand", loop);
+
+	std::vector<int> values;
+	std::set<std::thread::id> threads;
+	std::atomic<int> concurrent(0);
+	bool overlapped = false;
+
+	Signal<void, int> sig("test");
+	sig.connect(SlotFactory::queued(strand, SlotFactory::create(std::function<void (int)>([&](int v) {
+		overlapped = overlapped || ++concurrent > 1;
+		values.push_back(v);
+		threads.insert(std::this_thread::get_id());
+		concurrent--;
+	})), QueuePolicy::NEVER_DROP, 4));
+
+	// Inactive strand, the calls are delivered by the emitting thread
+	sig.emit(-1);
+
+	REQUIRE(values == std::vector<int>({-1}));
+	REQUIRE(threads.count(std::this_thread::get_id()) == 1);
+
+	startLoop(loop);
+	strand.activate();
+	REQUIRE(strand.isActive());
+
+	values.clear();
+	threads.clear();
+
+	for(int i = 0; i < 200; i++)
+		sig.emit(i);
+
+	strand.deactivate();
+	strand.waitIdle();
+
+	REQUIRE(values.size() == 200);
+
+	for(int i = 0; i < 200; i++)
+		REQUIRE(values[i] == i);
+
+	REQUIRE_FALSE(overlapped);
+	REQUIRE(threads.count(std::this_thread::get_id()) == 0);
+
+	loop.stop();
+	loop.join();
+}
@@ -0,0 +1,341 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <teseo/utils/EventLoop.h>
+#include <teseo/utils/Executor.h>
+#include <teseo/utils/Signal.h>
+#include <teseo/utils/Thread.h>
+
+using namespace stm;
+using namespace stm::thread;
+
+namespace {
+
+/**
+ * Slot recording its calls, blocked while the gate is closed
+ */
+struct Recorder {
+	std::mutex mutex;
+	std::vector<int> values;
+	std::vector<std::thread::id> threads;
+	std::atomic<bool> gateOpen{true};
+	std::atomic<int> entered{0};
+
+	GenericSlot<void (int)>::ptr slot()
+	{
+		return SlotFactory::create(std::function<void (int)>([this](int v) {
+			entered++;
+
+			while(!gateOpen)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+			std::lock_guard<std::mutex> lock(mutex);
+			values.push_back(v);
+			threads.push_back(std::this_thread::get_id());
+		}));
+	}
+
+	void waitEntered(int count)
+	{
+		for(int i = 0; i < 1000 && entered < count; i++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+};
+
+/**
+ * Strand delivering on the single worker of an event loop
+ */
+struct TestStrand {
+	EventLoop loop;
+	Strand strand;
+
+	TestStrand() :
+		loop("test-loop", 1),
+		strand("test-strand", loop)
+	{ }
+
+	~TestStrand()
+	{
+		stop();
+	}
+
+	void start()
+	{
+		Thread::setCreateThreadCb(Thread::createPthread);
+		loop.start();
+
+		// Calls are delivered inline until the loop runs
+		for(int i = 0; i < 1000 && !loop.isActive(); i++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		strand.activate();
+	}
+
+	void stop()
+	{
+		strand.deactivate();
+		strand.waitIdle();
+
+		if(loop.isRunning())
+		{
+			loop.stop();
+			loop.join();
+		}
+	}
+};
+
+} // namespace
+
+TEST_CASE( "Queued slots are called directly when the strand isn't active", "[utils][Executor]" ) {
+
+	TestStrand fixture;
+	Recorder recorder;
+	Signal<void, int> sig("test");
+
+	sig.connect(SlotFactory::queued(fixture.strand, recorder.slot()));
+
+	sig.emit(1);
+	sig.emit(2);
+
+	REQUIRE(recorder.values == std::vector<int>({1, 2}));
+	REQUIRE(recorder.threads[0] == std::this_thread::get_id());
+}
+
+TEST_CASE( "Queued slots accept arguments that can't be assigned", "[utils][Executor]" ) {
+
+	// Like NmeaMessage, copy constructible only
+	struct Fixed {
+		const int value;
+	};
+
+	TestStrand fixture;
+	Signal<void, const Fixed &> sig("test");
+	std::vector<int> received;
+
+	sig.connect(SlotFactory::queued(fixture.strand, SlotFactory::create(
+		std::function<void (const Fixed &)>([&received](const Fixed & f) {
+			received.push_back(f.value);
+		})), QueuePolicy::NEVER_DROP, 2));
+
+	sig.emit(Fixed{1});
+	sig.emit(Fixed{2});
+
+	REQUIRE(received == std::vector<int>({1, 2}));
+}
+
+TEST_CASE( "Queued slots run on the event loop workers", "[utils][Executor]" ) {
+
+	TestStrand fixture;
+	Recorder recorder;
+	Signal<void, const std::string &> sig("test");
+	std::vector<std::string> received;
+
+	sig.connect(SlotFactory::queued(fixture.strand, SlotFactory::create(
+		std::function<void (const std::string &)>([&received](const std::string & s) {
+			received.push_back(s);
+		}))));
+
+	Signal<void, int> numbers("numbers");
+	numbers.connect(SlotFactory::queued(fixture.strand, recorder.slot(), QueuePolicy::NEVER_DROP, 2));
+
+	fixture.start();
+
+	{
+		// The argument is copied, the emitter buffer can be reused
+		std::string value = "first";
+		sig.emit(value);
+		value = "second";
+		sig.emit(value);
+	}
+
+	// Never drop: the emitter waits for room in the queue
+	for(int i = 0; i < 100; i++)
+		numbers.emit(i);
+
+	fixture.stop();
+
+	REQUIRE(received == std::vector<std::string>({"first", "second"}));
+	REQUIRE(recorder.values.size() == 100);
+
+	for(int i = 0; i < 100; i++)
+		REQUIRE(recorder.values[i] == i);
+
+	REQUIRE(recorder.threads[0] != std::this_thread::get_id());
+}
+
+TEST_CASE( "Queued slots keep their order across deactivate()", "[utils][Executor]" ) {
+
+	TestStrand fixture;
+	Recorder blocker;
+	Signal<void, int> block("block");
+	Signal<void, int> location("location");
+	Signal<void, int> status("status");
+	std::mutex mutex;
+	std::vector<int> values;
+	std::vector<std::thread::id> threads;
+
+	auto record = [&](int v) {
+		std::lock_guard<std::mutex> lock(mutex);
+		values.push_back(v);
+		threads.push_back(std::this_thread::get_id());
+	};
+
+	block.connect(SlotFactory::queued(fixture.strand, blocker.slot()));
+	location.connect(SlotFactory::queued(fixture.strand,
+		SlotFactory::create(std::function<void (int)>(record)), QueuePolicy::NEVER_DROP, 8));
+	status.connect(SlotFactory::queued(fixture.strand,
+		SlotFactory::create(std::function<void (int)>(record)), QueuePolicy::NEVER_DROP, 8));
+
+	fixture.start();
+
+	// Keep the worker busy so the locations are still pending on deactivate()
+	blocker.gateOpen = false;
+	block.emit(0);
+	blocker.waitEntered(1);
+
+	for(int i = 0; i < 5; i++)
+		location.emit(i);
+
+	// Like the session end status emitted right after the navigation stop
+	fixture.strand.deactivate();
+	status.emit(100);
+
+	{
+		// Not delivered by the emitting thread, ahead of the pending locations
+		std::lock_guard<std::mutex> lock(mutex);
+		CHECK(values.empty());
+	}
+
+	blocker.gateOpen = true;
+	fixture.strand.waitIdle();
+
+	REQUIRE(values == std::vector<int>({0, 1, 2, 3, 4, 100}));
+
+	for(auto id : threads)
+		REQUIRE(id != std::this_thread::get_id());
+
+	// Nothing pending anymore, the emitting thread delivers the next calls
+	status.emit(101);
+
+	REQUIRE(values.back() == 101);
+	REQUIRE(threads.back() == std::this_thread::get_id());
+}
+
+TEST_CASE( "Queued slots keep delivering after a slot throws", "[utils][Executor]" ) {
+
+	TestStrand fixture;
+	Signal<void, int> sig("test");
+	std::vector<int> values;
+
+	sig.connect(SlotFactory::queued(fixture.strand, SlotFactory::create(
+		std::function<void (int)>([&values](int v) {
+			if(v % 2 == 0)
+				throw std::runtime_error("even value");
+
+			values.push_back(v);
+		})), QueuePolicy::NEVER_DROP, 2));
+
+	fixture.start();
+
+	// The queue holds two calls, the emitter would wait forever if a throwing call left it full
+	for(int i = 0; i < 10; i++)
+	{
+		sig.emit(i);
+		fixture.strand.waitIdle();
+	}
+
+	fixture.stop();
+
+	REQUIRE(values == std::vector<int>({1, 3, 5, 7, 9}));
+}
+
+TEST_CASE( "Queued slots apply their policy when the queue is full", "[utils][Executor]" ) {
+
+	TestStrand fixture;
+	Recorder coalesced, latest;
+	Signal<void, int> sig("test");
+
+	sig.connect(SlotFactory::queued(fixture.strand, coalesced.slot(), QueuePolicy::COALESCE));
+	sig.connect(SlotFactory::queued(fixture.strand, latest.slot(), QueuePolicy::DROP_OLDEST, 3));
+
+	fixture.start();
+
+	// Block the worker in the first call
+	coalesced.gateOpen = false;
+	sig.emit(0);
+	coalesced.waitEntered(1);
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(int i = 1; i <= 10; i++)
+		sig.emit(i);
+
+	// A slow slot doesn't delay the emitter
+	REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100));
+
+	coalesced.gateOpen = true;
+
+	fixture.stop();
+
+	REQUIRE(coalesced.values == std::vector<int>({0, 10}));
+
+	// The second connection was scheduled behind the first, only the last calls are left
+	REQUIRE(latest.values.size() <= 4);
+	REQUIRE(latest.values.back() == 10);
+	REQUIRE(latest.values[latest.values.size() - 2] == 9);
+}
+
+TEST_CASE( "Queued slots expire with their target", "[utils][Executor]" ) {
+
+	class Receiver : public Trackable {
+	public:
+		int calls = 0;
+
+		void onValue(int)
+		{
+			calls++;
+		}
+	};
+
+	TestStrand fixture;
+	Signal<void, int> sig("test");
+	auto receiver = std::make_unique<Receiver>();
+
+	sig.connect(SlotFactory::queued(fixture.strand, SlotFactory::create(*receiver, &Receiver::onValue)));
+
+	sig.emit(1);
+	REQUIRE(receiver->calls == 1);
+
+	receiver.reset();
+	sig.emit(2);
+
+	REQUIRE_FALSE(sig.isConnected());
+}
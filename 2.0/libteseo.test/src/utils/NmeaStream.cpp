@@ -0,0 +1,178 @@
+/*
+* This file is part of Teseo Android HAL
+*
+* Copyright (c) 2016-2018, STMicroelectronics - All Rights Reserved
+* Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+*
+* License terms: Apache 2.0.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+#include <catch.hpp>
+#include <TestHelpers.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <teseo/utils/NmeaStream.h>
+#include <teseo/utils/BufferPool.h>
+
+using namespace stm;
+using namespace stm::stream;
+using namespace stm::test;
+
+namespace {
+
+ByteView view(const std::string & str)
+{
+	return ByteView(reinterpret_cast<const uint8_t *>(str.data()), str.size());
+}
+
+class SentenceRecorder : public Trackable {
+public:
+	std::vector<ByteVectorPtr> buffers;
+	std::vector<std::string> sentences;
+
+	void onSentence(ByteVectorPtr bytes)
+	{
+		buffers.push_back(bytes);
+		sentences.push_back(utils::bytesToString(*bytes));
+	}
+};
+
+} // namespace
+
+TEST_CASE( "NmeaStream frames sentences split across reads", "[utils][NmeaStream]" ) {
+
+	NmeaStream nmea;
+	IStream & stream = nmea;
+	SentenceRecorder rec;
+	stream.newSentence.connect(SlotFactory::create(rec, &SentenceRecorder::onSentence));
+
+	std::string gga = sentenceLine("GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+	std::string rmc = sentenceLine("GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W");
+	std::string all = "garbage" + gga + rmc;
+
+	// Every split position must give the same result
+	for(std::size_t cut = 0; cut <= all.size(); cut++)
+	{
+		rec.sentences.clear();
+		nmea.onNewBytes(view(all.substr(0, cut)));
+		nmea.onNewBytes(view(all.substr(cut)));
+
+		REQUIRE(rec.sentences.size() == 2);
+		REQUIRE(rec.sentences[0] == gga.substr(0, gga.size() - 2));
+		REQUIRE(rec.sentences[1] == rmc.substr(0, rmc.size() - 2));
+	}
+
+	REQUIRE(nmea.stats().checksumErrors == 0);
+	REQUIRE(nmea.stats().malformed == 0);
+}
+
+TEST_CASE( "NmeaStream drops invalid sentences", "[utils][NmeaStream]" ) {
+
+	NmeaStream nmea;
+	IStream & stream = nmea;
+	SentenceRecorder rec;
+	stream.newSentence.connect(SlotFactory::create(rec, &SentenceRecorder::onSentence));
+
+	std::string good = sentenceLine("PSTMVER,GNSSLIB_8.4.18.25_ARM");
+	std::string badChecksum = good;
+	badChecksum[badChecksum.size() - 3] = badChecksum[badChecksum.size() - 3] == '0' ? '1' : '0';
+
+	std::string input =
+		badChecksum +                      // Checksum mismatch
+		"$GPGSA,A,3,04,05\r\n" +           // No checksum
+		"$GPGSV,3,1,11,03,03" + good +     // Truncated by the next sentence
+		"$GPVTG,054.7,T*ZZ\r\n" +          // Invalid checksum digits
+		good;
+
+	nmea.onNewBytes(view(input));
+
+	REQUIRE(rec.sentences.size() == 2);
+	REQUIRE(rec.sentences[0] == good.substr(0, good.size() - 2));
+	REQUIRE(rec.sentences[1] == good.substr(0, good.size() - 2));
+
+	REQUIRE(nmea.stats().sentences == 2);
+	REQUIRE(nmea.stats().checksumErrors == 1);
+	REQUIRE(nmea.stats().malformed == 3);
+}
+
+TEST_CASE( "NmeaStream drops oversized sentences", "[utils][NmeaStream]" ) {
+
+	NmeaStream nmea;
+	IStream & stream = nmea;
+	SentenceRecorder rec;
+	stream.newSentence.connect(SlotFactory::create(rec, &SentenceRecorder::onSentence));
+
+	std::string good = sentenceLine("GPGLL,4916.45,N,12311.12,W,225444,A");
+
+	nmea.onNewBytes(view(sentenceLine("PSTMX," + std::string(NMEA_STREAM_MAX_SENTENCE_SIZE, 'A')) + good));
+
+	REQUIRE(rec.sentences.size() == 1);
+	REQUIRE(rec.sentences[0] == good.substr(0, good.size() - 2));
+	REQUIRE(nmea.stats().malformed == 1);
+}
+
+TEST_CASE( "NmeaStream reuses pooled sentence buffers", "[utils][NmeaStream]" ) {
+
+	NmeaStream nmea;
+	IStream & stream = nmea;
+	SentenceRecorder rec;
+	stream.newSentence.connect(SlotFactory::create(rec, &SentenceRecorder::onSentence));
+
+	std::string gll = sentenceLine("GPGLL,4916.45,N,12311.12,W,225444,A");
+
+	nmea.onNewBytes(view(gll));
+	REQUIRE(rec.buffers.size() == 1);
+	const ByteVector * first = rec.buffers[0].get();
+
+	// Once released, the buffer goes back to the pool and is handed out again
+	std::vector<const ByteVector *> seen;
+	rec.buffers.clear();
+	for(std::size_t i = 0; i < BufferPool::DEFAULT_BUFFERS; i++)
+	{
+		nmea.onNewBytes(view(gll));
+		seen.push_back(rec.buffers.back().get());
+		rec.buffers.clear();
+	}
+
+	REQUIRE(std::find(seen.begin(), seen.end(), first) != seen.end());
+}
+
+TEST_CASE( "BufferPool falls back to the heap when exhausted", "[utils][NmeaStream]" ) {
+
+	BufferPool pool(2, 16);
+
+	ByteVectorPtr a = pool.acquire();
+	ByteVectorPtr b = pool.acquire();
+	REQUIRE(a != b);
+	REQUIRE(a->capacity() >= 16);
+	REQUIRE(pool.missCount() == 0);
+
+	ByteVectorPtr c = pool.acquire();
+	REQUIRE(c != a);
+	REQUIRE(c != b);
+	REQUIRE(pool.missCount() == 1);
+
+	a->push_back('x');
+	const ByteVector * released = a.get();
+	a.reset();
+
+	ByteVectorPtr d = pool.acquire();
+	REQUIRE(d.get() == released);
+	REQUIRE(d->empty());
+}
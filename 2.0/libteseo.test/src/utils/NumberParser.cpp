@@ -0,0 +1,239 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <teseo/utils/ByteVector.h>
+#include <teseo/utils/ByteView.h>
+#include <teseo/utils/NumberParser.h>
+
+using namespace stm;
+using namespace stm::utils;
+
+static ByteView view(const char * str)
+{
+	return ByteView(reinterpret_cast<const uint8_t *>(str), std::strlen(str));
+}
+
+TEST_CASE( "Integer fields are parsed without exception", "[utils][NumberParser]" ) {
+
+	int32_t value = 42;
+
+	CHECK(parseNumber(view("0"), value) == ParseStatus::OK);
+	CHECK(value == 0);
+
+	CHECK(parseNumber(view("0815"), value) == ParseStatus::OK);
+	CHECK(value == 815);
+
+	CHECK(parseNumber(view("-12"), value) == ParseStatus::OK);
+	CHECK(value == -12);
+
+	CHECK(parseNumber(view("2147483647"), value) == ParseStatus::OK);
+	CHECK(value == 2147483647);
+
+	CHECK(parseNumber(view("-2147483648"), value) == ParseStatus::OK);
+	CHECK(value == -2147483647 - 1);
+
+	value = 42;
+	CHECK(parseNumber(view(""), value) == ParseStatus::EMPTY);
+	CHECK(parseNumber(view("-"), value) == ParseStatus::INVALID);
+	CHECK(parseNumber(view("12a"), value) == ParseStatus::INVALID);
+	CHECK(parseNumber(view("1.5"), value) == ParseStatus::INVALID);
+	CHECK(parseNumber(view("A"), value) == ParseStatus::INVALID);
+	CHECK(parseNumber(view("2147483648"), value) == ParseStatus::OVERFLOW);
+	CHECK(value == 42);
+
+	int16_t shortValue = 0;
+	CHECK(parseNumber(view("-32768"), shortValue) == ParseStatus::OK);
+	CHECK(shortValue == -32768);
+	CHECK(parseNumber(view("32768"), shortValue) == ParseStatus::OVERFLOW);
+
+	bool flag = false;
+	CHECK(parseNumber(view("1"), flag) == ParseStatus::OK);
+	CHECK(flag == true);
+	CHECK(parseNumber(view("0"), flag) == ParseStatus::OK);
+	CHECK(flag == false);
+}
+
+TEST_CASE( "Decimal fields are parsed as fixed-point numbers", "[utils][NumberParser]" ) {
+
+	FixedPoint fp;
+
+	REQUIRE(parseNumber(view("-12.340"), fp) == ParseStatus::OK);
+	CHECK(fp.mantissa == -12340);
+	CHECK(fp.scale == 3);
+	CHECK(fp.rescale(1) == -123);
+	CHECK(fp.rescale(5) == -1234000);
+
+	REQUIRE(parseNumber(view("0.05"), fp) == ParseStatus::OK);
+	CHECK(fp.mantissa == 5);
+	CHECK(fp.scale == 2);
+
+	REQUIRE(parseNumber(view("12."), fp) == ParseStatus::OK);
+	CHECK(fp.mantissa == 12);
+	CHECK(fp.scale == 0);
+
+	REQUIRE(parseNumber(view(".5"), fp) == ParseStatus::OK);
+	CHECK(fp.mantissa == 5);
+	CHECK(fp.scale == 1);
+
+	CHECK(parseNumber(view(""), fp) == ParseStatus::EMPTY);
+	CHECK(parseNumber(view("."), fp) == ParseStatus::INVALID);
+	CHECK(parseNumber(view("1.2.3"), fp) == ParseStatus::INVALID);
+	CHECK(parseNumber(view("1e3"), fp) == ParseStatus::INVALID);
+	CHECK(parseNumber(view("1234567890.123456789"), fp) == ParseStatus::OVERFLOW);
+
+	// Parsed doubles are exactly the values given by strtod
+	for(const char * str : { "0.9", "545.4", "-0.001", "123456.789", "7.5", "359.99" })
+	{
+		double value = 0.;
+		REQUIRE(parseNumber(view(str), value) == ParseStatus::OK);
+		CHECK(value == std::strtod(str, nullptr));
+
+		float single = 0.f;
+		REQUIRE(parseNumber(view(str), single) == ParseStatus::OK);
+		CHECK(single == std::strtof(str, nullptr));
+	}
+}
+
+TEST_CASE( "Coordinate fields are parsed to decimal degrees", "[utils][NumberParser]" ) {
+
+	double value = 0.;
+
+	REQUIRE(parseCoordinate(view("4807.038"), view("N"), value) == ParseStatus::OK);
+	CHECK(value == Approx(48. + 7.038 / 60.));
+
+	REQUIRE(parseCoordinate(view("01131.000"), view("E"), value) == ParseStatus::OK);
+	CHECK(value == Approx(11. + 31. / 60.));
+
+	REQUIRE(parseCoordinate(view("4807.038"), view("S"), value) == ParseStatus::OK);
+	CHECK(value == Approx(-(48. + 7.038 / 60.)));
+
+	REQUIRE(parseCoordinate(view("12200.5"), view("W"), value) == ParseStatus::OK);
+	CHECK(value == Approx(-(122. + 0.5 / 60.)));
+
+	REQUIRE(parseCoordinate(view("0030.0"), view("N"), value) == ParseStatus::OK);
+	CHECK(value == Approx(0.5));
+
+	value = 1.;
+	CHECK(parseCoordinate(view(""), view(""), value) == ParseStatus::EMPTY);
+	CHECK(parseCoordinate(view("4807.038"), view(""), value) == ParseStatus::INVALID);
+	CHECK(parseCoordinate(view("4807.038"), view("X"), value) == ParseStatus::INVALID);
+	CHECK(parseCoordinate(view("7.038"), view("N"), value) == ParseStatus::INVALID);
+	CHECK(parseCoordinate(view("4867.038"), view("N"), value) == ParseStatus::INVALID);
+	CHECK(parseCoordinate(view("48a7.038"), view("N"), value) == ParseStatus::INVALID);
+	CHECK(parseCoordinate(view("18107.0"), view("E"), value) == ParseStatus::OVERFLOW);
+	CHECK(value == 1.);
+}
+
+TEST_CASE( "Byte vector parsers give an empty value on invalid fields", "[utils][NumberParser]" ) {
+
+	ByteVector number = { '1', '2', '3' };
+	ByteVector invalid = { 'A' };
+	ByteVector empty;
+
+	CHECK(byteVectorParse<int>(number).value_or(0) == 123);
+	CHECK(byteVectorParse<double>(number.cbegin(), number.cend()).value_or(0.) == 123.);
+	CHECK(static_cast<bool>(byteVectorParse<int>(invalid)) == false);
+	CHECK(static_cast<bool>(byteVectorParse<float>(empty)) == false);
+	CHECK(static_cast<bool>(byteVectorParse<bool>(ByteView(empty))) == false);
+}
+
+/**
+ * Fields of a typical GGA, RMC and GSV epoch
+ */
+static const std::vector<std::string> benchmarkFields = {
+	"4807.038", "01131.000", "1", "08", "0.9", "545.4", "46.9", "022.4", "084.4",
+	"03", "10", "03", "45", "172", "28", "12.5", "359.99", "", "0.05", "-0.001"
+};
+
+static constexpr int BENCHMARK_ITERATIONS = 100000;
+
+template<typename Function>
+static double benchmark(Function f)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < BENCHMARK_ITERATIONS; i++)
+		f();
+
+	auto duration = std::chrono::steady_clock::now() - start;
+
+	return std::chrono::duration<double, std::nano>(duration).count() /
+		(BENCHMARK_ITERATIONS * benchmarkFields.size());
+}
+
+TEST_CASE( "Numeric field parser benchmark", "[.][benchmark][utils][NumberParser]" ) {
+
+	std::vector<ByteVector> fields;
+
+	for(const auto & str : benchmarkFields)
+		fields.emplace_back(str.begin(), str.end());
+
+	volatile double sink = 0.;
+
+	// Parser previously used by ByteVectorParser<double>
+	double stringParser = benchmark([&] () {
+		for(const auto & field : fields)
+		{
+			if(field.empty())
+				continue;
+
+			try
+			{
+				sink = sink + std::stod(std::string(field.begin(), field.end()));
+			}
+			catch(const std::exception &)
+			{ }
+		}
+	});
+
+	double numberParser = benchmark([&] () {
+		for(const auto & field : fields)
+		{
+			double value;
+
+			if(parseNumber(ByteView(field), value) == ParseStatus::OK)
+				sink = sink + value;
+		}
+	});
+
+	double fixedPointParser = benchmark([&] () {
+		for(const auto & field : fields)
+		{
+			FixedPoint value;
+
+			if(parseNumber(ByteView(field), value) == ParseStatus::OK)
+				sink = sink + value.mantissa;
+		}
+	});
+
+	WARN("std::stod:       " << stringParser << " ns/field");
+	WARN("parseDouble:     " << numberParser << " ns/field");
+	WARN("parseFixedPoint: " << fixedPointParser << " ns/field");
+
+	CHECK(numberParser < stringParser);
+}
@@ -0,0 +1,95 @@
+/*
+* This file is part of Teseo Android HAL
+*
+* Copyright (c) 2016-2018, STMicroelectronics - All Rights Reserved
+* Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+*
+* License terms: Apache 2.0.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+#include <catch.hpp>
+
+#include <cstring>
+
+#include <teseo/utils/ReceiveRing.h>
+
+using namespace stm;
+using namespace stm::stream;
+
+TEST_CASE( "ReceiveRing chunk size follows baudrate", "[utils][ReceiveRing]" ) {
+
+	REQUIRE(ReceiveRing::chunkSizeForBaudrate(9600) == ReceiveRing::MIN_CHUNK_SIZE);
+	REQUIRE(ReceiveRing::chunkSizeForBaudrate(115200) == 256);
+	REQUIRE(ReceiveRing::chunkSizeForBaudrate(460800) == 1024);
+	REQUIRE(ReceiveRing::chunkSizeForBaudrate(921600) == 2048);
+	REQUIRE(ReceiveRing::chunkSizeForBaudrate(100000000) == ReceiveRing::MAX_CHUNK_SIZE);
+}
+
+TEST_CASE( "ReceiveRing hands out contiguous views without reallocating", "[utils][ReceiveRing]" ) {
+
+	ReceiveRing ring(16, 4);
+
+	REQUIRE(ring.chunkSize() == 16);
+	REQUIRE(ring.capacity() == 64);
+
+	uint8_t * first = ring.prepare();
+	std::memcpy(first, "$GPGGA", 6);
+	ByteView v1 = ring.commit(6);
+
+	REQUIRE(v1.data() == first);
+	REQUIRE(v1 == ByteView(reinterpret_cast<const uint8_t *>("$GPGGA"), 6));
+
+	// Next read is placed right after the previous one
+	uint8_t * second = ring.prepare();
+	REQUIRE(second == first + 6);
+	std::memcpy(second, ",1", 2);
+	ByteView v2 = ring.commit(2);
+
+	// Previous view is still intact
+	REQUIRE(v1.toVector() == ByteVector({'$', 'G', 'P', 'G', 'G', 'A'}));
+	REQUIRE(v2.size() == 2);
+
+	// Fill the ring until it wraps to the beginning of the storage
+	const uint8_t * storageStart = first;
+	bool wrapped = false;
+	for(int i = 0; i < 8; i++)
+	{
+		uint8_t * p = ring.prepare();
+		REQUIRE(p + ring.chunkSize() <= storageStart + ring.capacity());
+		if(p == storageStart)
+			wrapped = true;
+		ring.commit(ring.chunkSize());
+	}
+
+	REQUIRE(wrapped);
+}
+
+TEST_CASE( "ReceiveRing commit is clamped to chunk size", "[utils][ReceiveRing]" ) {
+
+	ReceiveRing ring(8, 2);
+
+	ring.prepare();
+	REQUIRE(ring.commit(100).size() == 8);
+}
+
+TEST_CASE( "ByteView subview is clamped", "[utils][ByteView]" ) {
+
+	ByteVector bytes = {'G', 'P', 'R', 'M', 'C'};
+	ByteView view(bytes);
+
+	REQUIRE(view.subview(2).toVector() == ByteVector({'R', 'M', 'C'}));
+	REQUIRE(view.subview(3, 10).size() == 2);
+	REQUIRE(view.subview(10).empty());
+}
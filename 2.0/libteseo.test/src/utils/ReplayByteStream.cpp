@@ -0,0 +1,135 @@
+/*
+* This file is part of Teseo Android HAL
+*
+* Copyright (c) 2016-2018, STMicroelectronics - All Rights Reserved
+* Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+*
+* License terms: Apache 2.0.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+#include <catch.hpp>
+#include <TestHelpers.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <teseo/utils/Capture.h>
+#include <teseo/utils/NmeaStream.h>
+#include <teseo/utils/ReplayByteStream.h>
+
+using namespace stm;
+using namespace stm::stream;
+using namespace stm::test;
+
+namespace {
+
+std::string captureFile()
+{
+	capture::FileHeader header = {};
+	std::copy(std::begin(capture::MAGIC), std::end(capture::MAGIC), header.magic);
+	header.version = capture::VERSION;
+	header.headerSize = sizeof(header);
+
+	std::string out(reinterpret_cast<const char *>(&header), sizeof(header));
+	appendRecord(out, 1000000000, capture::Direction::RX, "$GPGGA,1*4B\r\n$GP");
+	appendRecord(out, 1010000000, capture::Direction::TX, "$PSTMCOLD*00\r\n");
+	appendRecord(out, 1050000000, capture::Direction::RX, "RMC,2*55\r\n");
+	appendRecord(out, 1100000000, capture::Direction::RX, "$GPVTG,3*4D\r\n");
+	return out;
+}
+
+struct Sink : public Trackable {
+	std::vector<std::string> sentences;
+	std::atomic<bool> done{false};
+
+	void onSentence(ByteVectorPtr bytes) { sentences.push_back(utils::bytesToString(*bytes)); }
+	void onEnd() { done = true; }
+};
+
+void waitDone(Sink & sink)
+{
+	for(int i = 0; i < 200 && !sink.done; i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+} // namespace
+
+TEST_CASE( "ReplayByteStream feeds the NMEA stream and captures writes", "[utils][ReplayByteStream]" ) {
+
+	Thread::setCreateThreadCb(Thread::createPthread);
+
+	std::string path = tmpPath("teseo-replay.cap");
+	writeFile(path, captureFile());
+
+	Sink sink;
+	NmeaStream nmeaStream;
+	IStream & nmea = nmeaStream;
+	ReplayByteStream replay(path, ReplayPacing::AS_FAST_AS_POSSIBLE);
+
+	replay.newBytes.connect(SlotFactory::create(nmea, &IStream::onNewBytes));
+	nmea.newSentence.connect(SlotFactory::create(sink, &Sink::onSentence));
+	replay.endOfCapture.connect(SlotFactory::create(sink, &Sink::onEnd));
+
+	replay.start();
+	replay.write(std::make_shared<ByteVector>(ByteVector({'$', 'P', 'S', 'T', 'M', 'S', 'R', 'R'})));
+	waitDone(sink);
+	replay.stop();
+	replay.join();
+
+	REQUIRE(sink.done);
+
+	// Sentences are emitted as soon as their checksum is received
+	REQUIRE(sink.sentences.size() == 3);
+	REQUIRE(sink.sentences[0] == "$GPGGA,1*4B");
+	REQUIRE(sink.sentences[1] == "$GPRMC,2*55");
+	REQUIRE(sink.sentences[2] == "$GPVTG,3*4D");
+
+	auto written = replay.takeWritten();
+	REQUIRE(written.size() == 1);
+	REQUIRE(utils::bytesToString(written[0]) == "$PSTMSRR");
+
+	remove(path.c_str());
+}
+
+TEST_CASE( "ReplayByteStream honours the scaled recorded timing", "[utils][ReplayByteStream]" ) {
+
+	Thread::setCreateThreadCb(Thread::createPthread);
+
+	std::string path = tmpPath("teseo-replay-timing.cap");
+	writeFile(path, captureFile());
+
+	Sink sink;
+	ReplayByteStream replay(path, ReplayPacing::SCALED, 2.0);
+	replay.endOfCapture.connect(SlotFactory::create(sink, &Sink::onEnd));
+
+	// 100 ms of capture replayed twice as fast
+	auto start = std::chrono::steady_clock::now();
+	replay.start();
+	waitDone(sink);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	replay.stop();
+	replay.join();
+
+	REQUIRE(sink.done);
+	REQUIRE(elapsed >= std::chrono::milliseconds(45));
+	REQUIRE(elapsed < std::chrono::milliseconds(1000));
+
+	remove(path.c_str());
+}
@@ -0,0 +1,160 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include <teseo/utils/ByteView.h>
+#include <teseo/utils/SentenceTable.h>
+#include <teseo/vendor/frozen/unordered_map.h>
+#include <teseo/vendor/frozen/string.h>
+
+using namespace stm;
+using namespace stm::utils;
+using namespace frozen::string_literals;
+
+static ByteView view(const char * str)
+{
+	return ByteView(reinterpret_cast<const uint8_t *>(str), std::strlen(str));
+}
+
+constexpr static SentenceEntry<int> registrations[] = {
+	standardSentence("RMC", 1),
+	standardSentence("GGA", 2),
+	standardSentence("VTG", 3),
+	standardSentence("GSV", 4),
+	standardSentence("GSA", 5),
+	proprietarySentence("SBAS", 6),
+	proprietarySentence("VER", 7),
+	proprietarySentence("STAGPS8PASSRTN", 8),
+	proprietarySentence("STAGPS8PASSGENERROR", 9),
+	proprietarySentence("STAGPSPASSRTN", 10),
+	proprietarySentence("STAGPSPASSGENERROR", 11),
+	proprietarySentence("STAGPSSATSEEDOK", 12),
+	proprietarySentence("STAGPSSATSEEDERROR", 13),
+	proprietarySentence("DRCAL", 14),
+	proprietarySentence("TG", 15)
+};
+
+constexpr static auto table = makeSentenceTable(registrations);
+
+static_assert(table.size() == 15, "Table size is deduced from the registrations");
+static_assert(table.hasUniqueKeys(), "Registered keys are unique");
+
+TEST_CASE( "Sentence table finds registered sentences", "[utils][SentenceTable]" ) {
+
+	CHECK(table.find(SentenceFamily::STANDARD, view("RMC"), 0) == 1);
+	CHECK(table.find(SentenceFamily::STANDARD, view("GSA"), 0) == 5);
+	CHECK(table.find(SentenceFamily::PROPRIETARY, view("STAGPS8PASSGENERROR"), 0) == 9);
+	CHECK(table.find(SentenceFamily::PROPRIETARY, view("TG"), 0) == 15);
+
+	// Each registration is bound to its family
+	CHECK(table.find(SentenceFamily::PROPRIETARY, view("RMC"), 0) == 0);
+	CHECK(table.find(SentenceFamily::STANDARD, view("VER"), 0) == 0);
+
+	CHECK(table.find(SentenceFamily::STANDARD, view("GLL"), 0) == 0);
+	CHECK(table.find(SentenceFamily::STANDARD, view("RM"), 0) == 0);
+	CHECK(table.find(SentenceFamily::STANDARD, view(""), 0) == 0);
+
+	constexpr static SentenceEntry<int> duplicated[] = {
+		standardSentence("RMC", 1),
+		standardSentence("GGA", 2),
+		standardSentence("RMC", 3)
+	};
+
+	static_assert(!makeSentenceTable(duplicated).hasUniqueKeys(), "Duplicated registrations are detected");
+}
+
+TEST_CASE( "Sentence dispatch benchmark", "[.][benchmark][utils][SentenceTable]" ) {
+
+	// Previous dispatch tables
+	constexpr static frozen::unordered_map<frozen::string, int, 5> standard = {
+		{"RMC"_s, 1}, {"GGA"_s, 2}, {"VTG"_s, 3}, {"GSV"_s, 4}, {"GSA"_s, 5}
+	};
+
+	constexpr static frozen::unordered_map<frozen::string, int, 10> proprietary = {
+		{"SBAS"_s, 6}, {"VER"_s, 7}, {"STAGPS8PASSRTN"_s, 8}, {"STAGPS8PASSGENERROR"_s, 9},
+		{"STAGPSPASSRTN"_s, 10}, {"STAGPSPASSGENERROR"_s, 11}, {"STAGPSSATSEEDOK"_s, 12},
+		{"STAGPSSATSEEDERROR"_s, 13}, {"DRCAL"_s, 14}, {"TG"_s, 15}
+	};
+
+	// Sentences of a typical epoch
+	const std::vector<std::pair<SentenceFamily, ByteView>> sentences = {
+		{SentenceFamily::STANDARD, view("RMC")},
+		{SentenceFamily::STANDARD, view("GGA")},
+		{SentenceFamily::STANDARD, view("VTG")},
+		{SentenceFamily::STANDARD, view("GSA")},
+		{SentenceFamily::STANDARD, view("GSA")},
+		{SentenceFamily::STANDARD, view("GSV")},
+		{SentenceFamily::STANDARD, view("GSV")},
+		{SentenceFamily::STANDARD, view("GSV")},
+		{SentenceFamily::STANDARD, view("GLL")},
+		{SentenceFamily::PROPRIETARY, view("TG")},
+		{SentenceFamily::PROPRIETARY, view("SBAS")},
+		{SentenceFamily::PROPRIETARY, view("PPSDATA")}
+	};
+
+	constexpr int iterations = 100000;
+	volatile int sink = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < iterations; i++)
+	{
+		for(const auto & s : sentences)
+		{
+			frozen::string sid(reinterpret_cast<const char *>(s.second.data()), s.second.size());
+
+			if(s.first == SentenceFamily::PROPRIETARY)
+			{
+				auto it = proprietary.find(sid);
+				sink = sink + ((it != proprietary.end()) ? (*it).second : 0);
+			}
+			else
+			{
+				auto it = standard.find(sid);
+				sink = sink + ((it != standard.end()) ? (*it).second : 0);
+			}
+		}
+	}
+
+	auto frozenDuration = std::chrono::steady_clock::now() - start;
+	start = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < iterations; i++)
+	{
+		for(const auto & s : sentences)
+			sink = sink + table.find(s.first, s.second, 0);
+	}
+
+	auto tableDuration = std::chrono::steady_clock::now() - start;
+
+	const double count = static_cast<double>(iterations) * sentences.size();
+	const double frozenNs = std::chrono::duration<double, std::nano>(frozenDuration).count() / count;
+	const double tableNs = std::chrono::duration<double, std::nano>(tableDuration).count() / count;
+
+	WARN("frozen::unordered_map: " << frozenNs << " ns/sentence");
+	WARN("SentenceTable:         " << tableNs << " ns/sentence");
+
+	CHECK(tableNs <= frozenNs);
+}
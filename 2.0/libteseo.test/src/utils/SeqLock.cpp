@@ -0,0 +1,124 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <teseo/utils/SeqLock.h>
+
+using namespace stm::utils;
+
+namespace {
+
+struct Sample {
+	uint32_t values[37];
+	uint8_t tail[3];
+};
+
+Sample makeSample(uint32_t n)
+{
+	Sample s;
+
+	for(auto & v : s.values)
+		v = n;
+
+	for(auto & t : s.tail)
+		t = static_cast<uint8_t>(n);
+
+	return s;
+}
+
+bool isConsistent(const Sample & s)
+{
+	for(auto v : s.values)
+	{
+		if(v != s.values[0])
+			return false;
+	}
+
+	for(auto t : s.tail)
+	{
+		if(t != static_cast<uint8_t>(s.values[0]))
+			return false;
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "SeqLock stores and loads values", "[utils][SeqLock]" ) {
+
+	SeqLock<Sample> lock(makeSample(7));
+
+	CHECK(lock.version() == 1);
+	CHECK(lock.load().values[36] == 7);
+	CHECK(lock.load().tail[2] == 7);
+
+	lock.store(makeSample(8));
+
+	CHECK(lock.version() == 2);
+	CHECK(isConsistent(lock.load()));
+	CHECK(lock.load().values[0] == 8);
+}
+
+TEST_CASE( "SeqLock readers never see a partial store", "[utils][SeqLock]" ) {
+
+	SeqLock<Sample> lock(makeSample(0));
+	std::atomic<bool> done(false);
+	std::atomic<unsigned int> inconsistent(0), backwards(0);
+
+	std::vector<std::thread> readers;
+
+	for(int i = 0; i < 3; i++)
+	{
+		readers.emplace_back([&] () {
+			uint32_t last = 0;
+
+			while(!done.load())
+			{
+				Sample s = lock.load();
+
+				if(!isConsistent(s))
+					inconsistent++;
+
+				if(s.values[0] < last)
+					backwards++;
+
+				last = s.values[0];
+			}
+		});
+	}
+
+	for(uint32_t n = 1; n <= 100000; n++)
+		lock.store(makeSample(n));
+
+	done = true;
+
+	for(auto & t : readers)
+		t.join();
+
+	CHECK(inconsistent == 0);
+	CHECK(backwards == 0);
+	CHECK(lock.load().values[0] == 100000);
+}
@@ -0,0 +1,270 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <teseo/utils/Signal.h>
+
+namespace {
+
+std::vector<int> calls;
+
+void first(int value)
+{
+	calls.push_back(value);
+}
+
+int twice(int value)
+{
+	return 2 * value;
+}
+
+class Receiver : public Trackable {
+public:
+	int sum = 0;
+
+	void add(int value)
+	{
+		sum += value;
+	}
+
+	int triple(int value)
+	{
+		return 3 * value;
+	}
+};
+
+/**
+ * Emit loop of the previous Signal implementation, for the benchmark
+ */
+class ListSignal {
+private:
+	typedef std::list<GenericSlot<void (int)>::ptr> SlotList;
+
+	SlotList slots;
+
+	std::string signalName = "ListSignal";
+
+	std::string toString() const
+	{
+		std::ostringstream out;
+		out << "Signal: '" << signalName << "', connected slots: " << slots.size();
+		return out.str();
+	}
+
+public:
+	void connect(const GenericSlot<void (int)>::ptr & slot)
+	{
+		slots.push_back(slot);
+	}
+
+	void emit(int value)
+	{
+		std::string trace = toString();
+		(void)trace;
+		std::deque<SlotList::iterator> toErase;
+
+		for(auto it = slots.begin(); it != slots.end(); ++it)
+		{
+			auto slot = *it;
+
+			if(slot->isValid())
+				slot->call(value);
+			else
+				toErase.push_back(it);
+		}
+
+		for(auto e : toErase)
+			slots.erase(e);
+	}
+};
+
+/**
+ * Previous method slot, locking the weak pointer on each call
+ */
+class LockingMethodSlot : public GenericSlot<void (int)> {
+private:
+	Trackable::weak_ptr instance;
+
+	void (Receiver::*slot)(int);
+
+public:
+	LockingMethodSlot(const Receiver & r, void (Receiver::*s)(int)) :
+		instance(r.getWeakPtr()),
+		slot(s)
+	{ }
+
+	void call(int value)
+	{
+		Receiver * r = static_cast<Receiver *>(instance.lock().get());
+		(r->*slot)(value);
+	}
+
+	bool isValid()
+	{
+		return !instance.expired();
+	}
+};
+
+} // namespace
+
+TEST_CASE( "Signal calls the slots in connection order", "[utils][Signal]" ) {
+
+	calls.clear();
+
+	Signal<void, int> sig("test");
+	Receiver receiver;
+
+	REQUIRE_FALSE(sig.isConnected());
+
+	sig.connect(SlotFactory::create(first));
+	sig.connect(SlotFactory::create(receiver, &Receiver::add));
+	sig.connect(SlotFactory::create(std::function<void (int)>([](int v) { calls.push_back(10 * v); })));
+
+	REQUIRE(sig.isConnected());
+
+	sig.emit(1);
+	sig(2);
+
+	REQUIRE(calls == std::vector<int>({1, 10, 2, 20}));
+	REQUIRE(receiver.sum == 3);
+}
+
+TEST_CASE( "Signal returns the last response and collects all of them", "[utils][Signal]" ) {
+
+	Signal<int, int> sig("test");
+	Receiver receiver;
+
+	sig.connect(SlotFactory::create(twice));
+	sig.connect(SlotFactory::create(receiver, &Receiver::triple));
+
+	REQUIRE(sig.emit(5) == 15);
+	REQUIRE(sig.collect(5) == std::list<int>({10, 15}));
+}
+
+TEST_CASE( "Signal erases the slots of destroyed instances", "[utils][Signal]" ) {
+
+	calls.clear();
+
+	Signal<void, int> sig("test");
+	auto receiver = std::make_unique<Receiver>();
+
+	sig.connect(SlotFactory::create(*receiver, &Receiver::add));
+	sig.connect(SlotFactory::create(first));
+
+	sig.emit(1);
+	REQUIRE(receiver->sum == 1);
+
+	receiver.reset();
+
+	sig.emit(2);
+	REQUIRE(calls == std::vector<int>({1, 2}));
+
+	// The function slot is still connected
+	REQUIRE(sig.isConnected());
+}
+
+TEST_CASE( "Signal forwards to another signal", "[utils][Signal]" ) {
+
+	calls.clear();
+
+	Signal<void, int> source("source");
+	Signal<void, int> target("target");
+
+	target.connect(SlotFactory::create(first));
+	source.connect(SlotFactory::create(target));
+
+	source.emit(7);
+
+	REQUIRE(calls == std::vector<int>({7}));
+}
+
+TEST_CASE( "Slots connected during an emit are called by the next one", "[utils][Signal]" ) {
+
+	calls.clear();
+
+	Signal<void, int> sig("test");
+
+	sig.connect(SlotFactory::create(std::function<void (int)>([&sig](int v) {
+		calls.push_back(v);
+
+		// Grow the slot storage while it is iterated
+		if(v == 1)
+		{
+			for(int i = 0; i < 16; i++)
+				sig.connect(SlotFactory::create(first));
+		}
+	})));
+
+	sig.emit(1);
+	REQUIRE(calls == std::vector<int>({1}));
+
+	calls.clear();
+	sig.emit(2);
+	REQUIRE(calls.size() == 17);
+}
+
+TEST_CASE( "Signal emit benchmark", "[.][benchmark][utils][Signal]" ) {
+
+	constexpr int iterations = 1000000;
+
+	Receiver receiver;
+
+	ListSignal before;
+	before.connect(SlotFactory::create(std::function<void (int)>([&receiver](int v) { receiver.sum += v; })));
+	before.connect(GenericSlot<void (int)>::ptr(new LockingMethodSlot(receiver, &Receiver::add)));
+
+	Signal<void, int> after("after");
+	after.connect(SlotFactory::create(first));
+	after.connect(SlotFactory::create(receiver, &Receiver::add));
+
+	calls.clear();
+	calls.reserve(iterations);
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < iterations; i++)
+		before.emit(i & 1);
+
+	auto beforeDuration = std::chrono::steady_clock::now() - start;
+	start = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < iterations; i++)
+		after.emit(i & 1);
+
+	auto afterDuration = std::chrono::steady_clock::now() - start;
+
+	const double beforeNs = std::chrono::duration<double, std::nano>(beforeDuration).count() / iterations;
+	const double afterNs = std::chrono::duration<double, std::nano>(afterDuration).count() / iterations;
+
+	WARN("List of shared_ptr slots: " << beforeNs << " ns/emit");
+	WARN("Contiguous slots:         " << afterNs << " ns/emit");
+
+	CHECK(afterNs <= beforeNs);
+}
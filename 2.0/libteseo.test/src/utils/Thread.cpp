@@ -0,0 +1,141 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+#include <teseo/utils/Thread.h>
+
+using namespace stm;
+
+namespace {
+
+/**
+ * Thread recording its scheduling settings
+ */
+class ProbeThread : public Thread {
+public:
+	std::size_t stackSize = 0;
+	int policy = -1;
+	int nice = 0;
+	cpu_set_t cpus;
+
+	ProbeThread(const char * name) : Thread(name) { }
+
+	int stop() override { return 0; }
+
+protected:
+	void run() override
+	{
+		pthread_attr_t attr;
+
+		if(pthread_getattr_np(pthread_self(), &attr) == 0)
+		{
+			pthread_attr_getstacksize(&attr, &stackSize);
+			pthread_attr_destroy(&attr);
+		}
+
+		policy = sched_getscheduler(0);
+		nice = getpriority(PRIO_PROCESS, 0);
+
+		CPU_ZERO(&cpus);
+		sched_getaffinity(0, sizeof(cpus), &cpus);
+	}
+};
+
+} // namespace
+
+TEST_CASE( "Thread scheduling policy names", "[utils][Thread]" ) {
+
+	using Policy = ThreadSettings::Policy;
+	Policy policy = Policy::OTHER;
+
+	REQUIRE(ThreadSettings::parsePolicy("", policy));
+	REQUIRE(policy == Policy::INHERIT);
+
+	REQUIRE(ThreadSettings::parsePolicy("fifo", policy));
+	REQUIRE(policy == Policy::FIFO);
+
+	REQUIRE(ThreadSettings::parsePolicy("batch", policy));
+	REQUIRE(policy == Policy::BATCH);
+
+	REQUIRE_FALSE(ThreadSettings::parsePolicy("FIFO", policy));
+	REQUIRE_FALSE(ThreadSettings::parsePolicy("deadline", policy));
+	REQUIRE(policy == Policy::BATCH);
+}
+
+TEST_CASE( "Thread settings are keyed by thread name", "[utils][Thread]" ) {
+
+	ThreadSettings settings;
+	settings.policy = ThreadSettings::Policy::RR;
+	settings.priority = 3;
+	settings.affinity = {0};
+	settings.stackSize = 128 * 1024;
+
+	Thread::setSettings("unit-test-settings", settings);
+
+	ThreadSettings registered = Thread::getSettings("unit-test-settings");
+
+	REQUIRE(registered.policy == ThreadSettings::Policy::RR);
+	REQUIRE(registered.priority == 3);
+	REQUIRE(registered.affinity == std::vector<unsigned int>({0}));
+	REQUIRE(registered.stackSize == 128 * 1024);
+
+	ThreadSettings unknown = Thread::getSettings("unit-test-unknown");
+
+	REQUIRE(unknown.policy == ThreadSettings::Policy::INHERIT);
+	REQUIRE(unknown.affinity.empty());
+	REQUIRE(unknown.stackSize == 0);
+}
+
+TEST_CASE( "Thread is created with its settings", "[utils][Thread]" ) {
+
+	Thread::setCreateThreadCb(Thread::createPthread);
+
+	ThreadSettings settings;
+	settings.policy = ThreadSettings::Policy::BATCH;
+	settings.priority = 5; // Lowering the priority doesn't need any capability
+	settings.affinity = {0};
+	settings.stackSize = 256 * 1024;
+
+	Thread::setSettings("unit-test-probe", settings);
+
+	ProbeThread probe("unit-test-probe");
+	REQUIRE(probe.start() == 0);
+	probe.join();
+
+	CHECK(probe.stackSize == 256 * 1024);
+	CHECK(probe.policy == SCHED_BATCH);
+	CHECK(probe.nice == 5);
+	CHECK(CPU_COUNT(&probe.cpus) == 1);
+	CHECK(CPU_ISSET(0, &probe.cpus));
+
+	// Threads without settings keep the default ones
+	ProbeThread other("unit-test-other");
+	other.start();
+	other.join();
+
+	CHECK(other.policy == SCHED_OTHER);
+	CHECK(other.nice == 0);
+	CHECK(other.stackSize != 256 * 1024);
+}
@@ -24,6 +24,12 @@
 #include <teseo/utils/ByteVector.h>
 #include <teseo/utils/Time.h>
 
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <sys/time.h>
+
 using namespace stm;
 using namespace stm::utils;
 
@@ -42,10 +48,138 @@ TEST_CASE( "NMEA Time parser works correctly", "[utils][Time]" ) {
 
 	CHECK(time == 49062000);
 
-	/* ByteVector empty = { };
+	ByteVector empty = { };
 
 	std::optional<GnssUtcTime> opt_empty = parseTimestamp(empty);
 
 	REQUIRE(static_cast<bool>(opt_empty) == false);
-	*/
+
+	ByteVector truncated = { '1', '3', '3', '7' };
+
+	REQUIRE(static_cast<bool>(parseTimestamp(truncated)) == false);
+
+	// RMC time and date fields are empty until the receiver knows the time
+	REQUIRE(static_cast<bool>(parseTimeAndDate(ByteView(), ByteView())) == false);
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "Epoch");
+static_assert(daysFromCivil(2000, 3, 1) == 11017, "Day after a centennial leap day");
+static_assert(daysFromCivil(1969, 12, 31) == -1, "Day before the epoch");
+
+static ByteView view(const char * str)
+{
+	return ByteView(reinterpret_cast<const uint8_t *>(str), std::strlen(str));
+}
+
+/**
+ * @brief      Previous RMC time and date conversion, based on mktime()
+ *
+ * @details    Only gives UTC times when the local time zone is UTC.
+ */
+static GnssUtcTime legacyTimeAndDate(ByteView time, ByteView date)
+{
+	auto field = [] (ByteView bytes, std::size_t offset, std::size_t size) {
+		return std::stoi(std::string(bytes.begin() + offset, bytes.begin() + offset + size));
+	};
+
+	tm timestamp;
+	struct timeval tv;
+	struct timezone tz;
+
+	std::memset(&timestamp, 0, sizeof(timestamp));
+	gettimeofday(&tv, &tz);
+
+	timestamp.tm_hour = field(time, 0, 2);
+	timestamp.tm_min = field(time, 2, 2);
+	timestamp.tm_sec = field(time, 4, 2);
+	int msec = field(time, 7, 3);
+	timestamp.tm_mday = field(date, 0, 2);
+	timestamp.tm_mon = field(date, 2, 2) - 1;
+	timestamp.tm_year = field(date, 4, 2) + 100;
+
+	auto resultTime = system_clock::from_time_t(mktime(&timestamp));
+
+	return duration_cast<milliseconds>(resultTime.time_since_epoch()).count() + msec -
+		(tz.tz_minuteswest * 60 * 1000);
+}
+
+TEST_CASE( "NMEA time and date parser works correctly", "[utils][Time]" ) {
+
+	struct Case {
+		const char * time;
+		const char * date;
+		GnssUtcTime expected;
+	};
+
+	const Case cases[] = {
+		{"133742.000", "010170", 0},
+		{"000000.000", "010100", 946684800000},
+		{"235959.999", "290200", 951868799999},
+		{"123519.250", "230394", 0},
+		{"083559.000", "060180", 0},
+		{"220516.500", "130520", 1589407516500}
+	};
+
+	for(const auto & c : cases)
+	{
+		auto opt = parseTimeAndDate(view(c.time), view(c.date));
+		REQUIRE(static_cast<bool>(opt) == true);
+
+		if(c.expected != 0)
+			CHECK(*opt == c.expected);
+
+		// Same result as the C library UTC conversion
+		tm timestamp;
+		std::memset(&timestamp, 0, sizeof(timestamp));
+		std::sscanf(c.time, "%2d%2d%2d", &timestamp.tm_hour, &timestamp.tm_min, &timestamp.tm_sec);
+		std::sscanf(c.date, "%2d%2d%2d", &timestamp.tm_mday, &timestamp.tm_mon, &timestamp.tm_year);
+		timestamp.tm_mon -= 1;
+		timestamp.tm_year += 100;
+
+		CHECK(*opt / 1000 == static_cast<GnssUtcTime>(timegm(&timestamp)));
+	}
+
+	// Parsing the same date twice uses the cached day offset
+	CHECK(*parseTimeAndDate(view("220516.500"), view("130520")) == 1589407516500);
+	CHECK(*parseTimeAndDate(view("220517.000"), view("130520")) == 1589407517000);
+
+	// Optional and shorter fractional part
+	CHECK(*parseTimeAndDate(view("220516"), view("130520")) == 1589407516000);
+	CHECK(*parseTimeAndDate(view("220516.5"), view("130520")) == 1589407516500);
+
+	CHECK(static_cast<bool>(parseTimeAndDate(view("220516.500"), view(""))) == false);
+	CHECK(static_cast<bool>(parseTimeAndDate(view("250516.500"), view("130520"))) == false);
+	CHECK(static_cast<bool>(parseTimeAndDate(view("220516.500"), view("131320"))) == false);
+	CHECK(static_cast<bool>(parseTimeAndDate(view("2205-6.500"), view("130520"))) == false);
+	CHECK(static_cast<bool>(parseTimeAndDate(view("220516,500"), view("130520"))) == false);
+}
+
+TEST_CASE( "NMEA time and date parser benchmark", "[.][benchmark][utils][Time]" ) {
+
+	constexpr int iterations = 100000;
+	volatile GnssUtcTime sink = 0;
+
+	const ByteView time = view("220516.500");
+	const ByteView date = view("130520");
+
+	auto start = steady_clock::now();
+
+	for(int i = 0; i < iterations; i++)
+		sink = sink + legacyTimeAndDate(time, date);
+
+	auto legacyDuration = steady_clock::now() - start;
+	start = steady_clock::now();
+
+	for(int i = 0; i < iterations; i++)
+		sink = sink + *parseTimeAndDate(time, date);
+
+	auto arithmeticDuration = steady_clock::now() - start;
+
+	const double legacyNs = duration<double, std::nano>(legacyDuration).count() / iterations;
+	const double arithmeticNs = duration<double, std::nano>(arithmeticDuration).count() / iterations;
+
+	WARN("mktime:        " << legacyNs << " ns/sentence");
+	WARN("daysFromCivil: " << arithmeticNs << " ns/sentence");
+
+	CHECK(arithmeticNs < legacyNs);
 }
@@ -0,0 +1,100 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Pool of reusable byte buffers
+ * @file BufferPool.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_UTILS_BUFFER_POOL_H
+#define TESEO_HAL_UTILS_BUFFER_POOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "ByteVector.h"
+
+namespace stm {
+namespace stream {
+
+/**
+ * @brief      Pool of reusable ByteVector buffers
+ *
+ * @details    The pool owns a fixed number of buffers, allocated once with a reserved capacity. A
+ * buffer handed out by acquire() goes back to the pool when the last ByteVectorPtr referencing it
+ * outside of the pool is released, its capacity is kept so steady-state acquisition doesn't
+ * allocate. When every buffer is in use, acquire() falls back to a heap allocated buffer.
+ *
+ * acquire() must be called from a single thread (the producer), the buffers can be released from
+ * any thread.
+ */
+class BufferPool {
+private:
+	std::vector<ByteVectorPtr> buffers;
+
+	std::size_t next;
+
+	uint64_t misses;
+
+public:
+	/**
+	 * Default number of buffers in the pool
+	 */
+	static constexpr std::size_t DEFAULT_BUFFERS = 64;
+
+	/**
+	 * Default capacity of a buffer, in bytes
+	 */
+	static constexpr std::size_t DEFAULT_CAPACITY = 128;
+
+	/**
+	 * @brief      Create a buffer pool
+	 *
+	 * @param[in]  count     Number of buffers in the pool
+	 * @param[in]  capacity  Initial capacity of each buffer, in bytes
+	 */
+	BufferPool(std::size_t count = DEFAULT_BUFFERS, std::size_t capacity = DEFAULT_CAPACITY);
+
+	/**
+	 * @brief      Get an empty buffer
+	 *
+	 * @return     An empty buffer, from the pool when one is free
+	 */
+	ByteVectorPtr acquire();
+
+	/**
+	 * @brief      Get the number of buffers in the pool
+	 */
+	std::size_t size() const;
+
+	/**
+	 * @brief      Get the number of acquisitions served by the heap because the pool was exhausted
+	 */
+	uint64_t missCount() const;
+};
+
+} // namespace stream
+} // namespace stm
+
+#endif // TESEO_HAL_UTILS_BUFFER_POOL_H
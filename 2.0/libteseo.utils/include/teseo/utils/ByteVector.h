@@ -36,8 +36,10 @@
 #include <cstdint>
 #include <memory>
 #include <array>
+#include <utility>
 
 #include "optional.h"
+#include "NumberParser.h"
 
 #include <teseo/utils/Gnss_2_0.h>
 
@@ -172,16 +174,15 @@ template<typename Tout>
 struct ByteVectorParser
 {
 	/**
-	 * Parse a byte vector
+	 * Parse a byte range
 	 *
-	 * @param[in]  begin Byte vector begin
-	 * @param[in]  end   Byte vector end
+	 * @param[in]  begin Byte range begin, ByteVector iterator or byte pointer
+	 * @param[in]  end   Byte range end
 	 *
 	 * @return     The parsed value, or an empty value.
 	 */
-	std::optional<Tout> operator()(
-		const ByteVector::const_iterator & begin,
-		const ByteVector::const_iterator & end)
+	template<typename Iterator>
+	std::optional<Tout> operator()(const Iterator & begin, const Iterator & end)
 	{
 		(void)(begin); (void)(end);
 		static_assert(true, "Missing implementation of ByteVectorParser");
@@ -203,132 +204,155 @@ struct ByteVectorParser
 	}
 };
 
+namespace __private {
+
+/**
+ * @brief      Get the byte pointer range of an iterator range
+ *
+ * @details    The iterators must reference contiguous bytes, a ByteVector iterator or a byte pointer.
+ */
+template<typename Iterator>
+inline std::pair<const uint8_t *, const uint8_t *> __bytevector_range(
+	const Iterator & begin,
+	const Iterator & end)
+{
+	if(begin == end)
+		return {nullptr, nullptr};
+
+	const uint8_t * first = &*begin;
+	return {first, first + (end - begin)};
+}
+
+} // namespace __private
+
 /**
  * @brief Byte vector integer parser.
  *
- * @todo Avoid string convertion, directly parse the byte vector.
+ * @details Based on parseInteger(), empty and invalid fields give an empty value.
  */
 template<>
 struct ByteVectorParser<int>
 {
-	std::optional<int> operator()(
-		const ByteVector::const_iterator & begin,
-		const ByteVector::const_iterator & end)
+	template<typename Iterator>
+	std::optional<int> operator()(const Iterator & begin, const Iterator & end)
 	{
-		if(begin == end)
+		auto range = __private::__bytevector_range(begin, end);
+		int32_t value;
+
+		if(parseInteger(range.first, range.second, value) != ParseStatus::OK)
 			return {};
 
-		return std::stoi(bytesToString(begin, end));
+		return value;
 	}
 
 	std::optional<int> operator()(const ByteVector & data)
 	{
-		if(data.size() == 0)
-			return {};
-
-		return std::stoi(bytesToString(data));
+		return (*this)(data.begin(), data.end());
 	}
 };
 
 /**
  * @brief Byte vector double precision number parser.
  *
- * @todo Avoid string convertion, directly parse the byte vector.
+ * @details Based on parseDouble(), empty and invalid fields give an empty value.
  */
 template<>
 struct ByteVectorParser<double>
 {
-	std::optional<double> operator()(const ByteVector::const_iterator & begin, const ByteVector::const_iterator & end)
+	template<typename Iterator>
+	std::optional<double> operator()(const Iterator & begin, const Iterator & end)
 	{
-		if(begin == end)
+		auto range = __private::__bytevector_range(begin, end);
+		double value;
+
+		if(parseDouble(range.first, range.second, value) != ParseStatus::OK)
 			return {};
 
-		return std::stod(bytesToString(begin, end));
+		return value;
 	}
 
 	std::optional<double> operator()(const ByteVector & data)
 	{
-		if(data.size() == 0)
-			return {};
-
-		return std::stod(bytesToString(data));
+		return (*this)(data.begin(), data.end());
 	}
 };
 
 /**
  * @brief Byte vector single precision number parser.
  *
- * @todo Avoid string convertion, directly parse the byte vector.
+ * @details Based on parseFloat(), empty and invalid fields give an empty value.
  */
 template<>
 struct ByteVectorParser<float>
 {
-	std::optional<float> operator()(const ByteVector::const_iterator & begin, const ByteVector::const_iterator & end)
+	template<typename Iterator>
+	std::optional<float> operator()(const Iterator & begin, const Iterator & end)
 	{
-		if(begin == end)
+		auto range = __private::__bytevector_range(begin, end);
+		float value;
+
+		if(parseFloat(range.first, range.second, value) != ParseStatus::OK)
 			return {};
 
-		return std::stof(bytesToString(begin, end));
+		return value;
 	}
 
 	std::optional<float> operator()(const ByteVector & data)
 	{
-		if(data.size() == 0)
-			return {};
-
-		return std::stof(bytesToString(data));
+		return (*this)(data.begin(), data.end());
 	}
 };
 
 /**
  * @brief Byte vector short integer (16 bits, 2 bytes) parser.
  *
- * @todo Avoid string convertion, directly parse the byte vector.
+ * @details Based on parseInteger(), empty and invalid fields give an empty value.
  */
 template<>
 struct ByteVectorParser<int16_t>
 {
-	std::optional<int16_t> operator()(const ByteVector::const_iterator & begin, const ByteVector::const_iterator & end)
+	template<typename Iterator>
+	std::optional<int16_t> operator()(const Iterator & begin, const Iterator & end)
 	{
-		if(begin == end)
+		auto range = __private::__bytevector_range(begin, end);
+		int16_t value;
+
+		if(parseInteger(range.first, range.second, value) != ParseStatus::OK)
 			return {};
 
-		return static_cast<int16_t>(std::stoi(bytesToString(begin, end)));
+		return value;
 	}
 
 	std::optional<int16_t> operator()(const ByteVector & data)
 	{
-		if(data.size() == 0)
-			return {};
-
-		return static_cast<int16_t>(std::stoi(bytesToString(data)));
+		return (*this)(data.begin(), data.end());
 	}
 };
 
 /**
  * @brief Byte vector boolean parser.
  *
- * @details Parse numeric boolean, 0 is false, all other values are true.
- *
- * @todo Avoid string convertion, directly parse the byte vector.
+ * @details Parse numeric boolean, 0 is false, all other values are true. Based on
+ * parseBoolean(), empty and invalid fields give an empty value.
  */
 template<>
 struct ByteVectorParser<bool>
 {
-	std::optional<bool> operator()(const ByteVector::const_iterator & begin, const ByteVector::const_iterator & end)
+	template<typename Iterator>
+	std::optional<bool> operator()(const Iterator & begin, const Iterator & end)
 	{
-		if(begin == end)
+		auto range = __private::__bytevector_range(begin, end);
+		bool value;
+
+		if(parseBoolean(range.first, range.second, value) != ParseStatus::OK)
 			return {};
 
-		return std::stoi(bytesToString(begin, end)) != 0;
+		return value;
 	}
 
 	std::optional<bool> operator()(const ByteVector & data)
 	{
-		if(data.size() == 0)
-			return {};
-
-		return std::stoi(bytesToString(data)) != 0;
+		return (*this)(data.begin(), data.end());
 	}
 };
 
@@ -340,18 +364,16 @@ void __bytevector_parse_log_error(const char * format, const char * bytes, int s
 /**
  * @brief Generic byte vector parser function
  *
- * @param begin   Iterator to the begining of the byte vector to parse
- * @param end     Iterator to the end of the byte vector to parse
+ * @param begin   Iterator to the begining of the bytes to parse, ByteVector iterator or byte pointer
+ * @param end     Iterator to the end of the bytes to parse
  *
  * @tparam Tout   The type of value to parse
  * @tparam Parser The parser to use, automatically deduced from Tout
  *
  * @return        The parsed value, or empty value.
  */
-template <typename Tout, class Parser=ByteVectorParser<Tout> >
-std::optional<Tout> byteVectorParse(
-	const ByteVector::const_iterator & begin,
-	const ByteVector::const_iterator & end) noexcept
+template <typename Tout, class Parser=ByteVectorParser<Tout>, typename Iterator>
+std::optional<Tout> byteVectorParse(const Iterator & begin, const Iterator & end) noexcept
 {
 	try
 	{
@@ -362,21 +384,21 @@ std::optional<Tout> byteVectorParse(
 	{
 		__private::__bytevector_parse_log_error(
 			"byteVectorParse: Invalid argument: %s, data: '%s' (%d bytes)",
-			ex.what(), bytesToString(begin,end).c_str(), end - begin);
+			ex.what(), std::string(begin, end).c_str(), end - begin);
 		return {};
 	}
 	catch(const std::exception & ex)
 	{
 		__private::__bytevector_parse_log_error(
 			"byteVectorParse: exception: %s, data: '%s' (%d bytes)",
-			ex.what(), bytesToString(begin,end).c_str(), end - begin);
+			ex.what(), std::string(begin, end).c_str(), end - begin);
 		return {};
 	}
 	catch(...)
 	{
 		__private::__bytevector_parse_log_error(
 			"byteVectorParse: unknown exception data: '%s' (%d bytes)",
-			bytesToString(begin,end).c_str(), end - begin);
+			std::string(begin, end).c_str(), end - begin);
 		return {};
 	}
 }
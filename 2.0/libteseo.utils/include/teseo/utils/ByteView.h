@@ -0,0 +1,229 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Read-only byte slice
+ * @file ByteView.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_UTILS_BYTE_VIEW_H
+#define TESEO_HAL_UTILS_BYTE_VIEW_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "ByteVector.h"
+
+namespace stm {
+
+/**
+ * @brief      Non-owning read-only view over contiguous bytes
+ *
+ * @details    A ByteView doesn't own the bytes it references, the producer of the view defines
+ * how long the underlying storage stays valid. Copy the view into a ByteVector with toVector() to
+ * keep the bytes longer.
+ */
+class ByteView {
+private:
+	const uint8_t * ptr;
+
+	std::size_t count;
+
+public:
+	using value_type = uint8_t;
+	using const_iterator = const uint8_t *;
+	using iterator = const_iterator;
+
+	constexpr ByteView() :
+		ptr(nullptr),
+		count(0)
+	{ }
+
+	constexpr ByteView(const uint8_t * data, std::size_t size) :
+		ptr(data),
+		count(size)
+	{ }
+
+	ByteView(const_iterator first, const_iterator last) :
+		ptr(first),
+		count(static_cast<std::size_t>(last - first))
+	{ }
+
+	ByteView(const ByteVector & bytes) :
+		ptr(bytes.data()),
+		count(bytes.size())
+	{ }
+
+	constexpr const uint8_t * data() const { return ptr; }
+
+	constexpr std::size_t size() const { return count; }
+
+	constexpr bool empty() const { return count == 0; }
+
+	constexpr const_iterator begin() const { return ptr; }
+
+	constexpr const_iterator end() const { return ptr + count; }
+
+	constexpr uint8_t operator[](std::size_t pos) const { return ptr[pos]; }
+
+	uint8_t at(std::size_t pos) const
+	{
+		if(pos >= count)
+			throw std::out_of_range("ByteView::at");
+
+		return ptr[pos];
+	}
+
+	constexpr uint8_t front() const { return ptr[0]; }
+
+	constexpr uint8_t back() const { return ptr[count - 1]; }
+
+	/**
+	 * @brief      Get a view over a part of this view
+	 *
+	 * @param[in]  pos   First byte of the sub-view
+	 * @param[in]  len   Maximum number of bytes in the sub-view
+	 *
+	 * @return     The sub-view, clamped to the bounds of this view
+	 */
+	ByteView subview(std::size_t pos, std::size_t len = static_cast<std::size_t>(-1)) const
+	{
+		if(pos > count)
+			pos = count;
+
+		if(len > count - pos)
+			len = count - pos;
+
+		return ByteView(ptr + pos, len);
+	}
+
+	/**
+	 * @brief      Copy the viewed bytes in a new ByteVector
+	 */
+	ByteVector toVector() const
+	{
+		return ByteVector(begin(), end());
+	}
+
+	bool operator==(const ByteView & other) const
+	{
+		return count == other.count && (count == 0 || std::memcmp(ptr, other.ptr, count) == 0);
+	}
+
+	bool operator!=(const ByteView & other) const
+	{
+		return !(*this == other);
+	}
+};
+
+namespace utils {
+
+/**
+ * @brief      Convert viewed ascii bytes to a string
+ *
+ * @param[in]  bytes  The bytes
+ *
+ * @return     ASCII bytes as string
+ */
+inline std::string bytesToString(ByteView bytes)
+{
+	return std::string(bytes.begin(), bytes.end());
+}
+
+/**
+ * @brief      Generic byte view parser function
+ *
+ * @param      bytes  The bytes to parse
+ *
+ * @tparam     Tout   The type of value to parse
+ * @tparam     Parser The parser to use, automatically deduced from Tout
+ *
+ * @return     The parsed value, or empty value.
+ */
+template <typename Tout, class Parser=ByteVectorParser<Tout> >
+std::optional<Tout> byteVectorParse(ByteView bytes) noexcept
+{
+	return byteVectorParse<Tout, Parser>(bytes.begin(), bytes.end());
+}
+
+/**
+ * @brief      Parse a numeric field view
+ *
+ * @details    See the @ref number_parser "numeric field parsers".
+ */
+template <typename Tout>
+ParseStatus parseNumber(ByteView field, Tout & out) noexcept;
+
+template <>
+inline ParseStatus parseNumber(ByteView field, int32_t & out) noexcept
+{
+	return parseInteger(field.begin(), field.end(), out);
+}
+
+template <>
+inline ParseStatus parseNumber(ByteView field, int16_t & out) noexcept
+{
+	return parseInteger(field.begin(), field.end(), out);
+}
+
+template <>
+inline ParseStatus parseNumber(ByteView field, FixedPoint & out) noexcept
+{
+	return parseFixedPoint(field.begin(), field.end(), out);
+}
+
+template <>
+inline ParseStatus parseNumber(ByteView field, double & out) noexcept
+{
+	return parseDouble(field.begin(), field.end(), out);
+}
+
+template <>
+inline ParseStatus parseNumber(ByteView field, float & out) noexcept
+{
+	return parseFloat(field.begin(), field.end(), out);
+}
+
+template <>
+inline ParseStatus parseNumber(ByteView field, bool & out) noexcept
+{
+	return parseBoolean(field.begin(), field.end(), out);
+}
+
+/**
+ * @brief      Parse a NMEA coordinate and its hemisphere field to decimal degrees
+ */
+inline ParseStatus parseCoordinate(ByteView coordinate, ByteView hemisphere, double & out) noexcept
+{
+	return parseCoordinate(
+		coordinate.begin(), coordinate.end(), hemisphere.empty() ? 0 : hemisphere[0], out);
+}
+
+} // namespace utils
+} // namespace stm
+
+#endif // TESEO_HAL_UTILS_BYTE_VIEW_H
@@ -0,0 +1,244 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Byte stream capture format
+ * @file Capture.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_UTILS_CAPTURE_H
+#define TESEO_HAL_UTILS_CAPTURE_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+#include "ByteView.h"
+
+namespace stm {
+namespace stream {
+namespace capture {
+
+/**
+ * @brief      Capture file layout
+ *
+ * @details    A capture file starts with a FileHeader, followed by records. Each record is a
+ * RecordHeader immediately followed by `length` bytes of data. All integers are stored in the
+ * host byte order. Timestamps are CLOCK_MONOTONIC nanoseconds.
+ *
+ * A rolling capture (written by CaptureRecorder) has a fixed size. When the end of the file is
+ * reached, new records are written from headerSize again, overwriting the oldest records. The
+ * records are then read from `oldest` to `wrap`, then from `headerSize` to `next`. A capture
+ * with `next` equal to zero is linear: its records run from `headerSize` to the end of the file.
+ *
+ * Files without the capture magic are read as raw NMEA logs: each line is an RX record, the
+ * timestamps are derived from the line speed given to CaptureReader::open.
+ */
+constexpr uint8_t MAGIC[8] = {'T', 'E', 'S', 'E', 'O', 'C', 'A', 'P'};
+
+constexpr uint32_t VERSION = 1;
+
+struct FileHeader {
+	uint8_t magic[8];
+	uint32_t version;
+	uint32_t headerSize; ///< Offset of the data area
+	uint64_t oldest;     ///< Offset of the oldest record
+	uint64_t wrap;       ///< End of the oldest records when the capture wrapped, zero otherwise
+	uint64_t next;       ///< End of the newest record, zero for linear captures
+	uint64_t dropped;    ///< Number of records too large to be recorded
+};
+
+enum class Direction : uint8_t {
+	RX = 0, ///< Bytes read from the device
+	TX = 1  ///< Bytes written to the device
+};
+
+struct RecordHeader {
+	uint64_t timestamp;
+	uint32_t length;
+	uint8_t direction;
+	uint8_t reserved[3];
+};
+
+static_assert(sizeof(FileHeader) == 48, "Unexpected capture file header size");
+static_assert(sizeof(RecordHeader) == 16, "Unexpected capture record header size");
+
+/**
+ * @brief      Capture record, bytes are a view over the mapped capture file
+ */
+struct Record {
+	std::chrono::nanoseconds timestamp;
+	Direction direction;
+	ByteView bytes;
+};
+
+/**
+ * @brief      Sequential capture file reader
+ *
+ * @details    The file is memory-mapped, record views stay valid until the reader is closed.
+ */
+class CaptureReader {
+private:
+	const uint8_t * base;
+
+	std::size_t size;
+
+	std::size_t offset;
+
+	/**
+	 * End of the segment being read
+	 */
+	std::size_t end;
+
+	/**
+	 * Second segment of a wrapped capture, empty otherwise
+	 */
+	std::size_t secondStart;
+
+	std::size_t secondEnd;
+
+	bool raw;
+
+	unsigned int rawBaudrate;
+
+	std::chrono::nanoseconds rawTimestamp;
+
+	bool nextRaw(Record & record);
+
+public:
+	CaptureReader();
+
+	~CaptureReader();
+
+	CaptureReader(const CaptureReader &) = delete;
+
+	CaptureReader & operator=(const CaptureReader &) = delete;
+
+	/**
+	 * @brief      Open a capture file
+	 *
+	 * @param[in]  path         The capture file path
+	 * @param[in]  rawBaudrate  Line speed used to time raw NMEA logs
+	 *
+	 * @return     True on success
+	 */
+	bool open(const std::string & path, unsigned int rawBaudrate);
+
+	void close();
+
+	bool isOpen() const;
+
+	/**
+	 * @brief      Get the next record
+	 *
+	 * @param      record  The record read
+	 *
+	 * @return     False when there is no more record
+	 */
+	bool next(Record & record);
+
+	/**
+	 * @brief      Restart reading from the first record
+	 */
+	void rewind();
+};
+
+/**
+ * @brief      Rolling capture file recorder
+ *
+ * @details    The capture file is created with its final size and memory-mapped, appending a
+ * record is a copy in the mapping. Once the file is full the oldest records are overwritten. The
+ * kernel writes the mapping back to the file, so the capture survives a crash of the HAL.
+ *
+ * append() can be called concurrently from the reader and writer threads.
+ */
+class CaptureRecorder {
+private:
+	uint8_t * base;
+
+	std::size_t size;
+
+	FileHeader * header;
+
+	std::mutex mutex;
+
+	std::size_t recordSizeAt(std::size_t offset) const;
+
+	/**
+	 * Release old records until `count` bytes are free at header->next
+	 */
+	void reserve(std::size_t count);
+
+public:
+	/**
+	 * Minimal capture file size
+	 */
+	static constexpr std::size_t MIN_SIZE = 4096;
+
+	CaptureRecorder();
+
+	~CaptureRecorder();
+
+	CaptureRecorder(const CaptureRecorder &) = delete;
+
+	CaptureRecorder & operator=(const CaptureRecorder &) = delete;
+
+	/**
+	 * @brief      Create the capture file
+	 *
+	 * @param[in]  path     The capture file path, truncated if it exists
+	 * @param[in]  maxSize  The capture file size in bytes
+	 *
+	 * @return     True on success
+	 */
+	bool open(const std::string & path, std::size_t maxSize);
+
+	void close();
+
+	bool isOpen() const;
+
+	/**
+	 * @brief      Append a record timestamped now
+	 *
+	 * @param[in]  direction  Bytes direction
+	 * @param[in]  bytes      The bytes
+	 */
+	void append(Direction direction, ByteView bytes);
+
+	/**
+	 * @brief      Append a record
+	 *
+	 * @param[in]  timestamp  CLOCK_MONOTONIC timestamp
+	 * @param[in]  direction  Bytes direction
+	 * @param[in]  bytes      The bytes
+	 */
+	void append(std::chrono::nanoseconds timestamp, Direction direction, ByteView bytes);
+};
+
+} // namespace capture
+} // namespace stream
+} // namespace stm
+
+#endif // TESEO_HAL_UTILS_CAPTURE_H
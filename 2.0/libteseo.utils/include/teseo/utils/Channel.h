@@ -30,8 +30,17 @@
 #define TESEO_HAL_THREAD_CHANNEL
 
 #include <type_traits>
-#include <queue>
-#include <list>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 
 #include "errors.h"
@@ -55,20 +64,44 @@
 namespace stm {
 namespace thread {
 
+/**
+ * @brief      Behavior of Channel::send() when the channel is full
+ */
+enum class FullPolicy {
+	BLOCK,       ///< Wait until a receiver makes room
+	DROP_NEWEST, ///< Discard the sent element
+	DROP_OLDEST  ///< Discard the oldest pending element to make room
+};
+
+/**
+ * Default channel capacity
+ */
+constexpr std::size_t CHANNEL_DEFAULT_CAPACITY = 256;
+
+/**
+ * Number of times a thread waiting on a channel yields before parking
+ */
+constexpr unsigned int CHANNEL_YIELDS_BEFORE_PARKING = 8;
+
 /**
  * @brief      Asynchronous typed data communication channel for threads
  * 
  * @details    This communication channel can be used to send data asynchronously from one thread to
- * another. This is a one to one communicaton channel. The sent data is stored in a FIFO list. If
- * there is no data in the FIFO, the reception is a blocking a operation.
- * Internally the channel use an anonymous pipe to send data.
- * 
- * If you want to send class instances through the channel you should only send pointer to instance.
- * Not the entire object, because the pipe buffer is limited and data bigger than this buffer is not
- * transmitted atomically.
+ * another. Any number of threads can send and receive, elements are received in FIFO order.
+ *
+ * The elements are stored in a bounded ring buffer allocated by the constructor, sending and
+ * receiving don't allocate. The capacity is rounded up to a power of two. Each slot holds a
+ * sequence number, senders and receivers claim slots with a compare and swap on their position,
+ * so the transfer itself is lock-free. The mutex and condition variables are only used to park a
+ * thread waiting for data (or for room with FullPolicy::BLOCK), and taken by the other side only
+ * when a thread is parked. Senders blocked on a full channel are woken up once a quarter of the
+ * channel is free, so they send a batch each time they run.
+ *
+ * A closed channel rejects new elements, receivers get the pending elements and then return
+ * without waiting.
  * 
  * The AbstractDecoder class is a good example on how to use a channel to send complex objects from
- * a thread to another.
+ * a thread to another: send shared pointers instead of big objects.
  *
  * @tparam     Tdata  Data type
  */
@@ -91,53 +124,443 @@ public:
 	using Tconst_lvalue_ref = typename
 		std::conditional<std::is_const<T>::value,        // If (T is const) add reference to T
 			typename std::add_lvalue_reference<T>::type, // else add const and reference to T
-			typename std::add_const<typename std::add_lvalue_reference<T>::type>::type>::type;
+			typename std::add_lvalue_reference<typename std::add_const<T>::type>::type>::type;
 
 	using Trvalue_ref = typename std::add_rvalue_reference<Tval>::type;
 	
 private:
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * Cells are cache line aligned, concurrent senders claiming consecutive positions don't write
+	 * to the same line
+	 */
+	struct alignas(64) Cell {
+		/**
+		 * Position of the next send in this cell when equal to its position, position + 1 when
+		 * the cell holds the element sent at this position
+		 */
+		std::atomic<std::size_t> sequence;
+
+		std::optional<Tval> value;
+	};
+
+	static std::size_t roundCapacity(std::size_t capacity)
+	{
+		std::size_t rounded = 2;
+
+		while(rounded < capacity)
+			rounded <<= 1;
+
+		return rounded;
+	}
+
 	std::string name; ///< Channel name
 
+	const FullPolicy policy;
+
+	const std::size_t mask;
+
+	std::unique_ptr<Cell[]> cells;
+
+	alignas(64) std::atomic<std::size_t> sendPosition;
+
+	alignas(64) std::atomic<std::size_t> receivePosition;
+
+	alignas(64) std::atomic<bool> closed;
+
+	// Read after each transfer, written only when a thread parks
+	std::atomic<unsigned int> parkedReceivers;
+
+	std::atomic<unsigned int> parkedSenders;
+
+	// Written on each drop, kept off the line read after each transfer
+	alignas(64) std::atomic<uint64_t> dropped;
+
 	std::mutex mutex;
-	std::condition_variable cond;
+	std::condition_variable notEmpty;
+	std::condition_variable notFull;
+
+	template<typename U>
+	bool tryPush(U && data)
+	{
+		std::size_t position = sendPosition.load(std::memory_order_relaxed);
+		Cell * cell;
+
+		for(;;)
+		{
+			cell = &cells[position & mask];
+			std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+			if(diff == 0)
+			{
+				if(sendPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if(diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = sendPosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->value.emplace(std::forward<U>(data));
+		cell->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool tryPop(Tlvalue_ref out)
+	{
+		std::size_t position = receivePosition.load(std::memory_order_relaxed);
+		Cell * cell;
+
+		for(;;)
+		{
+			cell = &cells[position & mask];
+			std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+			if(diff == 0)
+			{
+				if(receivePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if(diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = receivePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		out = std::move(*cell->value);
+		cell->value.reset();
+		cell->sequence.store(position + mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief      Wake a parked thread after a transfer
+	 *
+	 * @details    The fence pairs with the one in park(): either the parked thread sees the
+	 * transfer when it checks again, or this thread sees it parked. It must be called without
+	 * holding the mutex.
+	 */
+	void wake(std::atomic<unsigned int> & parked, std::condition_variable & cond, bool all = false)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if(parked.load(std::memory_order_relaxed) == 0)
+			return;
+
+		{ std::lock_guard<std::mutex> lock(mutex); }
+
+		if(all)
+			cond.notify_all();
+		else
+			cond.notify_one();
+	}
+
+	bool pushAndWake(Tconst_lvalue_ref data)
+	{
+		if(!tryPush(data))
+			return false;
+
+		wake(parkedReceivers, notEmpty);
+		return true;
+	}
+
+	bool pushAndWake(Trvalue_ref data)
+	{
+		if(!tryPush(std::move(data)))
+			return false;
+
+		wake(parkedReceivers, notEmpty);
+		return true;
+	}
+
+	/**
+	 * @brief      Wake the senders blocked on a full channel once a quarter of it is free
+	 *
+	 * @details    Waking a sender for each received element makes the threads switch for every
+	 * element when the receiver is faster.
+	 */
+	void wakeSenders()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if(parkedSenders.load(std::memory_order_relaxed) == 0)
+			return;
+
+		if(capacity() - size() < std::max<std::size_t>(capacity() / 4, 1))
+			return;
+
+		wake(parkedSenders, notFull, true);
+	}
+
+	bool popAndWake(Tlvalue_ref out)
+	{
+		if(!tryPop(out))
+			return false;
+
+		wakeSenders();
+		return true;
+	}
+
+	/**
+	 * @brief      Retry an operation, parking the thread until it succeeds
+	 *
+	 * @details    The caller wakes the other side on success, once the mutex is released.
+	 *
+	 * @param[in]  attempt   The operation, returns true on success
+	 * @param[in]  deadline  Time after which the operation fails, nullptr to wait forever
+	 *
+	 * @return     True on success, false on timeout or when the channel is closed
+	 */
+	template<typename Attempt>
+	bool park(
+		std::atomic<unsigned int> & parked,
+		std::condition_variable & cond,
+		Attempt attempt,
+		const Clock::time_point * deadline)
+	{
+		// Let the other side run a bit before parking, it is cheaper than a wake up
+		for(unsigned int i = 0; i < CHANNEL_YIELDS_BEFORE_PARKING; i++)
+		{
+			if(attempt())
+				return true;
+
+			std::this_thread::yield();
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		parked.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		bool success = false;
+
+		for(;;)
+		{
+			if(attempt())
+			{
+				success = true;
+				break;
+			}
+
+			if(closed.load(std::memory_order_acquire))
+				break;
+
+			if(deadline == nullptr)
+			{
+				cond.wait(lock);
+			}
+			else if(cond.wait_until(lock, *deadline) == std::cv_status::timeout)
+			{
+				success = attempt();
+				break;
+			}
+		}
+
+		parked.fetch_sub(1, std::memory_order_relaxed);
+		return success;
+	}
+
+	bool popWait(Tlvalue_ref out, const Clock::time_point * deadline)
+	{
+		if(!park(parkedReceivers, notEmpty, [this, &out] { return this->tryPop(out); }, deadline))
+			return false;
+
+		wakeSenders();
+		return true;
+	}
+
+	template<typename U>
+	bool push(U && data)
+	{
+		if(closed.load(std::memory_order_acquire))
+		{
+			CHANNEL_LOGW("%s: send on a closed channel", name.c_str());
+			return false;
+		}
+
+		switch(policy)
+		{
+			case FullPolicy::BLOCK:
+				// Moving from data only happens once the push succeeded
+				if(!park(parkedSenders, notFull,
+					[this, &data] { return this->tryPush(std::forward<U>(data)); }, nullptr))
+					return false;
+
+				break;
 
-	std::queue<T, std::list<T>> queue;
+			case FullPolicy::DROP_NEWEST:
+				if(!tryPush(std::forward<U>(data)))
+				{
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+
+				break;
+
+			case FullPolicy::DROP_OLDEST:
+				while(!tryPush(std::forward<U>(data)))
+				{
+					Tval oldest;
+
+					if(tryPop(oldest))
+						dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				break;
+		}
+
+		wake(parkedReceivers, notEmpty);
+		return true;
+	}
+
+	std::size_t drain(std::vector<Tval> & out, std::size_t max)
+	{
+		std::size_t count = 0;
+		Tval data;
+
+		while(count < max && tryPop(data))
+		{
+			out.push_back(std::move(data));
+			count++;
+		}
+
+		if(count > 0)
+			wakeSenders();
+
+		return count;
+	}
 
 public:
 
-	Channel(const char * name) :
-		name(name)
-	{ }
+	/**
+	 * @brief      Create a channel
+	 *
+	 * @param[in]  name      Channel name
+	 * @param[in]  capacity  Maximum number of pending elements, rounded up to a power of two
+	 * @param[in]  policy    Behavior of send() when the channel is full
+	 */
+	Channel(
+		const char * name,
+		std::size_t capacity = CHANNEL_DEFAULT_CAPACITY,
+		FullPolicy policy = FullPolicy::BLOCK) :
+		name(name),
+		policy(policy),
+		mask(roundCapacity(capacity) - 1),
+		cells(new Cell[mask + 1]),
+		sendPosition(0),
+		receivePosition(0),
+		closed(false),
+		parkedReceivers(0),
+		parkedSenders(0),
+		dropped(0)
+	{
+		for(std::size_t i = 0; i <= mask; i++)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
 
+	std::size_t capacity() const
+	{
+		return mask + 1;
+	}
+
+	/**
+	 * @brief      Number of pending elements
+	 *
+	 * @details    Exact when no other thread is using the channel, a snapshot otherwise.
+	 */
 	std::size_t size() const
 	{
-		return queue.size();
+		std::size_t received = receivePosition.load(std::memory_order_acquire);
+		std::size_t sent = sendPosition.load(std::memory_order_acquire);
+
+		return std::min(sent - received, capacity());
+	}
+
+	/**
+	 * @brief      Number of elements dropped because the channel was full
+	 */
+	uint64_t droppedCount() const
+	{
+		return dropped.load(std::memory_order_relaxed);
 	}
 
 	void clear()
 	{
-		std::unique_lock<std::mutex> lock(mutex);
-		while(!queue.empty()) queue.pop();
+		Tval data;
+		bool cleared = false;
+
+		while(tryPop(data))
+			cleared = true;
+
+		if(cleared)
+			wakeSenders();
 	}
 
 	/**
-	 * @brief      Send data in the channel
+	 * @brief      Close the channel
 	 *
-	 * @param[in]  data  Data to send
+	 * @details    Following sends fail, and threads waiting on the channel wake up. Receivers get
+	 * the pending elements, then stop waiting.
 	 */
-	void send(Tconst_lvalue_ref data)
+	void close()
 	{
 		{
-			std::unique_lock<std::mutex> lock(mutex);
-			queue.push(data);
+			std::lock_guard<std::mutex> lock(mutex);
+			closed.store(true, std::memory_order_release);
 		}
 
-		cond.notify_one();
+		notEmpty.notify_all();
+		notFull.notify_all();
 	}
 
-	void send(Trvalue_ref data)
+	bool isClosed() const
 	{
-		send(data);
+		return closed.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief      Send data in the channel
+	 *
+	 * @details    When the channel is full, the behavior depends on the channel FullPolicy.
+	 *
+	 * @param[in]  data  Data to send
+	 *
+	 * @return     True if the data was queued, false if it was dropped or the channel is closed
+	 */
+	bool send(Tconst_lvalue_ref data)
+	{
+		return push(data);
+	}
+
+	bool send(Trvalue_ref data)
+	{
+		return push(std::move(data));
+	}
+
+	/**
+	 * @brief      Send data in the channel if there is room, without waiting
+	 *
+	 * @return     True if the data was queued, false if the channel is full or closed
+	 */
+	bool trySend(Tconst_lvalue_ref data)
+	{
+		return !closed.load(std::memory_order_acquire) && pushAndWake(data);
+	}
+
+	bool trySend(Trvalue_ref data)
+	{
+		return !closed.load(std::memory_order_acquire) && pushAndWake(std::move(data));
 	}
 
 	/**
@@ -146,19 +569,105 @@ public:
 	 * @details    If the channel is empty this method block the current thread until data is
 	 * available.
 	 *
-	 * @return     Data received
+	 * @return     Data received, a default constructed value if the channel is closed and empty
 	 */
 	T receive()
 	{
-		std::unique_lock<std::mutex> lock(mutex);
+		Tval data{};
+		popWait(data, nullptr);
+		return data;
+	}
+
+	/**
+	 * @brief      Receive data from the channel, waiting until data is available
+	 *
+	 * @param      out   Data received
+	 *
+	 * @return     True if data was received, false if the channel is closed and empty
+	 */
+	bool receive(Tlvalue_ref out)
+	{
+		return popWait(out, nullptr);
+	}
 
-		if(queue.empty())
-			cond.wait(lock, [this] { return !this->queue.empty(); });
+	/**
+	 * @brief      Receive data from the channel, waiting at most `timeout`
+	 *
+	 * @param      out      Data received
+	 * @param[in]  timeout  Maximum time to wait for data, zero or negative to only poll
+	 *
+	 * @return     True if data was received, false on timeout or if the channel is closed and empty
+	 */
+	template<class Rep, class Period>
+	bool receive(Tlvalue_ref out, const std::chrono::duration<Rep, Period> & timeout)
+	{
+		if(timeout <= timeout.zero())
+			return popAndWake(out);
 
-		T data = queue.front();
-		queue.pop();
+		const Clock::time_point deadline =
+			Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout);
 
-		return data;
+		return popWait(out, &deadline);
+	}
+
+	/**
+	 * @brief      Receive data from the channel if there is any, without waiting
+	 */
+	bool tryReceive(Tlvalue_ref out)
+	{
+		return popAndWake(out);
+	}
+
+	/**
+	 * @brief      Receive all pending data from the channel
+	 *
+	 * @details    If the channel is empty this method block the current thread until data is
+	 * available, then it moves up to `max` pending elements to `out`.
+	 *
+	 * @param      out   Vector receiving the data, elements are appended
+	 * @param[in]  max   Maximum number of elements to receive
+	 *
+	 * @return     Number of elements received, zero if the channel is closed and empty
+	 */
+	std::size_t receiveMany(std::vector<Tval> & out, std::size_t max = static_cast<std::size_t>(-1))
+	{
+		if(max == 0)
+			return 0;
+
+		Tval first;
+
+		if(!popWait(first, nullptr))
+			return 0;
+
+		out.push_back(std::move(first));
+		return 1 + drain(out, max - 1);
+	}
+
+	/**
+	 * @brief      Receive all pending data from the channel, waiting at most `timeout`
+	 *
+	 * @param      out      Vector receiving the data, elements are appended
+	 * @param[in]  timeout  Maximum time to wait for data, zero or negative to only poll
+	 * @param[in]  max      Maximum number of elements to receive
+	 *
+	 * @return     Number of elements received, zero on timeout
+	 */
+	template<class Rep, class Period>
+	std::size_t receiveMany(
+		std::vector<Tval> & out,
+		const std::chrono::duration<Rep, Period> & timeout,
+		std::size_t max = static_cast<std::size_t>(-1))
+	{
+		if(max == 0)
+			return 0;
+
+		Tval first;
+
+		if(!receive(first, timeout))
+			return 0;
+
+		out.push_back(std::move(first));
+		return 1 + drain(out, max - 1);
 	}
 
 	Channel & operator << (Tconst_lvalue_ref data)
@@ -169,7 +678,7 @@ public:
 
 	Channel & operator << (Trvalue_ref data)
 	{
-		send(data);
+		send(std::move(data));
 		return *this;
 	}
 
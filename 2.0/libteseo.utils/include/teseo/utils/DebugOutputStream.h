@@ -25,12 +25,12 @@
 
 #include <list>
 #include <memory>
+#include <mutex>
 #include <netinet/in.h>
 #include <cstdint>
 
 #include "Signal.h"
-#include "Thread.h"
-#include "Channel.h"
+#include "EventLoop.h"
 #include "ByteVector.h"
 
 namespace stm::debug {
@@ -50,67 +50,74 @@ public:
 	void close();
 };
 
-class TcpServerSocket : public Thread {
+/**
+ * @brief      TCP server socket, clients are accepted from the event loop thread
+ */
+class TcpServerSocket {
 private:
 	uint16_t port;
 	int sockfd;
 	sockaddr_in addr;
-
-	std::list<std::weak_ptr<TcpClientSocket>> clients;
+	thread::EventLoop & loop;
 
 	bool open();
 
 	void close();
 
-protected:
-	virtual void run();
+	void accept();
 
 public:
-	TcpServerSocket(uint16_t port);
+	TcpServerSocket(uint16_t port, thread::EventLoop & loop);
 
 	virtual ~TcpServerSocket();
 
 	Signal<void, std::shared_ptr<TcpClientSocket>> newClient;
 
+	/**
+	 * @brief      Open the socket and watch it for new clients
+	 *
+	 * @return     true on success, false otherwise
+	 */
+	bool start();
+
 	int stop();
 };
 #endif
 
-#ifdef ENABLE_DEBUG_OUTPUT_STREAM
-class DebugOutputStream : public Thread
-#else
+/**
+ * @brief      Debug output stream, sends data to TCP clients
+ *
+ * @details    The stream doesn't own a thread: the messages are written to the clients from the
+ * event loop thread. Client sockets are non-blocking: a message that a slow client can't take is
+ * dropped, and a client that only takes part of a message is disconnected.
+ */
 class DebugOutputStream
-#endif
 {
 private:
 // If debug output stream isn't enabled all private stuff won't be compiled
 #ifdef ENABLE_DEBUG_OUTPUT_STREAM
-	enum Control : uint8_t {
-		APPEND = 0,
-		CLEAR  = 1,
-		SEND   = 2,
-		STOP   = 3
-	};
-
-	struct Message {
-		Control command;
-		uint8_t data;
+	/**
+	 * Connected clients, shared with the tasks posted to the event loop
+	 */
+	struct Clients {
+		std::mutex mutex;
+		std::list<std::shared_ptr<TcpClientSocket>> list;
 	};
 
+	thread::EventLoop & loop;
 	TcpServerSocket socket;
-	std::list<std::shared_ptr<TcpClientSocket>> clients;
-
-	thread::Channel<Message> com;
+	std::shared_ptr<Clients> clients;
 
-protected:
-	void run();
+	void post(ByteVectorPtr message);
 #endif
 
 public:
-	DebugOutputStream(uint16_t port);
+	DebugOutputStream(uint16_t port, thread::EventLoop & loop);
 
 	virtual ~DebugOutputStream();
 
+	int start();
+
 	int stop();
 
 	void send(const char * data, std::size_t count);
@@ -121,31 +128,13 @@ public:
 
 	void send(const std::string & data);
 
-#ifdef ENABLE_DEBUG_OUTPUT_STREAM
 	template<std::size_t N>
 	void send(const char (&data)[N])
 	{
-		for(std::size_t i = 0; i < N; i++)
-		{
-			com << Message { Control::APPEND, data[i] };
-		}
-
-		com << Message { Control::SEND, 0 };
-		com << Message { Control::CLEAR, 0 };
+		send(data, N);
 	}
-#else
-	template<std::size_t N>
-	void send(const char (&)[N])
-	{ }
-
-	int start();
-
-	void join();
-
-	bool isRunning() const;
-#endif
 };
 
 } // namespace stm::debug
 
-#endif // TESEO_HAL_UTILS_DEBUG_OUTPUT_STREAM_H
\ No newline at end of file
+#endif // TESEO_HAL_UTILS_DEBUG_OUTPUT_STREAM_H
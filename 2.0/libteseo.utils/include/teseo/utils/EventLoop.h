@@ -0,0 +1,281 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Event loop and worker pool shared by the HAL components
+ * @file EventLoop.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_THREAD_EVENT_LOOP_H
+#define TESEO_HAL_THREAD_EVENT_LOOP_H
+
+#include <sys/epoll.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Channel.h"
+#include "Thread.h"
+
+namespace stm {
+namespace thread {
+
+/**
+ * @brief      Scheduling latency statistics
+ */
+struct LatencyStats {
+	uint64_t count;                ///< Number of measured runs
+	std::chrono::nanoseconds total; ///< Sum of the latencies
+	std::chrono::nanoseconds max;   ///< Highest latency
+
+	void add(std::chrono::nanoseconds latency);
+
+	std::chrono::nanoseconds mean() const;
+};
+
+/**
+ * @brief      Single thread event loop, with a worker pool for blocking jobs
+ *
+ * @details    The loop thread waits in epoll_wait for:
+ * - the file descriptors registered with watch(), the callback is called when they are ready;
+ * - the timers created with addTimer(), each one is a timerfd;
+ * - the tasks queued with post(), an eventfd wakes the loop up.
+ *
+ * Callbacks, timers and tasks run on the loop thread, they must not block. Blocking jobs, like
+ * binder calls or HTTP requests, are queued with submit() and run by the workers. Components
+ * register with the loop instead of owning a thread, so the HAL runs fewer threads and the
+ * scheduling latency of all of them is measured in one place, see stats().
+ *
+ * The workers are started and stopped by the loop thread. The loop can be started again after it
+ * stopped.
+ */
+class EventLoop : public Thread {
+public:
+	using Task = std::function<void ()>;
+
+	using FdCallback = std::function<void (uint32_t events)>;
+
+	/**
+	 * Timer identifier, -1 is invalid
+	 */
+	using TimerId = int;
+
+	struct Stats {
+		LatencyStats tasks;  ///< Delay between post() and the run of the task
+		LatencyStats timers; ///< Delay between the timer expiration and the run of its callback
+		LatencyStats jobs;   ///< Delay between submit() and the start of the job
+	};
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct PostedTask {
+		Task task;
+		Clock::time_point posted;
+	};
+
+	/**
+	 * Watched file descriptor or timer
+	 */
+	struct Registration {
+		FdCallback callback;
+		bool timer;
+		Clock::duration period;   ///< Timer period, zero for a one shot timer
+		Clock::time_point expiry; ///< Next timer expiration
+	};
+
+	class Worker : public Thread {
+	private:
+		EventLoop & loop;
+
+	protected:
+		virtual void run();
+
+	public:
+		Worker(EventLoop & loop, const char * name);
+
+		virtual int stop();
+	};
+
+	std::string loopName;
+
+	std::string workerName;
+
+	int epollFd;
+
+	int wakeupFd;
+
+	mutable std::mutex mutex;
+
+	std::condition_variable dispatched;
+
+	bool active;
+
+	bool stopRequested;
+
+	std::atomic<std::thread::id> loopThread;
+
+	std::vector<PostedTask> posted;
+
+	/**
+	 * Tasks being run, only used by the loop thread
+	 */
+	std::vector<PostedTask> running;
+
+	std::map<int, std::shared_ptr<Registration>> registrations;
+
+	/**
+	 * File descriptor whose callback is running on the loop thread, -1 if none
+	 */
+	int dispatchingFd;
+
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	/**
+	 * Jobs for the workers, an empty job stops a worker
+	 */
+	Channel<PostedTask> jobs;
+
+	mutable std::mutex statsMutex;
+
+	Stats statistics;
+
+	void wakeup();
+
+	bool addRegistration(int fd, uint32_t events, const std::shared_ptr<Registration> & registration);
+
+	void runPosted();
+
+	void dispatch(int fd, uint32_t events);
+
+	void record(LatencyStats Stats::* stats, Clock::time_point expected);
+
+	void startWorkers();
+
+	void stopWorkers();
+
+protected:
+	virtual void run();
+
+public:
+	/**
+	 * @brief      Create an event loop
+	 *
+	 * @param[in]  name     The loop thread name, the workers are named "<name>-worker"
+	 * @param[in]  workers  Number of worker threads, at least one is created
+	 */
+	EventLoop(const char * name, std::size_t workers = 2);
+
+	virtual ~EventLoop();
+
+	/**
+	 * @brief      Check if the loop runs the tasks and jobs
+	 */
+	bool isActive() const;
+
+	/**
+	 * @brief      Check if the caller runs on the loop thread
+	 */
+	bool isLoopThread() const;
+
+	/**
+	 * @brief      Run a task on the loop thread
+	 *
+	 * @return     False if the loop isn't active, the task is dropped
+	 */
+	bool post(Task task);
+
+	/**
+	 * @brief      Run a blocking job on a worker thread
+	 *
+	 * @details    The job queue is bounded, the caller waits when it is full.
+	 *
+	 * @return     False if the loop isn't active, the job is dropped
+	 */
+	bool submit(Task job);
+
+	/**
+	 * @brief      Call a callback from the loop thread when a file descriptor is ready
+	 *
+	 * @param[in]  fd        The file descriptor, a single callback can be registered for it
+	 * @param[in]  events    The epoll events to wait for (EPOLLIN, EPOLLOUT...)
+	 * @param[in]  callback  The callback, called with the ready events
+	 *
+	 * @return     True on success
+	 */
+	bool watch(int fd, uint32_t events, FdCallback callback);
+
+	/**
+	 * @brief      Stop watching a file descriptor
+	 *
+	 * @details    When called from another thread, it waits for the end of a running callback of
+	 * the file descriptor, so the callback resources can be released afterwards.
+	 */
+	void unwatch(int fd);
+
+	/**
+	 * @brief      Call a callback from the loop thread after a delay
+	 *
+	 * @param[in]  delay     Delay before the first call
+	 * @param[in]  period    Period of the next calls, zero to call it once
+	 * @param[in]  callback  The callback
+	 *
+	 * @return     The timer identifier, -1 on error
+	 */
+	TimerId addTimer(
+		std::chrono::milliseconds delay,
+		std::chrono::milliseconds period,
+		Task callback);
+
+	/**
+	 * @brief      Cancel a timer, with the same guarantee as unwatch()
+	 */
+	void cancelTimer(TimerId timer);
+
+	/**
+	 * @brief      Get the scheduling latency statistics
+	 */
+	Stats stats() const;
+
+	/**
+	 * @brief      Stop the loop and its workers, after the run of the pending tasks and jobs
+	 *
+	 * @return     0 on success, -1 if the loop isn't running
+	 */
+	virtual int stop();
+};
+
+} // namespace thread
+} // namespace stm
+
+#endif // TESEO_HAL_THREAD_EVENT_LOOP_H
@@ -0,0 +1,382 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Queued signal connections, delivered by an executor
+ * @file Executor.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_THREAD_EXECUTOR_H
+#define TESEO_HAL_THREAD_EXECUTOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "EventLoop.h"
+#include "optional.h"
+#include "Signal.h"
+
+namespace stm {
+namespace thread {
+
+/**
+ * @brief      Behavior of a queued connection when its queue is full
+ */
+enum class QueuePolicy {
+	COALESCE,    ///< Only keep the latest call, the queue holds a single call
+	DROP_OLDEST, ///< Drop the oldest pending call
+	NEVER_DROP   ///< Block the emitting thread until the executor makes room
+};
+
+/**
+ * @brief      Pending calls of a queued connection
+ */
+class Delivery {
+public:
+	virtual ~Delivery() { }
+
+	/**
+	 * @brief      Deliver pending calls
+	 *
+	 * @return     True if calls are still pending, the delivery must be scheduled again
+	 */
+	virtual bool deliver() = 0;
+
+protected:
+	/**
+	 * @brief      Log the exception thrown by a delivered slot, the call is lost
+	 */
+	static void slotFailed(const std::exception & ex);
+};
+
+/**
+ * @brief      Interface of the objects delivering the calls of queued connections
+ */
+class IExecutor {
+public:
+	virtual ~IExecutor() { }
+
+	/**
+	 * @brief      Schedule the delivery of a connection
+	 *
+	 * @return     False if the executor isn't active, the caller must deliver the calls itself
+	 */
+	virtual bool schedule(const std::shared_ptr<Delivery> & delivery) = 0;
+};
+
+/**
+ * @brief      Executor delivering the calls of queued connections on the workers of an event loop
+ *
+ * @details    A queued connection stores the call arguments and schedules itself on the strand,
+ * a worker then calls the connected slot. Slow slots, like binder callbacks, don't block the
+ * emitting thread anymore.
+ *
+ * The strand delivers its connections one at a time, in scheduling order, from a job
+ * of the event loop workers: the calls of a strand never run concurrently, but several strands
+ * share the workers. It is active between activate() and deactivate(), inactive strands let the
+ * emitting thread deliver the calls. The calls scheduled before deactivate() are still delivered
+ * by the workers, and so are the calls emitted until they are all delivered: a call emitted after
+ * deactivate() never runs before, or concurrently with, a call emitted earlier.
+ */
+class Strand :
+	public IExecutor,
+	public Trackable
+{
+private:
+	std::string strandName;
+
+	EventLoop & loop;
+
+	mutable std::mutex mutex;
+
+	std::condition_variable idle;
+
+	/**
+	 * Connections with pending calls
+	 */
+	std::vector<std::shared_ptr<Delivery>> ready;
+
+	/**
+	 * Connections being delivered, only used by the draining job
+	 */
+	std::vector<std::shared_ptr<Delivery>> delivering;
+
+	bool active;
+
+	/**
+	 * A worker job is delivering the ready connections
+	 */
+	bool draining;
+
+	/**
+	 * @brief      Deliver the ready connections until there is none, runs on a worker
+	 */
+	void drain();
+
+	/**
+	 * @brief      Submit the draining job, with the mutex held
+	 *
+	 * @return     False if the event loop isn't active
+	 */
+	bool submitDrain();
+
+public:
+	/**
+	 * @brief      Create a strand
+	 *
+	 * @param[in]  name         The strand name, used in logs
+	 * @param[in]  loop         The event loop running the strand, must outlive it
+	 * @param[in]  connections  Number of connections scheduled without allocation
+	 */
+	Strand(const char * name, EventLoop & loop, std::size_t connections = 16);
+
+	virtual ~Strand();
+
+	virtual bool schedule(const std::shared_ptr<Delivery> & delivery);
+
+	bool isActive() const;
+
+	/**
+	 * @brief      Deliver the next calls on the event loop workers
+	 *
+	 * @return     0
+	 */
+	int activate();
+
+	/**
+	 * @brief      Deliver the next calls on the emitting thread, once the pending calls are delivered
+	 *
+	 * @details    It doesn't wait for the delivery of the pending calls, see waitIdle().
+	 *
+	 * @return     0
+	 */
+	int deactivate();
+
+	/**
+	 * @brief      Wait for the delivery of the pending calls
+	 *
+	 * @details    It must not be called from a slot delivered by the strand.
+	 */
+	void waitIdle();
+};
+
+/**
+ * @brief      Slot queuing its calls to an executor
+ *
+ * @details    The arguments are copied in a bounded queue, allocated when the connection is created,
+ * then the executor calls the target slot with them. Reference arguments are copied too, so they
+ * must be const references. When the queue is full the connection policy decides which call is
+ * lost, if any.
+ *
+ * With the NEVER_DROP policy the emitting thread waits for room in the queue: a slot running on
+ * an executor must not emit to a full NEVER_DROP connection of the same executor.
+ *
+ * @tparam     Targs  Slot argument list
+ */
+template <typename ...Targs>
+class QueuedSlot :
+	public GenericSlot<void (Targs...)>,
+	public Delivery,
+	public std::enable_shared_from_this<QueuedSlot<Targs...>>
+{
+public:
+	using Target = typename GenericSlot<void (Targs...)>::ptr;
+
+	static_assert(((!std::is_lvalue_reference<Targs>::value ||
+	                std::is_const<typename std::remove_reference<Targs>::type>::value) && ...),
+		"Queued slots can't take non-const reference arguments");
+
+private:
+	using Arguments = std::tuple<typename std::decay<Targs>::type...>;
+
+	IExecutor & executor;
+
+	Target target;
+
+	QueuePolicy policy;
+
+	std::mutex mutex;
+
+	std::condition_variable space;
+
+	std::vector<std::optional<Arguments>> pending;
+
+	std::size_t head;
+
+	std::size_t count;
+
+	bool scheduled;
+
+	uint64_t droppedCalls;
+
+public:
+	QueuedSlot(IExecutor & e, const Target & t, QueuePolicy p, std::size_t capacity) :
+		executor(e),
+		target(t),
+		policy(p),
+		pending(p == QueuePolicy::COALESCE || capacity == 0 ? 1 : capacity),
+		head(0),
+		count(0),
+		scheduled(false),
+		droppedCalls(0)
+	{ }
+
+	/**
+	 * @brief      Queue a call
+	 */
+	void call(Targs... args)
+	{
+		bool mustSchedule;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			if(count == pending.size())
+			{
+				if(policy == QueuePolicy::NEVER_DROP)
+				{
+					space.wait(lock, [this] { return count < pending.size(); });
+				}
+				else
+				{
+					pending[head].reset();
+					head = (head + 1) % pending.size();
+					count--;
+					droppedCalls++;
+				}
+			}
+
+			pending[(head + count) % pending.size()].emplace(args...);
+			count++;
+
+			mustSchedule = !scheduled;
+			scheduled = true;
+		}
+
+		if(mustSchedule && !executor.schedule(this->shared_from_this()))
+		{
+			// The executor isn't running, deliver on the emitting thread
+			while(deliver())
+			{ }
+		}
+	}
+
+	bool deliver()
+	{
+		for(std::size_t i = 0; i < pending.size(); i++)
+		{
+			std::optional<Arguments> args;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if(count == 0)
+				{
+					scheduled = false;
+					return false;
+				}
+
+				// Constructed in place, the arguments may not be assignable
+				args.emplace(std::move(*pending[head]));
+				pending[head].reset();
+				head = (head + 1) % pending.size();
+				count--;
+			}
+
+			space.notify_one();
+
+			// The queue must be settled whatever the slot does, or the connection never delivers again
+			try
+			{
+				if(target->isValid())
+					std::apply([this](const auto & ...a) { target->call(a...); }, *args);
+			}
+			catch(const std::exception & ex)
+			{
+				slotFailed(ex);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		scheduled = count != 0;
+
+		return scheduled;
+	}
+
+	/**
+	 * @brief      The queued slot stays valid while its target is
+	 */
+	virtual bool isValid()
+	{
+		return target->isValid();
+	}
+
+	/**
+	 * @brief      Number of calls dropped because the queue was full
+	 */
+	uint64_t dropped()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return droppedCalls;
+	}
+};
+
+} // namespace thread
+} // namespace stm
+
+namespace SlotFactory
+{
+	/**
+	 * @brief      Create a queued slot, calling a slot from an executor
+	 *
+	 * @param[in]  executor  The executor calling the slot, must outlive the connection
+	 * @param[in]  slot      The slot to call
+	 * @param[in]  policy    Behavior when the queue is full
+	 * @param[in]  capacity  Number of calls the queue holds, ignored for COALESCE
+	 *
+	 * @tparam     Targs     The slot arguments types
+	 *
+	 * @return     The created slot object
+	 */
+	template<typename ...Targs>
+	auto queued(
+		stm::thread::IExecutor & executor,
+		const std::shared_ptr<GenericSlot<void (Targs...)>> & slot,
+		stm::thread::QueuePolicy policy = stm::thread::QueuePolicy::NEVER_DROP,
+		std::size_t capacity = 16)
+	{
+		return typename GenericSlot<void (Targs...)>::ptr(
+			new stm::thread::QueuedSlot<Targs...>(executor, slot, policy, capacity));
+	}
+}
+
+#endif // TESEO_HAL_THREAD_EXECUTOR_H
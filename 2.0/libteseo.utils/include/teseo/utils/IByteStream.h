@@ -22,9 +22,11 @@
 #ifndef TESEO_HAL_UTILS_IBYTESTREAM_H
 #define TESEO_HAL_UTILS_IBYTESTREAM_H
 
+#include <atomic>
 #include <stdexcept>
 #include "Signal.h"
 #include "ByteVector.h"
+#include "ByteView.h"
 #include "Thread.h"
 #include "Channel.h"
 
@@ -37,6 +39,14 @@ enum class ByteStreamStatus {
 	ERROR
 };
 
+/**
+ * Outgoing message priority class
+ */
+enum class WriteLane {
+	CONTROL, ///< Short commands, written as soon as possible
+	BULK     ///< Assistance data uploads, paced against the line speed
+};
+
 
 class StreamException : public std::exception
 {
@@ -143,11 +153,29 @@ protected:
 	/**
 	 * Read data from device
 	 *
-	 * @return Vector of bytes read
+	 * @return View over the bytes read, owned by the stream. The view stays valid at least until
+	 * the next call to perform_read.
 	 */
-	virtual ByteVector perform_read() noexcept(false)  = 0;
+	virtual ByteView perform_read() noexcept(false)  = 0;
 
-	virtual void perform_write(const ByteVectorPtr bytes) noexcept(false) = 0;
+	/**
+	 * Write a batch of messages to device
+	 *
+	 * @details The messages must be written in order and completely, partial writes must be
+	 * resumed until every byte is written or an error occurs.
+	 *
+	 * @param messages Messages to write
+	 */
+	virtual void perform_write(const std::vector<ByteVectorPtr> & messages) noexcept(false) = 0;
+
+	/**
+	 * @brief Wake up a reader blocked in perform_read
+	 *
+	 * @details Called by the reader thread stop request. Streams whose perform_read blocks
+	 * until data is available must override this method so that perform_read returns
+	 * immediately (with an empty view) instead of waiting for the next incoming byte.
+	 */
+	virtual void wakeup() noexcept { }
 
 public:
 	virtual ~IByteStream() { }
@@ -164,6 +192,30 @@ public:
 	 */
 	virtual ByteStreamStatus status() const = 0;
 
+	/**
+	 * @brief Get the line speed in bauds used to pace bulk writes
+	 *
+	 * @return The line speed, or 0 if the stream has no line speed (bulk writes aren't paced)
+	 */
+	virtual unsigned int baudrate() const { return 0; }
+
+	/**
+	 * @brief Change the line speed of an opened stream
+	 *
+	 * @details Pending output is transmitted at the current speed before the switch, pending
+	 * input is discarded.
+	 *
+	 * @param speed The new line speed in bauds
+	 *
+	 * @return True on success, false if the stream doesn't support this speed
+	 */
+	virtual bool setBaudrate(unsigned int speed) { (void)(speed); return false; }
+
+	/**
+	 * @brief Get the number of bytes read since the stream creation
+	 */
+	virtual uint64_t rxByteCount() const { return 0; }
+
 	/**
 	 * Write data to device
 	 *
@@ -194,8 +246,11 @@ public:
 
 	/**
 	 * New bytes signal
+	 *
+	 * @details The view references the stream receive buffer, slots must copy the bytes they
+	 * want to keep after returning.
 	 */
-	Signal<void, const ByteVector &> newBytes;
+	Signal<void, ByteView> newBytes;
 };
 
 namespace __private_ByteStreamOpenerLog {
@@ -276,29 +331,42 @@ protected:
 
 	IByteStream & byteStream;
 
-	bool runReader;
+	std::atomic<bool> runReader;
 
 public:
 	ByteStreamReader(IByteStream & bs);
 
+	/**
+	 * @brief      Start the reader thread
+	 *
+	 * @details    The run flag is set before the thread is created, so a stop() requested while
+	 * the stream opens isn't lost.
+	 *
+	 * @return     0 on success, 1 on failure
+	 */
+	int start();
+
 	int stop();
 };
 
+/**
+ * @brief      Byte stream writer thread
+ *
+ * @details    Messages are sorted in two lanes. CONTROL messages are written first, as soon as
+ * they are queued. BULK messages are written one at a time when the line is expected to be idle,
+ * the expected busy time being computed from the bytes already written and the stream baudrate.
+ * This way a burst of assistance data never floods the chip input buffer nor delays commands.
+ */
 class ByteStreamWriter : public Thread {
-private:
-	enum Commands {
-		WRITE,
-		STOP
-	};
-
 protected:
 	void run();
 
 	IByteStream & byteStream;
 
-	thread::Channel<Commands> com;
-
-	thread::Channel<const ByteVectorPtr> dataChannel;
+	/**
+	 * Outgoing messages, a null pointer requests the writer to stop
+	 */
+	thread::Channel<ByteVectorPtr> queue;
 
 public:
 	ByteStreamWriter(IByteStream & bs);
@@ -306,6 +374,16 @@ public:
 	int stop();
 
 	void write(const ByteVectorPtr bytes);
+
+	/**
+	 * @brief      Get the lane of an outgoing NMEA message
+	 *
+	 * @details    Ephemeris, almanac and satellite seed uploads are BULK, everything else is
+	 * CONTROL.
+	 *
+	 * @param[in]  bytes  The message, starting with '$'
+	 */
+	static WriteLane laneOf(const ByteVector & bytes);
 };
 
 class AbstractByteStream : public IByteStream {
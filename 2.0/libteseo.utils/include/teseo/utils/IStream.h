@@ -34,6 +34,7 @@
 
 #include <teseo/utils/Signal.h>
 #include <teseo/utils/ByteVector.h>
+#include <teseo/utils/ByteView.h>
 
 namespace stm {
 namespace stream {
@@ -55,7 +56,12 @@ public:
 
 	virtual ~IStream() { }
 
-	virtual void onNewBytes(const ByteVector & bytes) = 0;
+	/**
+	 * @brief      Process bytes received from the byte stream
+	 *
+	 * @param[in]  bytes  View over the received bytes, only valid during the call
+	 */
+	virtual void onNewBytes(ByteView bytes) = 0;
 
 	/**
 	 * Signal emitted when new bytes are available
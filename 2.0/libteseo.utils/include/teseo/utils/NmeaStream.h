@@ -36,24 +36,65 @@
 
 #include "IStream.h"
 #include "IByteStream.h"
+#include "BufferPool.h"
 
 namespace stm {
 namespace stream {
 
+/**
+ * @brief      Maximal NMEA sentence size accepted by the stream, in bytes
+ */
+#define NMEA_STREAM_MAX_SENTENCE_SIZE 1024
+
 /**
  * @brief      NMEA Stream reader/writer
+ *
+ * @details    The received bytes are framed in a single pass: the scan looks for the sentence
+ * delimiters a machine word at a time and computes the XOR checksum on the way. Only complete
+ * sentences with a valid checksum are emitted, as `$<body>*<checksum>` without line ending, in
+ * buffers taken from a pool.
  */
 class NmeaStream :
 	public IStream,
 	public Trackable
 {
+public:
+	/**
+	 * @brief      Framing statistics
+	 */
+	struct Stats {
+		uint64_t sentences; ///< Sentences emitted
+		uint64_t checksumErrors; ///< Sentences dropped because of a checksum mismatch
+		uint64_t malformed; ///< Sentences dropped because truncated, without checksum or too long
+	};
+
 private:
-	ByteVector buffer;
+	enum class FrameState {
+		SEARCH, ///< Looking for a '$'
+		BODY, ///< Between '$' and '*'
+		CHECKSUM_HIGH, ///< Expecting the first checksum digit
+		CHECKSUM_LOW ///< Expecting the second checksum digit
+	};
+
+	FrameState state;
+
+	/**
+	 * Sentence being received
+	 */
+	ByteVectorPtr sentence;
 
 	/**
-	 * Reading task running flag. Set to false to request task stop.
+	 * Checksum of the sentence body received so far
 	 */
-	bool continueReading;
+	uint8_t checksum;
+
+	BufferPool pool;
+
+	Stats frameStats;
+
+	void startSentence();
+
+	void dropSentence(uint64_t & counter);
 
 public:
 	/**
@@ -68,7 +109,12 @@ public:
 	 */
 	virtual ~NmeaStream();
 
-	virtual void onNewBytes(const ByteVector & bytes);
+	virtual void onNewBytes(ByteView bytes);
+
+	/**
+	 * @brief      Get the framing statistics
+	 */
+	const Stats & stats() const;
 
 	/**
 	 * @brief      Write data to the NMEA stream
@@ -0,0 +1,153 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief NMEA numeric field parsers
+ * @file NumberParser.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_UTILS_NUMBER_PARSER_H
+#define TESEO_HAL_UTILS_NUMBER_PARSER_H
+
+#include <cstdint>
+
+namespace stm {
+namespace utils {
+
+/**
+ * @brief      Numeric field parser status
+ */
+enum class ParseStatus {
+	OK,       ///< The value has been parsed
+	EMPTY,    ///< The field is empty, no value is available
+	INVALID,  ///< The field contains unexpected characters
+	OVERFLOW  ///< The value doesn't fit the output type
+};
+
+/**
+ * @brief      Fixed-point decimal number
+ *
+ * @details    The value is mantissa / 10^scale, "-12.340" is stored as {-12340, 3}.
+ */
+struct FixedPoint {
+	int64_t mantissa;
+	unsigned int scale;
+
+	/**
+	 * @brief      Convert the number to double precision
+	 */
+	double toDouble() const;
+
+	/**
+	 * @brief      Get the number with another scale, digits are truncated when the scale decreases
+	 */
+	int64_t rescale(unsigned int newScale) const;
+};
+
+/**
+ * Maximum number of significant digits of a FixedPoint number
+ */
+constexpr unsigned int FIXED_POINT_MAX_DIGITS = 18;
+
+/**
+ * @defgroup number_parser NMEA numeric field parsers
+ *
+ * @brief      Parsers working on the raw bytes of a NMEA field
+ *
+ * @details    These parsers don't allocate, don't throw and don't depend on the locale, the
+ * field bytes are parsed in place and the status tells why a value isn't available. The output
+ * value is only written when the status is ParseStatus::OK. The whole range must be a valid
+ * number, trailing characters are reported as ParseStatus::INVALID.
+ *
+ * @{
+ */
+
+/**
+ * @brief      Parse a signed decimal integer
+ *
+ * @param[in]  first  First byte of the field
+ * @param[in]  last   Past the end byte of the field
+ * @param[out] out    The parsed value
+ *
+ * @return     The parse status
+ */
+ParseStatus parseInteger(const uint8_t * first, const uint8_t * last, int32_t & out) noexcept;
+
+/**
+ * @brief      Parse a signed 16 bits decimal integer
+ */
+ParseStatus parseInteger(const uint8_t * first, const uint8_t * last, int16_t & out) noexcept;
+
+/**
+ * @brief      Parse a fixed-point decimal number, without exponent
+ *
+ * @details    The scale of the output is the number of digits after the decimal point, at most
+ * FIXED_POINT_MAX_DIGITS digits are accepted.
+ */
+ParseStatus parseFixedPoint(const uint8_t * first, const uint8_t * last, FixedPoint & out) noexcept;
+
+/**
+ * @brief      Parse a decimal number to double precision
+ */
+ParseStatus parseDouble(const uint8_t * first, const uint8_t * last, double & out) noexcept;
+
+/**
+ * @brief      Parse a decimal number to single precision
+ */
+ParseStatus parseFloat(const uint8_t * first, const uint8_t * last, float & out) noexcept;
+
+/**
+ * @brief      Parse a numeric boolean, 0 is false, all other values are true
+ */
+ParseStatus parseBoolean(const uint8_t * first, const uint8_t * last, bool & out) noexcept;
+
+/**
+ * @brief      Parse a NMEA coordinate to decimal degrees
+ *
+ * @details    The coordinate is formatted as `ddmm.mmmm` for latitudes and `dddmm.mmmm` for
+ * longitudes, the two digits before the decimal point are the minutes.
+ *
+ * @param[in]  first       First byte of the coordinate field
+ * @param[in]  last        Past the end byte of the coordinate field
+ * @param[in]  hemisphere  Hemisphere indicator: 'N', 'S', 'E' or 'W'
+ * @param[out] out         The coordinate in decimal degrees, negative in south and west hemispheres
+ *
+ * @return     The parse status
+ */
+ParseStatus parseCoordinate(
+	const uint8_t * first,
+	const uint8_t * last,
+	uint8_t hemisphere,
+	double & out) noexcept;
+
+/** @} */
+
+/**
+ * @brief      Get a human readable status name
+ */
+const char * parseStatusToString(ParseStatus status) noexcept;
+
+} // namespace utils
+} // namespace stm
+
+#endif // TESEO_HAL_UTILS_NUMBER_PARSER_H
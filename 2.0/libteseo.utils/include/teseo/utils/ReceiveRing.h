@@ -0,0 +1,126 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Reusable receive ring buffer
+ * @file ReceiveRing.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_UTILS_RECEIVE_RING_H
+#define TESEO_HAL_UTILS_RECEIVE_RING_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "ByteView.h"
+
+namespace stm {
+namespace stream {
+
+/**
+ * @brief      Receive ring buffer for byte streams
+ *
+ * @details    The ring storage is allocated once. Each read is performed directly in the ring
+ * with prepare() then published with commit(), which returns a read-only view over the received
+ * bytes. The ring is split in `slots` chunks, a view stays valid until the ring wraps around it,
+ * that is at least `slots - 1` further reads.
+ *
+ * There is a single producer (the reader thread), consumers receive the views synchronously from
+ * this thread.
+ */
+class ReceiveRing {
+private:
+	std::vector<uint8_t> storage;
+
+	std::size_t chunk;
+
+	std::size_t head;
+
+public:
+	/**
+	 * Minimal chunk size, in bytes
+	 */
+	static constexpr std::size_t MIN_CHUNK_SIZE = 256;
+
+	/**
+	 * Maximal chunk size, in bytes
+	 */
+	static constexpr std::size_t MAX_CHUNK_SIZE = 4096;
+
+	/**
+	 * Default number of chunks in the ring
+	 */
+	static constexpr std::size_t DEFAULT_SLOTS = 4;
+
+	/**
+	 * @brief      Compute the receive chunk size for a line speed
+	 *
+	 * @details    The chunk holds about 20 ms of line time (10 bits per byte on the wire), rounded
+	 * up to a power of two and clamped between MIN_CHUNK_SIZE and MAX_CHUNK_SIZE.
+	 *
+	 * @param[in]  baudrate  The line speed in bauds
+	 *
+	 * @return     The chunk size in bytes
+	 */
+	static std::size_t chunkSizeForBaudrate(unsigned int baudrate);
+
+	/**
+	 * @brief      Create a receive ring
+	 *
+	 * @param[in]  chunkSize  Maximum number of bytes per read
+	 * @param[in]  slots      Number of chunks in the ring (at least 2)
+	 */
+	explicit ReceiveRing(std::size_t chunkSize, std::size_t slots = DEFAULT_SLOTS);
+
+	/**
+	 * @brief      Get the write area for the next read
+	 *
+	 * @return     Pointer to at least chunkSize() contiguous writable bytes
+	 */
+	uint8_t * prepare();
+
+	/**
+	 * @brief      Publish the bytes written in the area returned by prepare()
+	 *
+	 * @param[in]  count  Number of bytes written, must not exceed chunkSize()
+	 *
+	 * @return     Read-only view over the published bytes
+	 */
+	ByteView commit(std::size_t count);
+
+	/**
+	 * @brief      Maximum number of bytes per read
+	 */
+	std::size_t chunkSize() const;
+
+	/**
+	 * @brief      Total ring storage size
+	 */
+	std::size_t capacity() const;
+};
+
+} // namespace stream
+} // namespace stm
+
+#endif // TESEO_HAL_UTILS_RECEIVE_RING_H
@@ -0,0 +1,180 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Replay byte stream
+ * @file ReplayByteStream.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_UTILS_REPLAYBYTESTREAM_H
+#define TESEO_HAL_UTILS_REPLAYBYTESTREAM_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "IByteStream.h"
+#include "Capture.h"
+#include "ReceiveRing.h"
+
+namespace stm {
+namespace stream {
+
+/**
+ * Replay pacing mode
+ */
+enum class ReplayPacing {
+	REAL_TIME,          ///< Honour the recorded timing
+	SCALED,             ///< Recorded timing divided by the speed factor
+	AS_FAST_AS_POSSIBLE ///< No delay between records
+};
+
+/**
+ * @brief      Byte stream replaying a capture, or reading a pty
+ *
+ * @details    When the source is a regular file it is read with a capture::CaptureReader (capture
+ * file or raw NMEA log) and its RX records are emitted through newBytes according to the pacing
+ * mode. endOfCapture is emitted once all records are replayed.
+ *
+ * Any other source (pty, FIFO) is read live like a UART, pacing is then given by the peer
+ * writing to it, and written bytes are forwarded to the source.
+ *
+ * In both modes written bytes are captured and can be retrieved with takeWritten().
+ */
+class ReplayByteStream : public AbstractByteStream {
+private:
+	std::string source;
+
+	ReplayPacing pacing;
+
+	double speedFactor;
+
+	unsigned int speedDevice;
+
+	ByteStreamStatus streamStatus;
+
+	capture::CaptureReader captureReader;
+
+	/**
+	 * Live source file descriptor, -1 when replaying a file
+	 */
+	int liveFd;
+
+	/**
+	 * eventfd used to interrupt a blocked read
+	 */
+	int wakeupFd;
+
+	ReceiveRing rxRing;
+
+	/**
+	 * Record read but not emitted yet because a wakeup interrupted the wait
+	 */
+	capture::Record pendingRecord;
+
+	bool hasPendingRecord;
+
+	bool replayStarted;
+
+	bool endReported;
+
+	std::chrono::steady_clock::time_point replayStart;
+
+	std::chrono::nanoseconds captureStart;
+
+	unsigned int openCount;
+
+	std::mutex openMutex;
+
+	std::mutex writtenMutex;
+
+	std::vector<ByteVector> written;
+
+	/**
+	 * @brief Wait until deadline or a wakeup
+	 *
+	 * @return True if the deadline is reached, false on wakeup
+	 */
+	bool waitUntil(std::chrono::steady_clock::time_point deadline);
+
+	/**
+	 * @brief Wait for a wakeup
+	 */
+	void waitWakeup();
+
+	ByteView readCapture();
+
+	ByteView readLive();
+
+protected:
+	virtual void open() noexcept(false);
+
+	virtual void close() noexcept(false);
+
+	virtual void flush() noexcept(false);
+
+	virtual ByteView perform_read() noexcept(false);
+
+	virtual void perform_write(const std::vector<ByteVectorPtr> & messages) noexcept(false);
+
+	virtual void wakeup() noexcept;
+
+public:
+	/**
+	 * @brief      Create a replay byte stream
+	 *
+	 * @param[in]  source       Capture file, raw NMEA log or pty path
+	 * @param[in]  pacing       Replay pacing mode
+	 * @param[in]  speedFactor  Replay speed multiple, used by ReplayPacing::SCALED
+	 * @param[in]  speedDevice  Line speed, used to time raw NMEA logs and pace bulk writes
+	 */
+	explicit ReplayByteStream(
+		const std::string & source,
+		ReplayPacing pacing = ReplayPacing::REAL_TIME,
+		double speedFactor = 1.0,
+		unsigned int speedDevice = 115200);
+
+	virtual ~ReplayByteStream();
+
+	virtual const std::string & name() const;
+
+	virtual ByteStreamStatus status() const;
+
+	virtual unsigned int baudrate() const;
+
+	/**
+	 * @brief      Get and clear the messages written to the stream
+	 */
+	std::vector<ByteVector> takeWritten();
+
+	/**
+	 * Signal emitted from the reader thread once the whole capture is replayed
+	 */
+	Signal<void> endOfCapture;
+};
+
+} // namespace stream
+} // namespace stm
+
+#endif // TESEO_HAL_UTILS_REPLAYBYTESTREAM_H
@@ -0,0 +1,257 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Compile-time NMEA sentence lookup table
+ * @file SentenceTable.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_UTILS_SENTENCE_TABLE_H
+#define TESEO_HAL_UTILS_SENTENCE_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "ByteView.h"
+
+namespace stm {
+namespace utils {
+
+/**
+ * @brief      NMEA sentence family
+ *
+ * @details    Standard sentence IDs are shared by all talkers (GPRMC, GNRMC...), proprietary
+ * sentence IDs only exist for the PSTM talker.
+ */
+enum class SentenceFamily : uint8_t {
+	STANDARD    = 'S',
+	PROPRIETARY = 'P'
+};
+
+/**
+ * Longest sentence ID packed in a key, longer IDs are hashed
+ */
+constexpr std::size_t SENTENCE_KEY_MAX_PACKED = 7;
+
+/**
+ * @brief      Compute the lookup key of a sentence ID
+ *
+ * @details    Sentence IDs up to SENTENCE_KEY_MAX_PACKED bytes are packed with the family in the
+ * key, so the key identifies the sentence. Longer IDs, like some PSTM ones, are hashed with 64
+ * bits FNV-1a. The key is computed at compile time for registered sentences and from the raw
+ * sentence bytes at runtime.
+ *
+ * @param[in]  family  The sentence family
+ * @param[in]  id      The sentence ID bytes
+ * @param[in]  length  The sentence ID length
+ *
+ * @return     The sentence key
+ */
+template<typename Char>
+constexpr uint64_t sentenceKey(SentenceFamily family, const Char * id, std::size_t length)
+{
+	if(length <= SENTENCE_KEY_MAX_PACKED)
+	{
+		uint64_t key = static_cast<uint8_t>(family);
+
+		for(std::size_t i = 0; i < length; i++)
+			key |= static_cast<uint64_t>(static_cast<uint8_t>(id[i])) << (8 * (i + 1));
+
+		return key;
+	}
+
+	constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+	constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+	uint64_t hash = (FNV_OFFSET_BASIS ^ static_cast<uint8_t>(family)) * FNV_PRIME;
+
+	for(std::size_t i = 0; i < length; i++)
+		hash = (hash ^ static_cast<uint8_t>(id[i])) * FNV_PRIME;
+
+	return hash;
+}
+
+/**
+ * @brief      Sentence table entry
+ */
+template<typename T>
+struct SentenceEntry {
+	uint64_t key;
+	SentenceFamily family;
+	const char * id;
+	std::size_t length;
+	T value;
+};
+
+/**
+ * @brief      Create a standard sentence entry
+ */
+template<typename T, std::size_t L>
+constexpr SentenceEntry<T> standardSentence(const char (&id)[L], T value)
+{
+	return {sentenceKey(SentenceFamily::STANDARD, id, L - 1), SentenceFamily::STANDARD, id, L - 1, value};
+}
+
+/**
+ * @brief      Create a proprietary sentence entry
+ */
+template<typename T, std::size_t L>
+constexpr SentenceEntry<T> proprietarySentence(const char (&id)[L], T value)
+{
+	return {sentenceKey(SentenceFamily::PROPRIETARY, id, L - 1), SentenceFamily::PROPRIETARY, id, L - 1, value};
+}
+
+/**
+ * @brief      Compile-time sentence lookup table
+ *
+ * @details    The entries are stored in an open addressing hash table built at compile time, with
+ * at least twice as many slots as entries. A lookup computes the sentence key, multiplies it to
+ * get the slot and compares keys until an empty slot. Hashed keys are confirmed by comparing the
+ * ID bytes. It doesn't allocate. Use makeSentenceTable() to build the table, its size is deduced
+ * from the registration list.
+ *
+ * @tparam     T     The value type, a decoder function pointer for example
+ * @tparam     N     The number of entries
+ */
+template<typename T, std::size_t N>
+class SentenceTable {
+private:
+	static constexpr unsigned int slotBits()
+	{
+		unsigned int bits = 1;
+
+		while((std::size_t(1) << bits) < 2 * N)
+			bits++;
+
+		return bits;
+	}
+
+	static constexpr unsigned int SLOT_BITS = slotBits();
+
+	static constexpr std::size_t SLOTS = std::size_t(1) << SLOT_BITS;
+
+	static constexpr std::size_t slotOf(uint64_t key)
+	{
+		// Fibonacci hashing, the top bits of the product are well mixed
+		return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ULL) >> (64 - SLOT_BITS));
+	}
+
+	/**
+	 * Registered entries, in registration order
+	 */
+	std::array<SentenceEntry<T>, N> entries;
+
+	/**
+	 * Entry index + 1 of each slot, 0 for empty slots
+	 */
+	std::array<uint8_t, SLOTS> slots;
+
+	static_assert(N < 255, "Too many sentences for a sentence table");
+
+public:
+	constexpr SentenceTable(const SentenceEntry<T> (&registrations)[N]) :
+		entries(),
+		slots()
+	{
+		for(std::size_t i = 0; i < N; i++)
+		{
+			entries[i] = registrations[i];
+
+			std::size_t slot = slotOf(registrations[i].key);
+
+			while(slots[slot] != 0)
+				slot = (slot + 1) & (SLOTS - 1);
+
+			slots[slot] = static_cast<uint8_t>(i + 1);
+		}
+	}
+
+	/**
+	 * @brief      Check that all the keys are different
+	 *
+	 * @details    Use it in a static_assert to detect duplicated registrations and hash collisions.
+	 */
+	constexpr bool hasUniqueKeys() const
+	{
+		for(std::size_t i = 0; i < N; i++)
+		{
+			for(std::size_t j = i + 1; j < N; j++)
+			{
+				if(entries[i].key == entries[j].key)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	constexpr std::size_t size() const { return N; }
+
+	/**
+	 * @brief      Find the value registered for a sentence
+	 *
+	 * @param[in]  family    The sentence family
+	 * @param[in]  id        The sentence ID
+	 * @param[in]  notFound  Value returned when the sentence isn't registered
+	 *
+	 * @return     The registered value or notFound
+	 */
+	T find(SentenceFamily family, ByteView id, T notFound) const
+	{
+		const uint64_t key = sentenceKey(family, id.data(), id.size());
+
+		for(std::size_t slot = slotOf(key); slots[slot] != 0; slot = (slot + 1) & (SLOTS - 1))
+		{
+			const SentenceEntry<T> & entry = entries[slots[slot] - 1];
+
+			if(entry.key != key)
+				continue;
+
+			// Packed keys identify the sentence, hashed keys may collide
+			if(entry.length != id.size() ||
+			   (entry.length > SENTENCE_KEY_MAX_PACKED &&
+			    (entry.family != family || std::memcmp(entry.id, id.data(), id.size()) != 0)))
+				return notFound;
+
+			return entry.value;
+		}
+
+		return notFound;
+	}
+};
+
+/**
+ * @brief      Build a sentence table from a registration list
+ */
+template<typename T, std::size_t N>
+constexpr SentenceTable<T, N> makeSentenceTable(const SentenceEntry<T> (&registrations)[N])
+{
+	return SentenceTable<T, N>(registrations);
+}
+
+} // namespace utils
+} // namespace stm
+
+#endif // TESEO_HAL_UTILS_SENTENCE_TABLE_H
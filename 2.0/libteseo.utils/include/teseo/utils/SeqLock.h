@@ -0,0 +1,147 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Sequence lock for single writer snapshot publication
+ * @file SeqLock.h
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#ifndef TESEO_HAL_UTILS_SEQ_LOCK_H
+#define TESEO_HAL_UTILS_SEQ_LOCK_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace stm {
+namespace utils {
+
+/**
+ * @brief      Sequence lock holding a snapshot of a trivially copyable value
+ *
+ * @details    A single writer publishes values with store(), any number of readers get a consistent
+ * copy with load(). The writer never waits; a reader retries its copy when a store happened
+ * meanwhile. The value is stored in atomic words so concurrent copies aren't data races.
+ *
+ * @tparam     T     The value type, it must be trivially copyable
+ */
+template<typename T>
+class SeqLock {
+private:
+	static_assert(std::is_trivially_copyable<T>::value, "SeqLock value must be trivially copyable");
+
+	static constexpr std::size_t WORD_SIZE = sizeof(uint64_t);
+
+	static constexpr std::size_t WORDS = (sizeof(T) + WORD_SIZE - 1) / WORD_SIZE;
+
+	/**
+	 * Sequence number, odd while a store is in progress
+	 */
+	std::atomic<uint32_t> sequence;
+
+	std::array<std::atomic<uint64_t>, WORDS> words;
+
+public:
+	explicit SeqLock(const T & initial = T()) :
+		sequence(0)
+	{
+		for(auto & word : words)
+			word.store(0, std::memory_order_relaxed);
+
+		store(initial);
+	}
+
+	SeqLock(const SeqLock &) = delete;
+	SeqLock & operator=(const SeqLock &) = delete;
+
+	/**
+	 * @brief      Publish a new value
+	 *
+	 * @details    Must only be called by the writer thread.
+	 */
+	void store(const T & value)
+	{
+		const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&value);
+		const uint32_t seq = sequence.load(std::memory_order_relaxed);
+
+		sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for(std::size_t i = 0; i < WORDS; i++)
+		{
+			uint64_t word = 0;
+			std::memcpy(&word, bytes + i * WORD_SIZE, std::min(WORD_SIZE, sizeof(T) - i * WORD_SIZE));
+			words[i].store(word, std::memory_order_relaxed);
+		}
+
+		sequence.store(seq + 2, std::memory_order_release);
+	}
+
+	/**
+	 * @brief      Copy the last published value
+	 */
+	void load(T & out) const
+	{
+		uint8_t * bytes = reinterpret_cast<uint8_t *>(&out);
+		uint32_t before, after;
+
+		do
+		{
+			before = sequence.load(std::memory_order_acquire);
+
+			for(std::size_t i = 0; i < WORDS; i++)
+			{
+				uint64_t word = words[i].load(std::memory_order_relaxed);
+				std::memcpy(bytes + i * WORD_SIZE, &word, std::min(WORD_SIZE, sizeof(T) - i * WORD_SIZE));
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			after = sequence.load(std::memory_order_relaxed);
+		}
+		while((before & 1) != 0 || before != after);
+	}
+
+	T load() const
+	{
+		T out;
+		load(out);
+		return out;
+	}
+
+	/**
+	 * @brief      Get the number of stores, including the initial one
+	 */
+	uint32_t version() const
+	{
+		return sequence.load(std::memory_order_acquire) / 2;
+	}
+};
+
+} // namespace utils
+} // namespace stm
+
+#endif // TESEO_HAL_UTILS_SEQ_LOCK_H
@@ -29,12 +29,14 @@
 #ifndef TESEO_HAL_SIGNAL_H
 #define TESEO_HAL_SIGNAL_H
 
+#include <algorithm>
 #include <memory>
 #include <list>
-#include <deque>
 #include <functional>
+#include <stdexcept>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include "constraints.h"
 
@@ -161,7 +163,7 @@ public:
 	using SlotType = std::function<Treturn (Targs...)>;
 
 	FunctionSlot(SlotType s) :
-		slot(s)
+		slot(std::move(s))
 	{ }
 
 	Treturn call(Targs... args)
@@ -182,6 +184,38 @@ private:
 	SlotType slot;
 };
 
+/**
+ * @brief      Class for function pointer slot.
+ *
+ * @details    The function is called directly, without going through a std::function.
+ *
+ * @tparam     Treturn  Slot return type
+ * @tparam     Targs    Slot argument list
+ */
+template <typename Treturn, typename ...Targs>
+class FunctionPointerSlot : public GenericSlot<Treturn (Targs...)>
+{
+public:
+	/**
+	 * Slot function type
+	 */
+	typedef Treturn (*SlotType)(Targs...);
+
+	FunctionPointerSlot(SlotType s) :
+		slot(s)
+	{ }
+
+	Treturn call(Targs... args)
+	{
+		return slot(args...);
+	}
+
+	virtual bool isValid() { return slot != nullptr; }
+
+private:
+	SlotType slot;
+};
+
 /**
  * @brief      Class for class method slot.
  *
@@ -202,6 +236,7 @@ public:
 
 	ClassMethodSlot(const Tinstance & i, SlotType s) :
 		instance(i.getWeakPtr()),
+		target(const_cast<Tinstance *>(&i)),
 		slot(s)
 	{
 		if(slot == nullptr)
@@ -211,8 +246,9 @@ public:
 	/**
 	 * @brief      Call the slot method
 	 * 
-	 * @details    The instance is acquired using the weak pointer to Trackable, then by statically
-	 * casting this pointer to Tinstance class.
+	 * @details    The instance pointer is saved when the slot is created, the weak pointer to
+	 * Trackable is only used to check that the instance is still alive in isValid(). The call
+	 * doesn't touch the reference counts.
 	 *
 	 * @param[in]  args  The arguments
 	 *
@@ -220,17 +256,7 @@ public:
 	 */
 	Treturn call(Targs... args)
 	{
-		// 1. Get trackable ptr
-		Trackable * ti = instance.lock().get();
-
-		// 2. Promote trackable to child class
-		// Static cast performs no type checking (i.e.: it is unsafe)
-		// but we are sure that our pointer to Trackable can be
-		// downcasted to Tinstance because of the DerivedFrom
-		// constraint.
-		Tinstance * i = static_cast<Tinstance*>(ti);
-
-		return (i->*slot)(args...);
+		return (target->*slot)(args...);
 	}
 
 	/**
@@ -248,13 +274,40 @@ public:
 
 private:
 	Trackable::weak_ptr instance;
+	Tinstance * target;
 	SlotType slot;
 };
 
+/**
+ * @brief      Class for signal slot, the slot forwards its arguments to another signal.
+ *
+ * @tparam     Tsignal  The signal type
+ * @tparam     Treturn  Slot return type
+ * @tparam     Targs    Slot argument list
+ */
+template <class Tsignal, typename Treturn, typename ...Targs>
+class SignalSlot : public GenericSlot<Treturn (Targs...)>
+{
+public:
+	SignalSlot(Tsignal & s) :
+		sig(&s)
+	{ }
+
+	Treturn call(Targs... args)
+	{
+		return sig->emit(args...);
+	}
+
+private:
+	Tsignal * sig;
+};
+
 namespace signal_implementation {
 
 template <bool Debug=false>
 struct SignalDebugger {
+	static constexpr bool enabled = false;
+
 	template<typename ...T>
 	void logv(const char *, T...)
 	{ }
@@ -278,6 +331,8 @@ struct SignalDebugger {
 
 template <>
 struct SignalDebugger<true> {
+	static constexpr bool enabled = true;
+
 	template<typename ...T>
 	void logv(const char * fmt, T... args)
 	{
@@ -308,34 +363,109 @@ struct SignalDebugger<true> {
 		SIG_LOGE(fmt, args...);
 	}
 };
-	
+
+/**
+ * Trace emits, the arguments are only evaluated when the signal is debugged
+ */
+#define SIGNAL_TRACE(...) \
+	do { if constexpr(decltype(this->dbg)::enabled) { this->dbg.logi(__VA_ARGS__); } } while(0)
+
 template <bool DebugFlag, typename Treturn, typename ...Targs>
 class AbstractSignal
 {
 protected:
 	SignalDebugger<DebugFlag> dbg;
 
+	using Slot = GenericSlot<Treturn (Targs...)>;
+
 	/**
-	 * Slot list type
+	 * Slot list type, slots are stored contiguously in connection order
 	 */
-	typedef std::list<typename GenericSlot<Treturn (Targs...)>::ptr> SlotList;
+	typedef std::vector<typename Slot::ptr> SlotList;
 	 
 	SlotList slots;
 
 	std::string signalName;
 
+	/**
+	 * Number of emits in progress, expired slots are only erased by the outermost one
+	 */
+	unsigned int emitDepth;
+
+	bool hasExpiredSlots;
+
 	friend class AbstractSignal<!DebugFlag, Treturn, Targs...>;
 
+	/**
+	 * @brief      Call a function for each valid slot
+	 *
+	 * @details    The slots connected during the iteration are called by the next emit. Expired
+	 * slots are erased in place after the iteration, an emit doesn't allocate.
+	 *
+	 * @param[in]  fn    The function, called with a reference to the slot
+	 */
+	template<typename Tfunc>
+	void forEachSlot(Tfunc && fn)
+	{
+		struct DepthGuard {
+			AbstractSignal & sig;
+
+			DepthGuard(AbstractSignal & s) : sig(s) { sig.emitDepth++; }
+
+			~DepthGuard()
+			{
+				if(--sig.emitDepth == 0 && sig.hasExpiredSlots)
+					sig.eraseExpiredSlots();
+			}
+		} guard(*this);
+
+		const std::size_t count = slots.size();
+
+		for(std::size_t i = 0; i < count; i++)
+		{
+			// Index the vector on each iteration, a slot may connect to this signal
+			Slot * slot = slots[i].get();
+
+			if(slot->isValid())
+			{
+				SIGNAL_TRACE("Call slot %p", slot);
+				fn(*slot);
+			}
+			else
+			{
+				SIGNAL_TRACE("Slot %p is not valid", slot);
+				hasExpiredSlots = true;
+			}
+		}
+	}
+
+	void eraseExpiredSlots()
+	{
+		hasExpiredSlots = false;
+
+		slots.erase(
+			std::remove_if(slots.begin(), slots.end(), [](const typename Slot::ptr & slot) {
+				return !slot->isValid();
+			}),
+			slots.end());
+
+		SIGNAL_TRACE("Expired slots erased from %s", toString().c_str());
+	}
+
 public:
 	AbstractSignal() :
-		signalName("no-name")
+		signalName("no-name"),
+		emitDepth(0),
+		hasExpiredSlots(false)
 	{
 		this->dbg.logw("You are debugging a Signal without giving him a name. "
 			           "This can be hard, good luck.");
 	}
 
 	AbstractSignal(const char * n) :
-		signalName(n)
+		signalName(n),
+		emitDepth(0),
+		hasExpiredSlots(false)
 	{ }
 
 	virtual ~AbstractSignal()
@@ -346,10 +476,20 @@ public:
 	 *
 	 * @param[in]  slot  The slot
 	 */
-	void connect(const typename GenericSlot<Treturn (Targs...)>::ptr & slot)
+	void connect(const typename Slot::ptr & slot)
 	{
 		slots.push_back(slot);
-		this->dbg.logi("Add slot %p to %s", slot.get(), toString().c_str());
+		SIGNAL_TRACE("Add slot %p to %s", slot.get(), toString().c_str());
+	}
+
+	/**
+	 * @brief      Check if slots are connected to the signal
+	 *
+	 * @details    Expired slots are only removed on emit, they count as connected until then.
+	 */
+	bool isConnected() const
+	{
+		return !slots.empty();
 	}
 
 	const char * name() const
@@ -383,7 +523,7 @@ class BaseSignal :
 protected:
 	Treturn call(Targs... args)
 	{
-		this->dbg.logd("Signal forwarded to %s", this->toString().c_str());
+		SIGNAL_TRACE("Signal forwarded to %s", this->toString().c_str());
 		return emit(args...);
 	}
 
@@ -405,36 +545,15 @@ public:
 	 */
 	Treturn emit(Targs... args)
 	{
-		this->dbg.logi("emit: %s", this->toString().c_str());
-		std::deque<typename AbstractSignal<DebugFlag, Treturn, Targs...>::SlotList::iterator> toErase;
+		SIGNAL_TRACE("emit: %s", this->toString().c_str());
 		Treturn lastResponse;
 
-		for(auto it = this->slots.begin(); it != this->slots.end(); ++it)
-		{
-			auto slot = *it;
-			this->dbg.logi("Slot: %p", slot.get());
-
-			if(slot->isValid())
-			{
-				this->dbg.logi("Slot is valid, call slot.");
-				lastResponse = slot->call(args...);
-				this->dbg.logi("Slot response: %s",
-					(std::ostringstream() << lastResponse).str().c_str());
-			}
-			else
-			{
-				this->dbg.logi("Slot is not valid, erase slot.");
-				toErase.push_back(it);
-			}
-		}
-
-		for(auto e : toErase)
-		{
-			this->dbg.logi("Erase slot %p", e->get());
-			this->slots.erase(e);
-		}
+		this->forEachSlot([&](GenericSlot<Treturn (Targs...)> & slot) {
+			lastResponse = slot.call(args...);
+			SIGNAL_TRACE("Slot response: %s", (std::ostringstream() << lastResponse).str().c_str());
+		});
 
-		this->dbg.logi("End of emit, return last response: %s",
+		SIGNAL_TRACE("End of emit, return last response: %s",
 			(std::ostringstream() << lastResponse).str().c_str());
 		return lastResponse;
 	}
@@ -463,34 +582,14 @@ Treturn BaseSignal<DebugFlag, Treturn, Targs...>::operator()(Targs... args)
 template<bool DebugFlag, typename Treturn, typename ...Targs>
 auto BaseSignal<DebugFlag, Treturn, Targs...>::collect(Targs... args)
 {
-	this->dbg.logi("emit: %s", this->toString().c_str());
-	std::deque<typename AbstractSignal<DebugFlag, Treturn, Targs...>::SlotList::iterator> toErase;
+	SIGNAL_TRACE("emit: %s", this->toString().c_str());
 	std::list<Treturn> responses;
 
-	for(auto it = this->slots.begin(); it != this->slots.end(); ++it)
-	{
-		auto slot = *it;
-		this->dbg.logi("Slot: %p", slot.get());
-
-		if(slot->isValid())
-		{
-			this->dbg.logi("Slot is valid, call slot.");
-			responses.push_back(slot->call(args...));
-		}
-		else
-		{
-			this->dbg.logi("Slot is not valid, erase slot.");
-			toErase.push_back(it);
-		}
-	}
-
-	for(auto e : toErase)
-	{
-		this->dbg.logi("Erase slot %p", e->get());
-		this->slots.erase(e);
-	}
+	this->forEachSlot([&](GenericSlot<Treturn (Targs...)> & slot) {
+		responses.push_back(slot.call(args...));
+	});
 
-	this->dbg.logi("End of emit, return %d responses.", (unsigned int)responses.size());
+	SIGNAL_TRACE("End of emit, return %d responses.", (unsigned int)responses.size());
 	return responses;
 }
 
@@ -506,7 +605,7 @@ auto BaseSignal<DebugFlag, Treturn, Targs...>::collect(Targs... args)
  protected:
 	void call(Targs... args)
 	{
-		this->dbg.logd("Signal forwarded to %s", this->toString().c_str());
+		SIGNAL_TRACE("Signal forwarded to %s", this->toString().c_str());
 		emit(args...);
 	}
  
@@ -531,33 +630,13 @@ auto BaseSignal<DebugFlag, Treturn, Targs...>::collect(Targs... args)
 template<bool DebugFlag, typename ...Targs>
 void BaseSignal<DebugFlag, void, Targs...>::emit(Targs... args)
 {
-	this->dbg.logi("emit: %s", this->toString().c_str());
-	std::deque<typename AbstractSignal<DebugFlag, void, Targs...>::SlotList::iterator> toErase;
-
-	for(auto it = this->slots.begin(); it != this->slots.end(); ++it)
-	{
-		auto slot = *it;
-		this->dbg.logi("Slot: %p", slot.get());
-
-		if(slot->isValid())
-		{
-			this->dbg.logi("Slot is valid, call slot.");
-			slot->call(args...);
-		}
-		else
-		{
-			this->dbg.logi("Slot is not valid, erase slot.");
-			toErase.push_back(it);
-		}
-	}
+	SIGNAL_TRACE("emit: %s", this->toString().c_str());
 
-	for(auto e : toErase)
-	{
-		this->dbg.logi("Erase slot %p", e->get());
-		this->slots.erase(e);
-	}
+	this->forEachSlot([&](GenericSlot<void (Targs...)> & slot) {
+		slot.call(args...);
+	});
 
-	this->dbg.logi("End of emit.");
+	SIGNAL_TRACE("End of emit.");
 }
 
 template<bool DebugFlag, typename ...Targs>
@@ -566,6 +645,8 @@ void BaseSignal<DebugFlag, void, Targs...>::operator()(Targs... args)
 	emit(args...);
 }
 
+#undef SIGNAL_TRACE
+
 } // namespace signal_implementation
 
 /**
@@ -630,66 +711,8 @@ namespace SlotFactory
 	template<typename Treturn, typename ...Targs>
 	auto create(Treturn (*slot)(Targs...))
 	{
-		return create(std::function<Treturn (Targs...)>(slot));
-	}
-
-	/**
-	 * @brief      Create slot from a signal
-	 *
-	 * @param[in]  sig      The signal to create a slot from
-	 *
-	 * @tparam     Treturn  The signal return type
-	 *
-	 * @return     The created slot object
-	 *
-	 * @details    Works only for signal with no arguments.
-	 */
-	template<typename Treturn>
-	auto create(Signal<Treturn> & sig)
-	{
-		auto fn = std::bind(&Signal<Treturn>::emit, &sig);
-		return create(std::function<Treturn ()>(fn));
-	}
-
-	/**
-	 * @brief      Create slot from a signal
-	 *
-	 * @param[in]  sig      The signal to create a slot from
-	 *
-	 * @tparam     Treturn  The signal return type
-	 * @tparam     T1       The first parameter type
-	 *
-	 * @return     The created slot object
-	 *
-	 * @details    Works only for signal with one argument.
-	 */
-	template<typename Treturn, typename T1>
-	auto create(Signal<Treturn, T1> & sig)
-	{
-		using namespace std::placeholders;
-		auto fn = std::bind(&Signal<Treturn, T1>::emit, &sig, _1);
-		return create(std::function<Treturn (T1)>(fn));
-	}
-
-	/**
-	 * @brief      Create slot from a signal
-	 *
-	 * @param[in]  sig      The signal to create a slot from
-	 *
-	 * @tparam     Treturn  The signal return type
-	 * @tparam     T1       The first parameter type
-	 * @tparam     T2       The second parameter type
-	 *
-	 * @return     The created slot object
-	 *
-	 * @details    Works only for signal with two arguments.
-	 */
-	template<typename Treturn, typename T1, typename T2>
-	auto create(Signal<Treturn, T1, T2> & sig)
-	{
-		using namespace std::placeholders;
-		auto fn = std::bind(&Signal<Treturn, T1, T2>::emit, &sig, _1, _2);
-		return create(std::function<Treturn (T1, T2)>(fn));
+		return typename GenericSlot<Treturn (Targs...)>::ptr(
+			new FunctionPointerSlot<Treturn, Targs...>(slot));
 	}
 
 	/**
@@ -698,68 +721,15 @@ namespace SlotFactory
 	 * @param[in]  sig      The signal to create a slot from
 	 *
 	 * @tparam     Treturn  The signal return type
-	 * @tparam     T1       The first parameter type
-	 * @tparam     T2       The second parameter type
-	 * @tparam     T3       The third parameter type
-	 *
-	 * @return     The created slot object
+	 * @tparam     Targs    The signal arguments types
 	 *
-	 * @details    Works only for signal with three arguments.
+	 * @return     The created slot object, emitting the signal when called
 	 */
-	template<typename Treturn, typename T1, typename T2, typename T3>
-	auto create(Signal<Treturn, T1, T2, T3> & sig)
-	{
-		using namespace std::placeholders;
-		auto fn = std::bind(&Signal<Treturn, T1, T2, T3>::emit, &sig, _1, _2, _3);
-		return create(std::function<Treturn (T1, T2, T3)>(fn));
-	}
-	
-	/**
-	 * @brief      Create slot from a signal
-	 *
-	 * @param[in]  sig      The signal to create a slot from
-	 *
-	 * @tparam     Treturn  The signal return type
-	 * @tparam     T1       The first parameter type
-	 * @tparam     T2       The second parameter type
-	 * @tparam     T3       The third parameter type
-	 * @tparam     T4       The fourth parameter type
-	 *
-	 * @return     The created slot object
-	 *
-	 * @details    Works only for signal with four arguments.
-	 */
-	template<typename Treturn, typename T1, typename T2, typename T3, typename T4>
-	auto create(Signal<Treturn, T1, T2, T3, T4> & sig)
-	{
-		using namespace std::placeholders;
-		auto fn = std::bind(&Signal<Treturn, T1, T2, T3, T4>::emit, &sig, _1, _2, _3, _4);
-		return create(std::function<Treturn (T1, T2, T3, T4)>(fn));
-	}
-	
-	/**
-	 * @brief      Create slot from a signal
-	 *
-	 * @param[in]  sig      The signal to create a slot from
-	 *
-	 * @tparam     Treturn  The signal return type
-	 * @tparam     T1       The first parameter type
-	 * @tparam     T2       The second parameter type
-	 * @tparam     T3       The third parameter type
-	 * @tparam     T4       The fourth parameter type
-	 * @tparam     T5       The fith parameter type
-	 *
-	 * @return     The created slot object
-	 *
-	 * @details    Works only for signal with five arguments. To create a slot from a signal with
-	 * more than five arguments you must add a `create` overload.
-	 */
-	template<typename Treturn, typename T1, typename T2, typename T3, typename T4, typename T5>
-	auto create(Signal<Treturn, T1, T2, T3, T4, T5> & sig)
+	template<typename Treturn, typename ...Targs>
+	auto create(Signal<Treturn, Targs...> & sig)
 	{
-		using namespace std::placeholders;
-		auto fn = std::bind(&Signal<Treturn, T1, T2, T3, T4, T5>::emit, &sig, _1, _2, _3, _4, _5);
-		return create(std::function<Treturn (T1, T2, T3, T4, T5)>(fn));
+		return typename GenericSlot<Treturn (Targs...)>::ptr(
+			new SignalSlot<Signal<Treturn, Targs...>, Treturn, Targs...>(sig));
 	}
 
 	/**
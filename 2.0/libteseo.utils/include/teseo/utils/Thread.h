@@ -29,6 +29,8 @@
 #ifndef TESEO_HAL_THREAD_H
 #define TESEO_HAL_THREAD_H
 
+#include <atomic>
+#include <cstddef>
 #include <string>
 #include <pthread.h>
 
@@ -41,8 +43,43 @@ namespace priv {
 void threadStart(void * rawThreadPtr);
 } // namespace priv
 
+/**
+ * @brief      Scheduling settings of a thread
+ */
+struct ThreadSettings {
+	enum class Policy {
+		INHERIT, ///< Keep the policy of the creating thread
+		OTHER,   ///< SCHED_OTHER
+		BATCH,   ///< SCHED_BATCH
+		IDLE,    ///< SCHED_IDLE
+		FIFO,    ///< SCHED_FIFO, real-time
+		RR       ///< SCHED_RR, real-time
+	};
+
+	Policy policy = Policy::INHERIT;
+
+	/**
+	 * Real-time priority for FIFO and RR (1 to 99), nice value for OTHER and BATCH (-20 to 19)
+	 */
+	int priority = 0;
+
+	std::vector<unsigned int> affinity; ///< CPUs the thread may run on, empty for all CPUs
+
+	std::size_t stackSize = 0; ///< Stack size in bytes, 0 for the system default
+
+	/**
+	 * @brief      Parse a policy name: "other", "batch", "idle", "fifo", "rr", or empty to inherit
+	 *
+	 * @return     True if the name is valid
+	 */
+	static bool parsePolicy(const std::string & name, Policy & policy);
+};
+
 /**
  * @brief      Thread wrapper class
+ *
+ * @details    Threads are created by the create thread callback, with the settings registered for
+ * their name by setSettings().
  */
 class Thread {
 private:
@@ -50,7 +87,7 @@ private:
 
 	pthread_t handle; ///< Thread handle
 
-	bool running; ///< Flag that indicates if the thread is running
+	std::atomic<bool> running; ///< Flag that indicates if the thread is running, read by other threads
 
 	/**
 	 * Thread create callback type
@@ -117,6 +154,20 @@ public:
 	 */
 	static void setCreateThreadCb(CreateThreadCb cb);
 
+	/**
+	 * @brief      Register the settings of the threads with the given name
+	 *
+	 * @details    The settings are applied to the threads created afterwards by createPthread().
+	 */
+	static void setSettings(const std::string & name, const ThreadSettings & settings);
+
+	/**
+	 * @brief      Get the settings of the threads with the given name
+	 *
+	 * @return     The registered settings, default settings when none are registered
+	 */
+	static ThreadSettings getSettings(const std::string & name);
+
 	/**
 	 * @brief      Determines if the thread is running.
 	 *
@@ -143,8 +194,13 @@ public:
     typedef void (*threadEntryFunc)(void* ret);
 
     struct ThreadFuncArgs {
-        ThreadFuncArgs(void (*start)(void*), void* arg) : fptr(start), args(arg) {}
+        ThreadFuncArgs(const char* name, void (*start)(void*), void* arg) :
+            name(name), settings(getSettings(name)), fptr(start), args(arg) {}
 
+        /* thread name, used to log the settings errors */
+        std::string name;
+        /* settings applied by the thread before calling fptr */
+        ThreadSettings settings;
         /* pointer to the function of type void()(void*) that needs to be wrapped */
         threadEntryFunc fptr;
         /* argument for fptr to be called with */
@@ -154,21 +210,20 @@ public:
     /*
      * This method is simply a wrapper. It is required since pthread_create() requires an entry
      * function pointer of type void*()(void*) and the GNSS hal requires as input a function pointer of
-     * type void()(void*).
+     * type void()(void*). It applies the thread settings, and deletes the ThreadFuncArgs object when
+     * the thread exits.
      */
     static void* threadFunc(void* arg);
 
     /*
-     * This method is called by createThreadCb with a pointer to the vector that
-     * holds the pointers to the thread arguments. The arg and start parameters are
-     * first used to create a ThreadFuncArgs object which is then saved in the
-     * listArgs parameters. The created ThreadFuncArgs object is then used to invoke
-     * threadFunc() method which in-turn invokes pthread_create.
+     * This method is called by createThreadCb. The name, arg and start parameters are
+     * first used to create a ThreadFuncArgs object owned by the new thread. The
+     * created ThreadFuncArgs object is then used to invoke threadFunc() method which
+     * in-turn invokes pthread_create, with the stack size registered for the name.
      */
     static pthread_t createPthread(const char* name,
         void (*start)(void*),
-        void* arg,
-        std::vector<std::unique_ptr<ThreadFuncArgs>> * listArgs);
+        void* arg);
 
 };
 
@@ -33,6 +33,7 @@
 #include <iomanip>
 #include <sstream>
 #include "ByteVector.h"
+#include "ByteView.h"
 #include "optional.h"
 
 namespace stm {
@@ -67,15 +68,38 @@ std::optional<GnssUtcTime> parseTimestamp(const ByteVector & vec);
 /**
  * @brief      Convert a time and a date byte vector to a timestamp
  *
- * @details    The time format is 'hhmmss.msec'. The date format is 'DDMMYY' To output a complete timestamp we used the
- * current UTC date injected by the platform.
+ * @details    The time format is 'hhmmss.msec'. The date format is 'DDMMYY', years are in the
+ * 2000-2099 range. The conversion is pure arithmetic: no time zone, system call, lock or
+ * exception is involved.
  *
- * @param[in]  vecTime    Time byte vector to parse
- * @param[in]  vecDate    Date byte vector to parse
+ * @param[in]  vecTime    Time bytes to parse
+ * @param[in]  vecDate    Date bytes to parse
  *
- * @return     The parsed timestamp
+ * @return     The parsed UTC timestamp, or an empty value if a field is invalid
  */
-std::optional<GnssUtcTime> parseTimeAndDate(const ByteVector & vecTime, const ByteVector & vecDate);
+std::optional<GnssUtcTime> parseTimeAndDate(ByteView vecTime, ByteView vecDate);
+
+/**
+ * @brief      Get the number of days between 1970-01-01 and a date of the proleptic Gregorian calendar
+ *
+ * @param[in]  year   The year
+ * @param[in]  month  The month, from 1 to 12
+ * @param[in]  day    The day of the month, from 1 to 31
+ *
+ * @return     The number of days, negative before 1970
+ */
+constexpr int64_t daysFromCivil(int64_t year, unsigned int month, unsigned int day)
+{
+	// Years start in March so the leap day is the last day of the year
+	year -= month <= 2 ? 1 : 0;
+
+	const int64_t era = (year >= 0 ? year : year - 399) / 400;
+	const unsigned int yearOfEra = static_cast<unsigned int>(year - era * 400);
+	const unsigned int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+	const unsigned int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+	return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
 
 /**
  * @brief      Save the UTC time into the HAL memory
@@ -27,7 +27,8 @@
 
 #include "IByteStream.h"
 #include "Thread.h"
-#include "DebugOutputStream.h"
+#include "Capture.h"
+#include "ReceiveRing.h"
 
 namespace stm {
 namespace stream {
@@ -39,6 +40,16 @@ private:
 	 */
 	int fd;
 
+	/**
+	 * epoll instance watching the TTY and the wakeup event
+	 */
+	int epollFd;
+
+	/**
+	 * eventfd used to interrupt a blocked read
+	 */
+	int wakeupFd;
+
 	/**
 	 * TTY device name
 	 */
@@ -47,15 +58,27 @@ private:
 	/**
 	 * TTY speed
 	 */
-	unsigned int speedDevice;
+	std::atomic<unsigned int> speedDevice;
+
+	/**
+	 * Number of bytes read
+	 */
+	std::atomic<uint64_t> rxBytes;
+
+	/**
+	 * Receive buffer, chunk size depends on speedDevice
+	 */
+	ReceiveRing rxRing;
 
 	/**
 	 * Stream status
 	 */
 	ByteStreamStatus streamStatus;
 
-	debug::DebugOutputStream dbgRx;
-	debug::DebugOutputStream dbgTx;
+	/**
+	 * RX/TX capture, disabled when null
+	 */
+	std::shared_ptr<capture::CaptureRecorder> recorder;
 
 	unsigned int openCount;
 
@@ -81,11 +104,19 @@ protected:
 	/**
 	 * Read data from device
 	 *
-	 * @return Vector of bytes read
+	 * @return View over the bytes read, in the stream receive ring
 	 */
-	virtual ByteVector perform_read() noexcept(false);
+	virtual ByteView perform_read() noexcept(false);
 
-	virtual void perform_write(const ByteVectorPtr bytes) noexcept(false);
+	/**
+	 * Write a batch of messages to device with a single writev when possible
+	 */
+	virtual void perform_write(const std::vector<ByteVectorPtr> & messages) noexcept(false);
+
+	/**
+	 * @brief Interrupt a perform_read call waiting for incoming bytes
+	 */
+	virtual void wakeup() noexcept;
 
 public:
 	explicit UartByteStream(const std::string& ttyDevice, unsigned int speedDevice);
@@ -95,6 +126,21 @@ public:
 	virtual const std::string& name() const;
 
 	virtual ByteStreamStatus status() const;
+
+	virtual unsigned int baudrate() const;
+
+	virtual bool setBaudrate(unsigned int speed);
+
+	virtual uint64_t rxByteCount() const;
+
+	/**
+	 * @brief Record every byte read from and written to the device
+	 *
+	 * @details Must be called before the stream is started.
+	 *
+	 * @param rec The capture recorder, nullptr to disable the capture
+	 */
+	void setCaptureRecorder(std::shared_ptr<capture::CaptureRecorder> rec);
 };
 
 } // namespace stream
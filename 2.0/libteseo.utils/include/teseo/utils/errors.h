@@ -48,6 +48,10 @@ int pipe(int err);
 
 int write(int err);
 
+int epoll(int err);
+
+int eventfd(int err);
+
 } // namespace errors
 } // namespace stm
 
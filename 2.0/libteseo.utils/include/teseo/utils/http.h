@@ -28,6 +28,7 @@
 
 #include "result.h"
 #include "Thread.h"
+#include "EventLoop.h"
 
 #define USER_AGENT "hal-http-client"
 
@@ -111,8 +112,10 @@ private:
 
 /**
  * Initialize the HTTP utils library
+ *
+ * @param[in]  loop  Event loop serving the HTTP debug output stream
  */
-void http_init();
+void http_init(thread::EventLoop & loop);
 
 /**
  * Cleanup the HTTP utils library
@@ -21,9 +21,17 @@
 */
 #include <teseo/utils/IByteStream.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+
 #define LOG_TAG "teseo_hal_ByteStream"
 #include <log/log.h>
 
+// Maximum number of messages submitted to perform_write at once
+#define BYTE_STREAM_WRITER_MAX_BATCH 64
+
 namespace stm {
 namespace stream {
 
@@ -37,11 +45,13 @@ void ByteStreamReader::run()
 		return;
 	}
 
-	runReader = true;
 	while(runReader)
 	{
-		auto bv = byteStream.perform_read();
-		byteStream.newBytes(bv);
+		ByteView bytes = byteStream.perform_read();
+
+		// An empty read means the stream was woken up without data (stop request)
+		if(!bytes.empty())
+			byteStream.newBytes(bytes);
 	}
 }
 
@@ -51,14 +61,61 @@ ByteStreamReader::ByteStreamReader(IByteStream & bs) :
 	runReader(true)
 { }
 
+int ByteStreamReader::start()
+{
+	runReader = true;
+	return Thread::start();
+}
+
 int ByteStreamReader::stop()
 {
 	runReader = false;
+	byteStream.wakeup();
 	return 0;
 }
 
+/**
+ * Sentences uploading assistance data, written in the BULK lane
+ */
+static const char * const bulkSentences[] = {
+	"PSTMEPHEM",
+	"PSTMALMANAC",
+	"PSTMSTAGPSSATSEED"
+};
+
+WriteLane ByteStreamWriter::laneOf(const ByteVector & bytes)
+{
+	std::size_t start = (!bytes.empty() && bytes[0] == '$') ? 1 : 0;
+
+	for(const char * id : bulkSentences)
+	{
+		std::size_t len = std::strlen(id);
+
+		// The sentence id must be followed by a separator, PSTMEPHEM isn't PSTMEPHEMX
+		if(bytes.size() > start + len &&
+			std::memcmp(bytes.data() + start, id, len) == 0 &&
+			(bytes[start + len] == ',' || bytes[start + len] == '*'))
+		{
+			return WriteLane::BULK;
+		}
+	}
+
+	return WriteLane::CONTROL;
+}
+
+/**
+ * Time needed to transmit `count` bytes at `baudrate` (10 bits per byte on the wire)
+ */
+static std::chrono::microseconds wireTime(std::size_t count, unsigned int baudrate)
+{
+	return std::chrono::microseconds(
+		static_cast<std::chrono::microseconds::rep>(count) * 10 * 1000000 / baudrate);
+}
+
 void ByteStreamWriter::run()
 {
+	using Clock = std::chrono::steady_clock;
+
 	ByteStreamOpener<true> bsOpener(byteStream);
 
 	if(!bsOpener)
@@ -67,18 +124,75 @@ void ByteStreamWriter::run()
 		return;
 	}
 
+	std::vector<ByteVectorPtr> pending;
+	std::vector<ByteVectorPtr> batch;
+	std::deque<ByteVectorPtr> bulk;
+	Clock::time_point lineFreeAt = Clock::now();
 	bool runWriter = true;
+
 	while(runWriter)
 	{
-		switch(com.receive())
-		{
-			case WRITE:
-				byteStream.perform_write(dataChannel.receive());
-				break;
+		// Drain everything queued since last write, a burst of commands becomes one batch.
+		// While bulk data is waiting, only wait until the line is expected to be free.
+		pending.clear();
+		if(bulk.empty())
+			queue.receiveMany(pending, BYTE_STREAM_WRITER_MAX_BATCH);
+		else
+			queue.receiveMany(pending, lineFreeAt - Clock::now(), BYTE_STREAM_WRITER_MAX_BATCH);
 
-			case STOP:
+		batch.clear();
+		for(auto & bytes : pending)
+		{
+			if(!bytes)
+			{
 				runWriter = false;
 				break;
+			}
+
+			if(bytes->empty())
+				continue;
+
+			if(laneOf(*bytes) == WriteLane::BULK)
+				bulk.push_back(bytes);
+			else
+				batch.push_back(bytes);
+		}
+
+		if(!runWriter)
+		{
+			if(!bulk.empty())
+				ALOGW("Writer stopped, drop %zu pending bulk messages", bulk.size());
+
+			bulk.clear();
+		}
+
+		unsigned int baudrate = byteStream.baudrate();
+		Clock::time_point now = Clock::now();
+
+		// Without line speed there is nothing to pace against, bulk follows control
+		if(baudrate == 0)
+		{
+			batch.insert(batch.end(), bulk.begin(), bulk.end());
+			bulk.clear();
+		}
+		else if(!bulk.empty() && now >= lineFreeAt)
+		{
+			batch.push_back(bulk.front());
+			bulk.pop_front();
+		}
+
+		if(batch.empty())
+			continue;
+
+		byteStream.perform_write(batch);
+
+		if(baudrate != 0)
+		{
+			std::size_t count = 0;
+			for(const auto & bytes : batch)
+				count += bytes->size();
+
+			lineFreeAt = std::max(lineFreeAt, now) + wireTime(count, baudrate);
 		}
 	}
 }
@@ -86,20 +200,19 @@ void ByteStreamWriter::run()
 ByteStreamWriter::ByteStreamWriter(IByteStream & bs) :
 	Thread("ByteStreamWriter"),
 	byteStream(bs),
-	com("ByteStreamWriter::com"),
-	dataChannel("ByteStreamWriter::dataChannel")
+	queue("ByteStreamWriter::queue")
 { }
 
 int ByteStreamWriter::stop()
 {
-	com << STOP;
+	queue << ByteVectorPtr();
 	return 0;
 }
 
 void ByteStreamWriter::write(const ByteVectorPtr bytes)
 {
-	dataChannel << bytes;
-	com << WRITE;
+	if(bytes)
+		queue << bytes;
 }
 
 AbstractByteStream::AbstractByteStream() :
@@ -0,0 +1,81 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Pool of reusable byte buffers
+ * @file BufferPool.cpp
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#include <teseo/utils/BufferPool.h>
+
+#include <atomic>
+
+namespace stm {
+namespace stream {
+
+BufferPool::BufferPool(std::size_t count, std::size_t capacity) :
+	next(0),
+	misses(0)
+{
+	buffers.reserve(count);
+
+	for(std::size_t i = 0; i < count; i++)
+	{
+		buffers.push_back(std::make_shared<ByteVector>());
+		buffers.back()->reserve(capacity);
+	}
+}
+
+ByteVectorPtr BufferPool::acquire()
+{
+	for(std::size_t i = 0; i < buffers.size(); i++)
+	{
+		ByteVectorPtr & buffer = buffers[next];
+		next = (next + 1) % buffers.size();
+
+		// The pool holds the only reference: nobody else can take a new one, the buffer is free
+		if(buffer.use_count() == 1)
+		{
+			// Synchronize with the release of the last user before reusing the storage
+			std::atomic_thread_fence(std::memory_order_acquire);
+			buffer->clear();
+			return buffer;
+		}
+	}
+
+	misses++;
+	return std::make_shared<ByteVector>();
+}
+
+std::size_t BufferPool::size() const
+{
+	return buffers.size();
+}
+
+uint64_t BufferPool::missCount() const
+{
+	return misses;
+}
+
+} // namespace stream
+} // namespace stm
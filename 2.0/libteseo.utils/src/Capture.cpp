@@ -0,0 +1,369 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Byte stream capture format
+ * @file Capture.cpp
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#include <teseo/utils/Capture.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LOG_TAG "teseo_hal_Capture"
+#include <log/log.h>
+
+#include <teseo/utils/errors.h>
+
+namespace stm {
+namespace stream {
+namespace capture {
+
+CaptureReader::CaptureReader() :
+	base(nullptr),
+	size(0),
+	offset(0),
+	end(0),
+	secondStart(0),
+	secondEnd(0),
+	raw(false),
+	rawBaudrate(0),
+	rawTimestamp(0)
+{ }
+
+CaptureReader::~CaptureReader()
+{
+	close();
+}
+
+bool CaptureReader::open(const std::string & path, unsigned int baudrate)
+{
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	CHECK_ERROR(fd, errors::open, "Capture %s opened.", path.c_str());
+
+	if(fd == -1)
+		return false;
+
+	struct stat st;
+	if(fstat(fd, &st) == -1 || st.st_size == 0)
+	{
+		ALOGE("Capture %s is empty or can't be read.", path.c_str());
+		::close(fd);
+		return false;
+	}
+
+	void * map = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if(map == MAP_FAILED)
+	{
+		ALOGE("Unable to map capture %s: %s", path.c_str(), strerror(errno));
+		return false;
+	}
+
+	base = static_cast<const uint8_t *>(map);
+	size = static_cast<std::size_t>(st.st_size);
+	rawBaudrate = baudrate;
+
+	const FileHeader * header = reinterpret_cast<const FileHeader *>(base);
+	raw = size < sizeof(FileHeader) || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0;
+
+	if(!raw && header->version > VERSION)
+		ALOGW("Capture %s version %u is newer than supported version %u.",
+			path.c_str(), header->version, VERSION);
+
+	rewind();
+	return true;
+}
+
+void CaptureReader::close()
+{
+	if(base)
+	{
+		munmap(const_cast<uint8_t *>(base), size);
+		base = nullptr;
+		size = 0;
+	}
+}
+
+bool CaptureReader::isOpen() const
+{
+	return base != nullptr;
+}
+
+void CaptureReader::rewind()
+{
+	rawTimestamp = std::chrono::nanoseconds(0);
+	offset = 0;
+	end = size;
+	secondStart = 0;
+	secondEnd = 0;
+
+	if(raw || !base)
+		return;
+
+	const FileHeader * header = reinterpret_cast<const FileHeader *>(base);
+	offset = std::min<std::size_t>(header->headerSize, size);
+
+	// Headers without the rolling fields, or linear captures
+	if(header->headerSize < sizeof(FileHeader) || header->next == 0)
+		return;
+
+	if(header->wrap == 0)
+	{
+		offset = std::min<std::size_t>(header->oldest, size);
+		end = std::min<std::size_t>(header->next, size);
+	}
+	else
+	{
+		offset = std::min<std::size_t>(header->oldest, size);
+		end = std::min<std::size_t>(header->wrap, size);
+		secondStart = header->headerSize;
+		secondEnd = std::min<std::size_t>(header->next, size);
+	}
+}
+
+bool CaptureReader::nextRaw(Record & record)
+{
+	if(offset >= size)
+		return false;
+
+	// One record per line, the last line may miss its line feed
+	const uint8_t * start = base + offset;
+	const void * lf = std::memchr(start, '\n', size - offset);
+	std::size_t length = lf ? static_cast<const uint8_t *>(lf) - start + 1 : size - offset;
+
+	record.timestamp = rawTimestamp;
+	record.direction = Direction::RX;
+	record.bytes = ByteView(start, length);
+
+	offset += length;
+
+	// Next line arrives once this one is on the wire, 10 bits per byte
+	if(rawBaudrate != 0)
+		rawTimestamp += std::chrono::nanoseconds(
+			static_cast<std::chrono::nanoseconds::rep>(length) * 10 * 1000000000 / rawBaudrate);
+
+	return true;
+}
+
+bool CaptureReader::next(Record & record)
+{
+	if(!base)
+		return false;
+
+	if(raw)
+		return nextRaw(record);
+
+	RecordHeader header;
+
+	while(true)
+	{
+		if(offset < end && end - offset >= sizeof(RecordHeader))
+		{
+			std::memcpy(&header, base + offset, sizeof(header));
+
+			if(end - offset - sizeof(RecordHeader) >= header.length)
+				break;
+
+			ALOGW("Truncated capture record at offset %zu", offset);
+		}
+
+		// End of the first segment of a wrapped capture, continue with the newest records
+		if(secondEnd <= secondStart)
+		{
+			offset = end;
+			return false;
+		}
+
+		offset = secondStart;
+		end = secondEnd;
+		secondStart = 0;
+		secondEnd = 0;
+	}
+
+	record.timestamp = std::chrono::nanoseconds(header.timestamp);
+	record.direction = static_cast<Direction>(header.direction);
+	record.bytes = ByteView(base + offset + sizeof(RecordHeader), header.length);
+
+	offset += sizeof(RecordHeader) + header.length;
+	return true;
+}
+
+constexpr std::size_t CaptureRecorder::MIN_SIZE;
+
+CaptureRecorder::CaptureRecorder() :
+	base(nullptr),
+	size(0),
+	header(nullptr)
+{ }
+
+CaptureRecorder::~CaptureRecorder()
+{
+	close();
+}
+
+bool CaptureRecorder::open(const std::string & path, std::size_t maxSize)
+{
+	close();
+
+	maxSize = std::max(maxSize, MIN_SIZE);
+
+	int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+	CHECK_ERROR(fd, errors::open, "Capture %s created.", path.c_str());
+
+	if(fd == -1)
+		return false;
+
+	if(ftruncate(fd, static_cast<off_t>(maxSize)) == -1)
+	{
+		ALOGE("Unable to size capture %s: %s", path.c_str(), strerror(errno));
+		::close(fd);
+		return false;
+	}
+
+	void * map = mmap(nullptr, maxSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if(map == MAP_FAILED)
+	{
+		ALOGE("Unable to map capture %s: %s", path.c_str(), strerror(errno));
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	base = static_cast<uint8_t *>(map);
+	size = maxSize;
+	header = reinterpret_cast<FileHeader *>(base);
+
+	std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+	header->version = VERSION;
+	header->headerSize = sizeof(FileHeader);
+	header->oldest = sizeof(FileHeader);
+	header->wrap = 0;
+	header->next = sizeof(FileHeader);
+	header->dropped = 0;
+
+	ALOGI("Capture %s: %zu bytes rolling file", path.c_str(), maxSize);
+	return true;
+}
+
+void CaptureRecorder::close()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(base)
+	{
+		munmap(base, size);
+		base = nullptr;
+		header = nullptr;
+		size = 0;
+	}
+}
+
+bool CaptureRecorder::isOpen() const
+{
+	return base != nullptr;
+}
+
+std::size_t CaptureRecorder::recordSizeAt(std::size_t offset) const
+{
+	RecordHeader record;
+	std::memcpy(&record, base + offset, sizeof(record));
+	return sizeof(RecordHeader) + record.length;
+}
+
+void CaptureRecorder::reserve(std::size_t count)
+{
+	while(true)
+	{
+		if(header->wrap != 0)
+		{
+			// Release the oldest records overlapped by the new one
+			while(header->oldest < header->wrap && header->oldest < header->next + count)
+				header->oldest += recordSizeAt(header->oldest);
+
+			if(header->oldest < header->wrap)
+				return;
+
+			// All records of the previous lap are released
+			header->oldest = header->headerSize;
+			header->wrap = 0;
+		}
+
+		if(header->next + count <= size)
+			return;
+
+		// Not enough room before the end of the file, start a new lap
+		header->wrap = header->next;
+		header->next = header->headerSize;
+	}
+}
+
+void CaptureRecorder::append(Direction direction, ByteView bytes)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	append(std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec), direction, bytes);
+}
+
+void CaptureRecorder::append(std::chrono::nanoseconds timestamp, Direction direction, ByteView bytes)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(!base || bytes.empty())
+		return;
+
+	std::size_t count = sizeof(RecordHeader) + bytes.size();
+	if(count > size - header->headerSize)
+	{
+		header->dropped++;
+		return;
+	}
+
+	reserve(count);
+
+	RecordHeader record = {};
+	record.timestamp = static_cast<uint64_t>(timestamp.count());
+	record.length = static_cast<uint32_t>(bytes.size());
+	record.direction = static_cast<uint8_t>(direction);
+
+	std::memcpy(base + header->next, &record, sizeof(record));
+	std::memcpy(base + header->next + sizeof(record), bytes.data(), bytes.size());
+	header->next += count;
+}
+
+} // namespace capture
+} // namespace stream
+} // namespace stm
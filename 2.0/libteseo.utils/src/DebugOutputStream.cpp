@@ -28,6 +28,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
+#include <errno.h>
 
 #define LOG_TAG "teseo_hal_debugOutputStream"
 #include <log/log.h>
@@ -52,9 +53,22 @@ void TcpClientSocket::send(const ByteVector & data)
 	ssize_t res = write(sockfd, data.data(), data.size());
 	if(res < 0)
 	{
+		// The socket is non-blocking, don't wait for slow clients
+		if(errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			ALOGW("Client is too slow, drop %zu bytes.", data.size());
+			return;
+		}
+
 		ALOGE("Error while writing to socket. Close it.");
 		close();
 	}
+	else if(static_cast<std::size_t>(res) < data.size())
+	{
+		// The rest of the message would be lost, the next one would be glued to a truncated one
+		ALOGW("Client is too slow, only %zd of %zu bytes written. Close it.", res, data.size());
+		close();
+	}
 }
 
 bool TcpClientSocket::opened()
@@ -76,7 +90,7 @@ bool TcpServerSocket::open()
 	if(sockfd >= 0)
 		return true;
 
-	sockfd = socket(AF_INET, SOCK_STREAM, 0);
+	sockfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
 	if(sockfd < 0)
 	{
 		ALOGE("Can't open socket");
@@ -109,132 +123,77 @@ void TcpServerSocket::close()
 	}
 }
 
-void TcpServerSocket::run()
+void TcpServerSocket::accept()
 {
-	if(open())
-	{
-		bool stopListening = false;
-		struct sockaddr clientAddr;
-		socklen_t sockLen = sizeof(struct sockaddr);
-		memset(&clientAddr, 0, sizeof(struct sockaddr));
-
-		listen(sockfd, 5);
+	struct sockaddr clientAddr;
+	socklen_t sockLen = sizeof(struct sockaddr);
+	memset(&clientAddr, 0, sizeof(struct sockaddr));
 
-		while(!stopListening)
-		{
-			int clientSockFd = accept(sockfd, (struct sockaddr *) &clientAddr, &sockLen);
-			if(clientSockFd < 1)
-			{
-				stopListening = true;
-				ALOGE("Error while accepting client, stop listening");
-			}
-			else
-			{
-				auto clientPtr = std::make_shared<TcpClientSocket>(clientSockFd);
-				ALOGV("New client connected");
-				// Save weak_ptr to new client
-				clients.push_back(clientPtr);
-				// Signal new client
-				newClient(clientPtr);
-			}
-		}
+	int clientSockFd;
 
-		close();
-	}
-	else
+	while((clientSockFd = accept4(sockfd, &clientAddr, &sockLen, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
 	{
-		ALOGE("Error while opening socket");
+		ALOGV("New client connected");
+		newClient(std::make_shared<TcpClientSocket>(clientSockFd));
 	}
-}
 
-TcpServerSocket::TcpServerSocket(uint16_t port) :
-	Thread("TcpServerSocket")
-{
-	this->port = port;
-	this->sockfd = -1;
+	if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		ALOGE("Error while accepting client: %s", strerror(errno));
 }
 
+TcpServerSocket::TcpServerSocket(uint16_t port, thread::EventLoop & loop) :
+	port(port),
+	sockfd(-1),
+	loop(loop)
+{ }
+
 TcpServerSocket::~TcpServerSocket()
 {
 	stop();
-	join();
 }
 
-int TcpServerSocket::stop()
+bool TcpServerSocket::start()
 {
-	if(isRunning())
+	if(!open())
 	{
-		// Disconnect clients
-		for(auto clientPtr : clients)
-		{
-			if(!clientPtr.expired())
-			{
-				clientPtr.lock()->close();
-			}
-		}
-
-		// Shutdown socket
-		shutdown(sockfd, SHUT_RDWR);
+		ALOGE("Error while opening socket");
+		return false;
 	}
 
-	return 0;
-}
-
-void DebugOutputStream::run()
-{
-	if(!socket.start())
+	if(listen(sockfd, 5) < 0 || !loop.watch(sockfd, EPOLLIN, [this] (uint32_t) { accept(); }))
 	{
-		ALOGE("Error while opening socket exiting");
-		return;
+		ALOGE("Error while listening on port: %d", port);
+		close();
+		return false;
 	}
 
-	ByteVector buffer;
-	bool stopLoop = false;
-	Message msg;
-	int i = 0;
+	return true;
+}
 
-	while(!stopLoop)
+int TcpServerSocket::stop()
+{
+	if(sockfd >= 0)
 	{
-		com >> msg;
-
-		switch(msg.command)
-		{
-			case Control::SEND:
-				i = 0;
-				for(auto client: clients)
-				{
-					if(client->opened())
-						client->send(buffer);
-				}
-				break;
-
-			case Control::CLEAR:
-				buffer.clear();
-				break;
-
-			case Control::STOP:
-				stopLoop = true;
-				break;
-
-			case Control::APPEND:
-				buffer.push_back(msg.data);
-				break;
-		}
+		// Waits for a running accept
+		loop.unwatch(sockfd);
+		close();
 	}
 
-	socket.stop();
-	socket.join();
+	return 0;
 }
 
-DebugOutputStream::DebugOutputStream(uint16_t port) :
-	Thread("DebugOutputStream"),
-	socket(port),
-	com("DebugOutputStream::com")
+DebugOutputStream::DebugOutputStream(uint16_t port, thread::EventLoop & loop) :
+	loop(loop),
+	socket(port, loop),
+	clients(std::make_shared<Clients>())
 {
+	std::shared_ptr<Clients> state = clients;
+
 	socket.newClient.connect(SlotFactory::create(
 		std::function<void(std::shared_ptr<TcpClientSocket>)>(
-			[this] (std::shared_ptr<TcpClientSocket> client) {
-				this->clients.push_back(client);
+			[state] (std::shared_ptr<TcpClientSocket> client) {
+				std::lock_guard<std::mutex> lock(state->mutex);
+				state->list.push_back(client);
 			})
 		)
 	);
@@ -243,71 +202,76 @@ DebugOutputStream::DebugOutputStream(uint16_t port) :
 DebugOutputStream::~DebugOutputStream()
 {
 	stop();
-	join();
 }
 
 int DebugOutputStream::start()
 {
-	return static_cast<Thread *>(this)->start();
+	if(!socket.start())
+	{
+		ALOGE("Error while opening socket");
+		return 1;
+	}
+
+	return 0;
 }
 
 int DebugOutputStream::stop()
 {
-	if(isRunning())
-	{
-		com << Message { Control::STOP, 0 };
-	}
+	socket.stop();
+
+	std::lock_guard<std::mutex> lock(clients->mutex);
+
+	for(auto & client : clients->list)
+		client->close();
+
+	clients->list.clear();
 
 	return 0;
 }
 
+void DebugOutputStream::post(ByteVectorPtr message)
+{
+	std::shared_ptr<Clients> state = clients;
+
+	// Written from the loop thread, the message is dropped if the loop is stopped
+	loop.post([state, message] {
+		std::lock_guard<std::mutex> lock(state->mutex);
+
+		for(auto & client : state->list)
+		{
+			if(client->opened())
+				client->send(*message);
+		}
+
+		state->list.remove_if([] (const std::shared_ptr<TcpClientSocket> & client) {
+			return !client->opened();
+		});
+	});
+}
+
 void DebugOutputStream::send(const char * data, std::size_t count)
 {
-	for(std::size_t i = 0; i < count; i++)
-	{
-		com << Message { Control::APPEND, static_cast<uint8_t>(data[i]) };
-	}
-	
-	com << Message { Control::SEND, 0 };
-	com << Message { Control::CLEAR, 0 };
+	send(reinterpret_cast<const uint8_t *>(data), count);
 }
 
 void DebugOutputStream::send(const uint8_t * data, std::size_t count)
 {
-	for(std::size_t i = 0; i < count; i++)
-	{
-		com << Message { Control::APPEND, data[i] };
-	}
-	
-	com << Message { Control::SEND, 0 };
-	com << Message { Control::CLEAR, 0 };
+	post(std::make_shared<ByteVector>(data, data + count));
 }
 
 void DebugOutputStream::send(const ByteVector & data)
 {
-	for(uint8_t b : data)
-	{
-		com << Message { Control::APPEND, b };
-	}
-	
-	com << Message { Control::SEND, 0 };
-	com << Message { Control::CLEAR, 0 };
+	post(std::make_shared<ByteVector>(data));
 }
 
 void DebugOutputStream::send(const std::string & data)
 {
-	for(auto ch: data)
-	{
-		com << Message { Control::APPEND, ch };
-	}
-
-	com << Message { Control::SEND, 0 };
-	com << Message { Control::CLEAR, 0 };
+	send(data.data(), data.size());
 }
 
 #else // ifdef ENABLE_DEBUG_OUTPUT_STREAM
 // Empty implementation of DebugOutputStream
-DebugOutputStream::DebugOutputStream(uint16_t)
+DebugOutputStream::DebugOutputStream(uint16_t, thread::EventLoop &)
 { }
 
 DebugOutputStream::~DebugOutputStream()
@@ -334,14 +298,6 @@ void DebugOutputStream::send(const ByteVector &)
 
 void DebugOutputStream::send(const std::string &)
 { }
-
-void DebugOutputStream::join()
-{ }
-	
-bool DebugOutputStream::isRunning() const
-{
-	return false;
-}
 #endif // ifdef ENABLE_DEBUG_OUTPUT_STREAM
 
 
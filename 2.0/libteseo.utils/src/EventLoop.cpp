@@ -0,0 +1,551 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Event loop and worker pool shared by the HAL components
+ * @file EventLoop.cpp
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#include <teseo/utils/EventLoop.h>
+
+#define LOG_TAG "teseo_hal_EventLoop"
+#include <log/log.h>
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include <teseo/utils/errors.h>
+
+namespace stm {
+namespace thread {
+
+/**
+ * Number of jobs waiting for a worker before submit() blocks
+ */
+static constexpr std::size_t EVENT_LOOP_JOB_CAPACITY = 64;
+
+/**
+ * Maximum number of events handled per epoll_wait call
+ */
+static constexpr int EVENT_LOOP_MAX_EVENTS = 16;
+
+void LatencyStats::add(std::chrono::nanoseconds latency)
+{
+	count++;
+	total += latency;
+	max = std::max(max, latency);
+}
+
+std::chrono::nanoseconds LatencyStats::mean() const
+{
+	return count == 0 ? std::chrono::nanoseconds(0) : total / static_cast<int64_t>(count);
+}
+
+EventLoop::Worker::Worker(EventLoop & loop, const char * name) :
+	Thread(name),
+	loop(loop)
+{ }
+
+void EventLoop::Worker::run()
+{
+	PostedTask job;
+
+	// An empty job stops the worker
+	while(loop.jobs.receive(job) && job.task)
+	{
+		loop.record(&Stats::jobs, job.posted);
+
+		try
+		{
+			job.task();
+		}
+		catch(const std::exception & ex)
+		{
+			ALOGE("Event loop %s: exception in a job: %s", loop.loopName.c_str(), ex.what());
+		}
+
+		job.task = nullptr;
+	}
+}
+
+int EventLoop::Worker::stop()
+{
+	return loop.jobs.send(PostedTask()) ? 0 : -1;
+}
+
+EventLoop::EventLoop(const char * name, std::size_t workerCount) :
+	Thread(name),
+	loopName(name),
+	workerName(std::string(name) + "-worker"),
+	active(false),
+	stopRequested(false),
+	dispatchingFd(-1),
+	jobs("EventLoop::jobs", EVENT_LOOP_JOB_CAPACITY),
+	statistics()
+{
+	epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+	CHECK_ERROR(epollFd, errors::epoll, "Event loop %s epoll instance created.", name);
+
+	wakeupFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	CHECK_ERROR(wakeupFd, errors::eventfd, "Event loop %s wakeup event created.", name);
+
+	if(epollFd != -1 && wakeupFd != -1)
+	{
+		struct epoll_event ev = {};
+		ev.events = EPOLLIN;
+		ev.data.fd = wakeupFd;
+
+		auto ret = ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &ev);
+		CHECK_ERROR(ret, errors::epoll, "Event loop %s wakeup event registered.", name);
+	}
+
+	// Submitted jobs would never run without worker
+	workerCount = std::max<std::size_t>(workerCount, 1);
+
+	for(std::size_t i = 0; i < workerCount; i++)
+		workers.emplace_back(new Worker(*this, workerName.c_str()));
+
+	posted.reserve(16);
+	running.reserve(16);
+}
+
+EventLoop::~EventLoop()
+{
+	if(isRunning())
+	{
+		stop();
+		join();
+	}
+
+	for(const auto & entry : registrations)
+	{
+		if(entry.second->timer)
+			::close(entry.first);
+	}
+
+	if(wakeupFd != -1)
+		::close(wakeupFd);
+
+	if(epollFd != -1)
+		::close(epollFd);
+}
+
+bool EventLoop::isActive() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return active;
+}
+
+bool EventLoop::isLoopThread() const
+{
+	return loopThread.load() == std::this_thread::get_id();
+}
+
+void EventLoop::wakeup()
+{
+	uint64_t one = 1;
+	// The counter can't overflow in practice, the return value is irrelevant
+	(void)::write(wakeupFd, &one, sizeof(one));
+}
+
+void EventLoop::record(LatencyStats Stats::* stats, Clock::time_point expected)
+{
+	auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - expected);
+
+	std::lock_guard<std::mutex> lock(statsMutex);
+	(statistics.*stats).add(std::max(latency, std::chrono::nanoseconds(0)));
+}
+
+bool EventLoop::post(Task task)
+{
+	bool wasEmpty;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(!active)
+			return false;
+
+		wasEmpty = posted.empty();
+		posted.push_back({std::move(task), Clock::now()});
+	}
+
+	// The loop drains all the posted tasks on wake up, one wake up is enough
+	if(wasEmpty)
+		wakeup();
+
+	return true;
+}
+
+bool EventLoop::submit(Task job)
+{
+	if(!isActive())
+		return false;
+
+	return jobs.send(PostedTask{std::move(job), Clock::now()});
+}
+
+bool EventLoop::addRegistration(int fd, uint32_t events, const std::shared_ptr<Registration> & registration)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(registrations.count(fd) != 0)
+	{
+		ALOGE("Event loop %s: file descriptor %d is already watched", loopName.c_str(), fd);
+		return false;
+	}
+
+	struct epoll_event ev = {};
+	ev.events = events;
+	ev.data.fd = fd;
+
+	if(::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == -1)
+	{
+		errors::epoll(errno);
+		return false;
+	}
+
+	registrations[fd] = registration;
+	return true;
+}
+
+bool EventLoop::watch(int fd, uint32_t events, FdCallback callback)
+{
+	auto registration = std::make_shared<Registration>();
+	registration->callback = std::move(callback);
+	registration->timer = false;
+	registration->period = Clock::duration::zero();
+
+	return addRegistration(fd, events, registration);
+}
+
+void EventLoop::unwatch(int fd)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if(registrations.erase(fd) == 0)
+		return;
+
+	// The descriptor may already be closed, the error is irrelevant
+	(void)::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+
+	if(!isLoopThread())
+		dispatched.wait(lock, [this, fd] { return dispatchingFd != fd; });
+}
+
+EventLoop::TimerId EventLoop::addTimer(
+	std::chrono::milliseconds delay,
+	std::chrono::milliseconds period,
+	Task callback)
+{
+	int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+
+	if(fd == -1)
+	{
+		ALOGE("Event loop %s: unable to create a timer, errno: %d", loopName.c_str(), errno);
+		return -1;
+	}
+
+	if(delay < std::chrono::milliseconds::zero())
+		delay = std::chrono::milliseconds::zero();
+
+	auto expiry = Clock::now() + delay;
+
+	struct itimerspec spec = {};
+	spec.it_value.tv_sec = delay.count() / 1000;
+	// A zero it_value disarms the timer, expire after 1 ns instead
+	spec.it_value.tv_nsec = (delay.count() % 1000) * 1000000 + (delay.count() == 0 ? 1 : 0);
+	spec.it_interval.tv_sec = period.count() / 1000;
+	spec.it_interval.tv_nsec = (period.count() % 1000) * 1000000;
+
+	if(::timerfd_settime(fd, 0, &spec, nullptr) == -1)
+	{
+		ALOGE("Event loop %s: unable to arm a timer, errno: %d", loopName.c_str(), errno);
+		::close(fd);
+		return -1;
+	}
+
+	auto registration = std::make_shared<Registration>();
+	registration->callback = [callback](uint32_t) { callback(); };
+	registration->timer = true;
+	registration->period = period;
+	registration->expiry = expiry;
+
+	if(!addRegistration(fd, EPOLLIN, registration))
+	{
+		::close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+void EventLoop::cancelTimer(TimerId timer)
+{
+	if(timer < 0)
+		return;
+
+	bool found;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = registrations.find(timer);
+		found = it != registrations.end() && it->second->timer;
+	}
+
+	if(!found)
+		return;
+
+	unwatch(timer);
+	::close(timer);
+}
+
+EventLoop::Stats EventLoop::stats() const
+{
+	std::lock_guard<std::mutex> lock(statsMutex);
+	return statistics;
+}
+
+void EventLoop::runPosted()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::swap(posted, running);
+	}
+
+	for(auto & p : running)
+	{
+		record(&Stats::tasks, p.posted);
+
+		try
+		{
+			p.task();
+		}
+		catch(const std::exception & ex)
+		{
+			ALOGE("Event loop %s: exception in a task: %s", loopName.c_str(), ex.what());
+		}
+	}
+
+	running.clear();
+}
+
+void EventLoop::dispatch(int fd, uint32_t events)
+{
+	std::shared_ptr<Registration> registration;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = registrations.find(fd);
+
+		// Unwatched after epoll_wait returned
+		if(it == registrations.end())
+			return;
+
+		registration = it->second;
+		dispatchingFd = fd;
+	}
+
+	bool callbackDue = true;
+
+	if(registration->timer)
+	{
+		uint64_t expirations = 0;
+
+		if(::read(fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+			callbackDue = false;
+
+		if(callbackDue)
+		{
+			record(&Stats::timers, registration->expiry);
+
+			if(registration->period != Clock::duration::zero())
+				registration->expiry += registration->period * expirations;
+		}
+	}
+
+	if(callbackDue)
+	{
+		try
+		{
+			registration->callback(events);
+		}
+		catch(const std::exception & ex)
+		{
+			ALOGE("Event loop %s: exception in a callback: %s", loopName.c_str(), ex.what());
+		}
+	}
+
+	bool expired = registration->timer && callbackDue && registration->period == Clock::duration::zero();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		dispatchingFd = -1;
+
+		// One shot timer, release it unless the callback already did
+		if(expired && registrations.count(fd) != 0 && registrations[fd] == registration)
+		{
+			registrations.erase(fd);
+			(void)::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+			::close(fd);
+		}
+	}
+
+	dispatched.notify_all();
+}
+
+void EventLoop::startWorkers()
+{
+	for(auto & worker : workers)
+	{
+		if(worker->start() != 0)
+			ALOGE("Event loop %s: unable to start a worker", loopName.c_str());
+	}
+}
+
+void EventLoop::stopWorkers()
+{
+	// Each worker ends on its empty job, after the jobs queued before
+	for(auto & worker : workers)
+		worker->stop();
+
+	for(auto & worker : workers)
+		worker->join();
+}
+
+void EventLoop::run()
+{
+	ALOGI("Start event loop %s", loopName.c_str());
+
+	if(epollFd == -1 || wakeupFd == -1)
+	{
+		ALOGE("Event loop %s can't run without epoll and eventfd", loopName.c_str());
+		return;
+	}
+
+	loopThread = std::this_thread::get_id();
+	startWorkers();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		active = true;
+	}
+
+	struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+	bool stopping = false;
+
+	while(!stopping)
+	{
+		int count = ::epoll_wait(epollFd, events, EVENT_LOOP_MAX_EVENTS, -1);
+
+		if(count == -1)
+		{
+			if(errno == EINTR)
+				continue;
+
+			errors::epoll(errno);
+			break;
+		}
+
+		for(int i = 0; i < count; i++)
+		{
+			if(events[i].data.fd == wakeupFd)
+			{
+				uint64_t value;
+				// Reset the event counter, return value is irrelevant: the fd is non-blocking
+				(void)::read(wakeupFd, &value, sizeof(value));
+			}
+			else
+			{
+				dispatch(events[i].data.fd, events[i].events);
+			}
+		}
+
+		runPosted();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = stopRequested;
+	}
+
+	// Later tasks are dropped, run the pending ones and let the workers finish their jobs
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		active = false;
+		stopRequested = false;
+	}
+
+	runPosted();
+	stopWorkers();
+
+	// Jobs submitted while the workers were stopping
+	PostedTask job;
+
+	while(jobs.tryReceive(job))
+	{
+		if(job.task)
+			job.task();
+	}
+
+	loopThread = std::thread::id();
+
+	Stats s = stats();
+	ALOGI("End of event loop %s, latency of %llu tasks: mean %lld ns, max %lld ns; "
+		"%llu timers: mean %lld ns, max %lld ns; %llu jobs: mean %lld ns, max %lld ns",
+		loopName.c_str(),
+		static_cast<unsigned long long>(s.tasks.count),
+		static_cast<long long>(s.tasks.mean().count()), static_cast<long long>(s.tasks.max.count()),
+		static_cast<unsigned long long>(s.timers.count),
+		static_cast<long long>(s.timers.mean().count()), static_cast<long long>(s.timers.max.count()),
+		static_cast<unsigned long long>(s.jobs.count),
+		static_cast<long long>(s.jobs.mean().count()), static_cast<long long>(s.jobs.max.count()));
+}
+
+int EventLoop::stop()
+{
+	if(!isRunning())
+	{
+		ALOGW("Event loop %s is already stopped.", loopName.c_str());
+		return -1;
+	}
+
+	ALOGI("Stop event loop %s", loopName.c_str());
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopRequested = true;
+	}
+
+	wakeup();
+
+	return 0;
+}
+
+} // namespace thread
+} // namespace stm
@@ -0,0 +1,152 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Queued signal connections, delivered by an executor
+ * @file Executor.cpp
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#include <teseo/utils/Executor.h>
+
+#define LOG_TAG "teseo_hal_Executor"
+#include <log/log.h>
+
+#include <utility>
+
+namespace stm {
+namespace thread {
+
+void Delivery::slotFailed(const std::exception & ex)
+{
+	ALOGE("Exception in a queued slot, the call is lost: %s", ex.what());
+}
+
+Strand::Strand(const char * name, EventLoop & loop, std::size_t connections) :
+	Trackable(),
+	strandName(name),
+	loop(loop),
+	active(false),
+	draining(false)
+{
+	ready.reserve(connections);
+	delivering.reserve(connections);
+}
+
+Strand::~Strand()
+{
+	waitIdle();
+}
+
+bool Strand::submitDrain()
+{
+	if(draining)
+		return true;
+
+	if(!loop.submit([this] { drain(); }))
+		return false;
+
+	draining = true;
+	return true;
+}
+
+bool Strand::schedule(const std::shared_ptr<Delivery> & delivery)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Once inactive, calls go through the strand until the pending ones are delivered, so the
+	// emitting thread can't overtake them
+	if(!active && !draining)
+		return false;
+
+	ready.push_back(delivery);
+
+	if(submitDrain())
+		return true;
+
+	// The event loop is stopped, the emitting thread delivers the calls
+	ready.pop_back();
+	return false;
+}
+
+bool Strand::isActive() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return active;
+}
+
+void Strand::drain()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while(!ready.empty())
+	{
+		std::swap(ready, delivering);
+		lock.unlock();
+
+		for(auto & delivery : delivering)
+		{
+			if(delivery->deliver())
+			{
+				std::lock_guard<std::mutex> again(mutex);
+				ready.push_back(std::move(delivery));
+			}
+		}
+
+		delivering.clear();
+		lock.lock();
+	}
+
+	draining = false;
+	lock.unlock();
+
+	idle.notify_all();
+}
+
+int Strand::activate()
+{
+	ALOGI("Activate strand %s", strandName.c_str());
+
+	std::lock_guard<std::mutex> lock(mutex);
+	active = true;
+
+	return 0;
+}
+
+int Strand::deactivate()
+{
+	ALOGI("Deactivate strand %s", strandName.c_str());
+
+	std::lock_guard<std::mutex> lock(mutex);
+	active = false;
+
+	return 0;
+}
+
+void Strand::waitIdle()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this] { return !draining; });
+}
+
+} // namespace thread
+} // namespace stm
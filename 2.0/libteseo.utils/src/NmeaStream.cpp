@@ -36,6 +36,8 @@
 #include <unistd.h>
 #include <termios.h>
 
+#include <cstring>
+
 #include <teseo/utils/errors.h>
 #include <teseo/utils/Wakelock.h>
 
@@ -43,82 +45,199 @@ namespace stm {
 namespace stream {
 
 NmeaStream::NmeaStream() :
-	IStream()
-{
-	buffer.reserve(255);
-}
+	IStream(),
+	state(FrameState::SEARCH),
+	checksum(0),
+	frameStats({0, 0, 0})
+{ }
 
 NmeaStream::~NmeaStream()
 { }
 
-void append(ByteVector & buffer, ByteVector::iterator first, ByteVector::iterator last)
+static constexpr uint64_t ONES = 0x0101010101010101ULL;
+
+static constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+
+/**
+ * @brief      Check if a word contains a given byte
+ */
+static inline bool wordHasByte(uint64_t word, uint8_t b)
 {
-	for(auto it = first; it != last; ++it)
-	{
-		uint8_t tmp = *it;
+	uint64_t x = word ^ (ONES * b);
+	return ((x - ONES) & ~x & HIGHS) != 0;
+}
 
-		if(tmp != '\r' && tmp != '\n' && tmp != '\0')
-			buffer.push_back(tmp);
-	}
+/**
+ * @brief      Check if a word contains one of the sentence delimiters: '$', '*', '\r' or '\n'
+ */
+static inline bool wordHasDelimiter(uint64_t word)
+{
+	return wordHasByte(word, '$') || wordHasByte(word, '*') ||
+		wordHasByte(word, '\r') || wordHasByte(word, '\n');
 }
 
-void NmeaStream::onNewBytes(const ByteVector & bytes)
+static inline bool isDelimiter(uint8_t b)
 {
-	if(bytes.size() > 0)
+	return b == '$' || b == '*' || b == '\r' || b == '\n';
+}
+
+/**
+ * @brief      XOR all the bytes of a word together
+ */
+static inline uint8_t foldXor(uint64_t word)
+{
+	word ^= word >> 32;
+	word ^= word >> 16;
+	word ^= word >> 8;
+	return static_cast<uint8_t>(word);
+}
+
+void NmeaStream::startSentence()
+{
+	sentence = pool.acquire();
+	sentence->push_back('$');
+	checksum = 0;
+	state = FrameState::BODY;
+}
+
+void NmeaStream::dropSentence(uint64_t & counter)
+{
+	counter++;
+	sentence.reset();
+	state = FrameState::SEARCH;
+}
+
+void NmeaStream::onNewBytes(ByteView bytes)
+{
+	const uint8_t * it = bytes.begin();
+	const uint8_t * end = bytes.end();
+
+	/*
+	 * The framer is a state machine resumed at each call, a sentence can span any number of
+	 * reads. A '$' always starts a new sentence: a sentence interrupted by a '$' is dropped and the
+	 * next one is framed from there.
+	 */
+	while(it != end)
 	{
-		auto start = bytes.begin();
-		auto bytesEnd = bytes.end();
-
-		/*
-			* This for loop is responsible of splitting the stream at each $.
-			* 
-			* When a $ is found its position is store in end, then we remove any trailing '\r' or
-			* '\n'.
-			* 
-			* If start is below end, the data from start (included) to end (excluded) is appended
-			* to buffer.
-			* 
-			* The buffer is sent for processing, then cleared.
-			* 
-			* The new frame start is set at dollar position.
-			*/
-		for(auto it = start; it != bytesEnd; ++it)
+		switch(state)
 		{
-			if(*it == '$')
+			case FrameState::SEARCH:
 			{
-				auto end = it;
+				auto dollar = static_cast<const uint8_t *>(std::memchr(it, '$', end - it));
+				if(dollar == nullptr)
+					return;
 
-				// Remove any \n or \r just before the dollar
-				if(*(end - 1) == '\r' || *(end - 1) == '\n')
-					end--;
+				startSentence();
+				it = dollar + 1;
+				break;
+			}
+
+			case FrameState::BODY:
+			{
+				const uint8_t * run = it;
+				uint64_t wordChecksum = 0;
+
+				// Word at a time until a word contains a delimiter, then byte at a time
+				while(end - it >= 8)
+				{
+					uint64_t word;
+					std::memcpy(&word, it, sizeof(word));
+
+					if(wordHasDelimiter(word))
+						break;
+
+					wordChecksum ^= word;
+					it += 8;
+				}
+
+				while(it != end && !isDelimiter(*it))
+					checksum ^= *it++;
 
-				if(*(end - 1) == '\r' || *(end - 1) == '\n')
-					end--;
+				checksum ^= foldXor(wordChecksum);
 
-				// Append data to buffer
-				if(start < end)
-					buffer.insert(buffer.end(), start, end);
-				
-				// Send and clear buffer
-				newSentence(ByteVectorPtr(new ByteVector(buffer.begin(), buffer.end())));
-				buffer.clear();
+				if(sentence->size() + (it - run) > NMEA_STREAM_MAX_SENTENCE_SIZE)
+				{
+					dropSentence(frameStats.malformed);
+					break;
+				}
 
-				// Set start to dollar position
-				start = it;
+				sentence->insert(sentence->end(), run, it);
+
+				if(it == end)
+					return;
+
+				if(*it == '*')
+				{
+					sentence->push_back('*');
+					state = FrameState::CHECKSUM_HIGH;
+					++it;
+				}
+				else if(*it == '$')
+				{
+					// Truncated sentence, the '$' is handled by the SEARCH state
+					dropSentence(frameStats.malformed);
+				}
+				else
+				{
+					// Line end without checksum
+					dropSentence(frameStats.malformed);
+					++it;
+				}
+				break;
 			}
-		}
 
-		// Append the rest of the readed bytes to the buffer
-		if(start < bytesEnd)
-			buffer.insert(buffer.end(), start, bytesEnd);
-	}
-	else if(bytes.size() == 0)
-	{
-		// log disabled because it happens too often since read function has timeout
-		//ALOGW("0 bytes received");
+			case FrameState::CHECKSUM_HIGH:
+			{
+				bool invalidChar = false;
+				utils::hexCharToValue(*it, invalidChar);
+
+				if(invalidChar)
+				{
+					dropSentence(frameStats.malformed);
+					break;
+				}
+
+				sentence->push_back(*it++);
+				state = FrameState::CHECKSUM_LOW;
+				break;
+			}
+
+			case FrameState::CHECKSUM_LOW:
+			{
+				bool invalidChar = false;
+				uint8_t expected = utils::asciiToByte(sentence->back(), *it, invalidChar);
+
+				if(invalidChar)
+				{
+					dropSentence(frameStats.malformed);
+					break;
+				}
+
+				sentence->push_back(*it++);
+
+				if(expected != checksum)
+				{
+					dropSentence(frameStats.checksumErrors);
+					break;
+				}
+
+				frameStats.sentences++;
+				state = FrameState::SEARCH;
+
+				ByteVectorPtr complete;
+				complete.swap(sentence);
+				newSentence(complete);
+				break;
+			}
+		}
 	}
 }
 
+const NmeaStream::Stats & NmeaStream::stats() const
+{
+	return frameStats;
+}
+
 void NmeaStream::write(ByteVectorPtr bytes)
 {
 	uint8_t crc = 0;
@@ -0,0 +1,314 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief NMEA numeric field parsers
+ * @file NumberParser.cpp
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#include <teseo/utils/NumberParser.h>
+
+#include <limits>
+
+namespace stm {
+namespace utils {
+
+/**
+ * Powers of ten up to 10^FIXED_POINT_MAX_DIGITS, exactly representable as double
+ */
+static constexpr double doublePow10[FIXED_POINT_MAX_DIGITS + 1] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,
+	1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+};
+
+static constexpr int64_t integerPow10[FIXED_POINT_MAX_DIGITS + 1] = {
+	1LL,
+	10LL,
+	100LL,
+	1000LL,
+	10000LL,
+	100000LL,
+	1000000LL,
+	10000000LL,
+	100000000LL,
+	1000000000LL,
+	10000000000LL,
+	100000000000LL,
+	1000000000000LL,
+	10000000000000LL,
+	100000000000000LL,
+	1000000000000000LL,
+	10000000000000000LL,
+	100000000000000000LL,
+	1000000000000000000LL
+};
+
+/**
+ * Degrees of a coordinate can't exceed this value
+ */
+static constexpr int32_t COORDINATE_MAX_DEGREES = 180;
+
+static inline bool isDigit(uint8_t c)
+{
+	return static_cast<uint8_t>(c - '0') < 10;
+}
+
+double FixedPoint::toDouble() const
+{
+	// Both operands are exact when the mantissa is below 2^53, the division is correctly rounded
+	return static_cast<double>(mantissa) / doublePow10[scale <= FIXED_POINT_MAX_DIGITS ? scale : 0];
+}
+
+int64_t FixedPoint::rescale(unsigned int newScale) const
+{
+	if(newScale >= scale)
+	{
+		const unsigned int shift = newScale - scale;
+		return shift <= FIXED_POINT_MAX_DIGITS ? mantissa * integerPow10[shift] : 0;
+	}
+
+	const unsigned int shift = scale - newScale;
+	return shift <= FIXED_POINT_MAX_DIGITS ? mantissa / integerPow10[shift] : 0;
+}
+
+ParseStatus parseInteger(const uint8_t * first, const uint8_t * last, int32_t & out) noexcept
+{
+	if(first == last)
+		return ParseStatus::EMPTY;
+
+	bool negative = false;
+
+	if(*first == '-' || *first == '+')
+	{
+		negative = *first == '-';
+		++first;
+
+		if(first == last)
+			return ParseStatus::INVALID;
+	}
+
+	// Accumulate the magnitude, the negative range is one unit larger
+	const int64_t limit = static_cast<int64_t>(std::numeric_limits<int32_t>::max()) + (negative ? 1 : 0);
+	int64_t value = 0;
+
+	for(; first != last; ++first)
+	{
+		if(!isDigit(*first))
+			return ParseStatus::INVALID;
+
+		value = value * 10 + (*first - '0');
+
+		if(value > limit)
+			return ParseStatus::OVERFLOW;
+	}
+
+	out = static_cast<int32_t>(negative ? -value : value);
+	return ParseStatus::OK;
+}
+
+ParseStatus parseInteger(const uint8_t * first, const uint8_t * last, int16_t & out) noexcept
+{
+	int32_t value;
+	ParseStatus status = parseInteger(first, last, value);
+
+	if(status != ParseStatus::OK)
+		return status;
+
+	if(value < std::numeric_limits<int16_t>::min() || value > std::numeric_limits<int16_t>::max())
+		return ParseStatus::OVERFLOW;
+
+	out = static_cast<int16_t>(value);
+	return ParseStatus::OK;
+}
+
+ParseStatus parseFixedPoint(const uint8_t * first, const uint8_t * last, FixedPoint & out) noexcept
+{
+	if(first == last)
+		return ParseStatus::EMPTY;
+
+	bool negative = false;
+
+	if(*first == '-' || *first == '+')
+	{
+		negative = *first == '-';
+		++first;
+	}
+
+	int64_t mantissa = 0;
+	unsigned int digits = 0;
+	unsigned int scale = 0;
+	bool seenDigit = false;
+	bool seenPoint = false;
+
+	for(; first != last; ++first)
+	{
+		const uint8_t c = *first;
+
+		if(isDigit(c))
+		{
+			seenDigit = true;
+
+			// Leading zeros of the integer part aren't significant
+			if(mantissa == 0 && c == '0' && !seenPoint)
+				continue;
+
+			if(++digits > FIXED_POINT_MAX_DIGITS)
+				return ParseStatus::OVERFLOW;
+
+			mantissa = mantissa * 10 + (c - '0');
+
+			if(seenPoint)
+				scale++;
+		}
+		else if(c == '.' && !seenPoint)
+		{
+			seenPoint = true;
+		}
+		else
+		{
+			return ParseStatus::INVALID;
+		}
+	}
+
+	if(!seenDigit)
+		return ParseStatus::INVALID;
+
+	out.mantissa = negative ? -mantissa : mantissa;
+	out.scale = scale;
+	return ParseStatus::OK;
+}
+
+ParseStatus parseDouble(const uint8_t * first, const uint8_t * last, double & out) noexcept
+{
+	FixedPoint value;
+	ParseStatus status = parseFixedPoint(first, last, value);
+
+	if(status == ParseStatus::OK)
+		out = value.toDouble();
+
+	return status;
+}
+
+ParseStatus parseFloat(const uint8_t * first, const uint8_t * last, float & out) noexcept
+{
+	FixedPoint value;
+	ParseStatus status = parseFixedPoint(first, last, value);
+
+	if(status == ParseStatus::OK)
+		out = static_cast<float>(value.toDouble());
+
+	return status;
+}
+
+ParseStatus parseBoolean(const uint8_t * first, const uint8_t * last, bool & out) noexcept
+{
+	int32_t value;
+	ParseStatus status = parseInteger(first, last, value);
+
+	if(status == ParseStatus::OK)
+		out = value != 0;
+
+	return status;
+}
+
+ParseStatus parseCoordinate(
+	const uint8_t * first,
+	const uint8_t * last,
+	uint8_t hemisphere,
+	double & out) noexcept
+{
+	if(first == last)
+		return ParseStatus::EMPTY;
+
+	const uint8_t * point = first;
+
+	while(point != last && *point != '.')
+		++point;
+
+	// At least the two minute digits are expected before the decimal point
+	if(point - first < 2)
+		return ParseStatus::INVALID;
+
+	const uint8_t * minutesBegin = point - 2;
+	int32_t degrees = 0;
+
+	for(const uint8_t * p = first; p != minutesBegin; ++p)
+	{
+		if(!isDigit(*p))
+			return ParseStatus::INVALID;
+
+		degrees = degrees * 10 + (*p - '0');
+
+		if(degrees > COORDINATE_MAX_DEGREES)
+			return ParseStatus::OVERFLOW;
+	}
+
+	if(!isDigit(minutesBegin[0]) || !isDigit(minutesBegin[1]))
+		return ParseStatus::INVALID;
+
+	FixedPoint minutes;
+	ParseStatus status = parseFixedPoint(minutesBegin, last, minutes);
+
+	if(status != ParseStatus::OK)
+		return status;
+
+	if(minutes.rescale(0) >= 60)
+		return ParseStatus::INVALID;
+
+	double sign;
+
+	switch(hemisphere)
+	{
+		case 'N':
+		case 'E':
+			sign = 1.;
+			break;
+
+		case 'S':
+		case 'W':
+			sign = -1.;
+			break;
+
+		default:
+			return ParseStatus::INVALID;
+	}
+
+	out = sign * (static_cast<double>(degrees) + minutes.toDouble() / 60.);
+	return ParseStatus::OK;
+}
+
+const char * parseStatusToString(ParseStatus status) noexcept
+{
+	switch(status)
+	{
+		case ParseStatus::OK:       return "OK";
+		case ParseStatus::EMPTY:    return "EMPTY";
+		case ParseStatus::INVALID:  return "INVALID";
+		case ParseStatus::OVERFLOW: return "OVERFLOW";
+	}
+
+	return "UNKNOWN";
+}
+
+} // namespace utils
+} // namespace stm
@@ -0,0 +1,88 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Reusable receive ring buffer
+ * @file ReceiveRing.cpp
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#include <teseo/utils/ReceiveRing.h>
+
+#include <algorithm>
+
+namespace stm {
+namespace stream {
+
+constexpr std::size_t ReceiveRing::MIN_CHUNK_SIZE;
+constexpr std::size_t ReceiveRing::MAX_CHUNK_SIZE;
+constexpr std::size_t ReceiveRing::DEFAULT_SLOTS;
+
+std::size_t ReceiveRing::chunkSizeForBaudrate(unsigned int baudrate)
+{
+	// 10 bits per byte on the wire (start + 8 data + stop), 20 ms of line time
+	std::size_t bytes = baudrate / 10 / 50;
+	std::size_t size = MIN_CHUNK_SIZE;
+
+	while(size < bytes && size < MAX_CHUNK_SIZE)
+		size <<= 1;
+
+	return size;
+}
+
+ReceiveRing::ReceiveRing(std::size_t chunkSize, std::size_t slots) :
+	storage(std::max<std::size_t>(chunkSize, 1) * std::max<std::size_t>(slots, 2)),
+	chunk(std::max<std::size_t>(chunkSize, 1)),
+	head(0)
+{ }
+
+uint8_t * ReceiveRing::prepare()
+{
+	// Always hand a full chunk of contiguous space, wrap early if the tail is too short
+	if(storage.size() - head < chunk)
+		head = 0;
+
+	return storage.data() + head;
+}
+
+ByteView ReceiveRing::commit(std::size_t count)
+{
+	count = std::min(count, chunk);
+
+	ByteView view(storage.data() + head, count);
+	head += count;
+
+	return view;
+}
+
+std::size_t ReceiveRing::chunkSize() const
+{
+	return chunk;
+}
+
+std::size_t ReceiveRing::capacity() const
+{
+	return storage.size();
+}
+
+} // namespace stream
+} // namespace stm
@@ -0,0 +1,405 @@
+/*
+ * This file is part of Teseo Android HAL
+ *
+ * Copyright (c) 2016-2020, STMicroelectronics - All Rights Reserved
+ * Author(s): Baudouin Feildel <baudouin.feildel@st.com> for STMicroelectronics.
+ *
+ * License terms: Apache 2.0.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Replay byte stream
+ * @file ReplayByteStream.cpp
+ * @author Baudouin Feildel <baudouin.feildel@st.com>
+ * @copyright 2020, STMicroelectronics, All rights reserved.
+ */
+
+#include <teseo/utils/ReplayByteStream.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LOG_TAG "teseo_hal_ReplayByteStream"
+#include <log/log.h>
+
+#include <teseo/utils/errors.h>
+
+namespace stm {
+namespace stream {
+
+ReplayByteStream::ReplayByteStream(
+	const std::string & source,
+	ReplayPacing pacing,
+	double speedFactor,
+	unsigned int speedDevice) :
+	AbstractByteStream(),
+	source(source),
+	pacing(pacing),
+	speedFactor(speedFactor > 0 ? speedFactor : 1.0),
+	speedDevice(speedDevice),
+	streamStatus(ByteStreamStatus::CLOSED),
+	liveFd(-1),
+	wakeupFd(-1),
+	rxRing(ReceiveRing::chunkSizeForBaudrate(speedDevice)),
+	hasPendingRecord(false),
+	replayStarted(false),
+	endReported(false),
+	captureStart(0),
+	openCount(0)
+{
+	wakeupFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	CHECK_ERROR(wakeupFd, errors::eventfd, "Replay %s wakeup event created.", source.c_str());
+}
+
+ReplayByteStream::~ReplayByteStream()
+{
+	if(this->isRunning())
+	{
+		this->stop();
+		this->join();
+	}
+
+	if(streamStatus == ByteStreamStatus::OPENED)
+	{
+		try
+		{
+			close();
+		}
+		catch(const StreamException & ex)
+		{
+			ALOGE("Error while closing replay byte stream: %s", ex.what());
+		}
+	}
+
+	if(wakeupFd != -1)
+		::close(wakeupFd);
+}
+
+const std::string & ReplayByteStream::name() const
+{
+	return source;
+}
+
+ByteStreamStatus ReplayByteStream::status() const
+{
+	return streamStatus;
+}
+
+unsigned int ReplayByteStream::baudrate() const
+{
+	return speedDevice;
+}
+
+void ReplayByteStream::open() noexcept(false)
+{
+	// Reader and writer threads both open the stream
+	std::unique_lock<std::mutex> lock(openMutex);
+
+	if(streamStatus == ByteStreamStatus::OPENED)
+	{
+		openCount++;
+		return;
+	}
+
+	struct stat st;
+	if(::stat(source.c_str(), &st) == -1)
+	{
+		errors::open(errno);
+		streamStatus = ByteStreamStatus::ERROR;
+		throw StreamOpenException();
+	}
+
+	if(S_ISREG(st.st_mode))
+	{
+		if(!captureReader.open(source, speedDevice))
+		{
+			streamStatus = ByteStreamStatus::ERROR;
+			throw StreamOpenException();
+		}
+	}
+	else
+	{
+		liveFd = ::open(source.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+		CHECK_ERROR(liveFd, errors::open, "Replay source %s opened.", source.c_str());
+
+		if(liveFd == -1)
+		{
+			streamStatus = ByteStreamStatus::ERROR;
+			throw StreamOpenException();
+		}
+
+		// Raw mode so the tty layer doesn't alter replayed bytes
+		struct termios attr;
+		if(tcgetattr(liveFd, &attr) == 0)
+		{
+			cfmakeraw(&attr);
+			tcsetattr(liveFd, TCSANOW, &attr);
+		}
+	}
+
+	hasPendingRecord = false;
+	replayStarted = false;
+	endReported = false;
+
+	streamStatus = ByteStreamStatus::OPENED;
+	openCount++;
+}
+
+void ReplayByteStream::close() noexcept(false)
+{
+	std::unique_lock<std::mutex> lock(openMutex);
+
+	if(streamStatus != ByteStreamStatus::OPENED || openCount == 0)
+	{
+		ALOGW("Replay %s isn't opened.", source.c_str());
+		return;
+	}
+
+	if(--openCount > 0)
+		return;
+
+	captureReader.close();
+
+	if(liveFd != -1)
+	{
+		::close(liveFd);
+		liveFd = -1;
+	}
+
+	streamStatus = ByteStreamStatus::CLOSED;
+}
+
+void ReplayByteStream::flush() noexcept(false)
+{
+	if(streamStatus != ByteStreamStatus::OPENED)
+		throw StreamNotOpenedException();
+
+	if(liveFd != -1)
+		tcflush(liveFd, TCIOFLUSH);
+}
+
+bool ReplayByteStream::waitUntil(std::chrono::steady_clock::time_point deadline)
+{
+	struct pollfd pfd = {wakeupFd, POLLIN, 0};
+
+	while(true)
+	{
+		auto now = std::chrono::steady_clock::now();
+		if(now >= deadline)
+			return true;
+
+		auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+		struct timespec timeout;
+		timeout.tv_sec = static_cast<time_t>(remaining.count() / 1000000000);
+		timeout.tv_nsec = static_cast<long>(remaining.count() % 1000000000);
+
+		int ret = ::ppoll(&pfd, 1, &timeout, nullptr);
+		if(ret > 0)
+		{
+			uint64_t count;
+			(void)::read(wakeupFd, &count, sizeof(count));
+			return false;
+		}
+	}
+}
+
+void ReplayByteStream::waitWakeup()
+{
+	struct pollfd pfd = {wakeupFd, POLLIN, 0};
+
+	while(::ppoll(&pfd, 1, nullptr, nullptr) <= 0)
+		continue;
+
+	uint64_t count;
+	(void)::read(wakeupFd, &count, sizeof(count));
+}
+
+ByteView ReplayByteStream::readCapture()
+{
+	while(true)
+	{
+		if(!hasPendingRecord)
+		{
+			if(!captureReader.next(pendingRecord))
+				break;
+
+			// Only replay what the device sent
+			if(pendingRecord.direction != capture::Direction::RX || pendingRecord.bytes.empty())
+				continue;
+
+			hasPendingRecord = true;
+		}
+
+		if(!replayStarted)
+		{
+			replayStarted = true;
+			replayStart = std::chrono::steady_clock::now();
+			captureStart = pendingRecord.timestamp;
+		}
+
+		if(pacing != ReplayPacing::AS_FAST_AS_POSSIBLE)
+		{
+			double factor = pacing == ReplayPacing::SCALED ? speedFactor : 1.0;
+			auto offset = std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(
+				(pendingRecord.timestamp - captureStart).count() / factor));
+
+			if(!waitUntil(replayStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset)))
+				return ByteView();
+		}
+
+		hasPendingRecord = false;
+		return pendingRecord.bytes;
+	}
+
+	if(!endReported)
+	{
+		endReported = true;
+		ALOGI("End of capture %s", source.c_str());
+		endOfCapture();
+	}
+
+	waitWakeup();
+	return ByteView();
+}
+
+ByteView ReplayByteStream::readLive()
+{
+	struct pollfd pfds[2] = {
+		{liveFd, POLLIN, 0},
+		{wakeupFd, POLLIN, 0}
+	};
+
+	int ret = ::ppoll(pfds, 2, nullptr, nullptr);
+	if(ret == -1)
+	{
+		if(errno == EINTR)
+			return ByteView();
+
+		errors::read(errno);
+		throw StreamException(StreamException::READ);
+	}
+
+	if(pfds[1].revents & POLLIN)
+	{
+		uint64_t count;
+		(void)::read(wakeupFd, &count, sizeof(count));
+		return ByteView();
+	}
+
+	if(pfds[0].revents == 0)
+		return ByteView();
+
+	uint8_t * bytes = rxRing.prepare();
+	ssize_t nbBytes = ::read(liveFd, bytes, rxRing.chunkSize());
+
+	// A pty returns EIO (or 0) once the other side is closed: end of the replay
+	if(nbBytes == 0 || (nbBytes == -1 && errno == EIO))
+	{
+		if(!endReported)
+		{
+			endReported = true;
+			ALOGI("Replay source %s closed", source.c_str());
+			endOfCapture();
+		}
+
+		waitWakeup();
+		return ByteView();
+	}
+
+	if(nbBytes == -1)
+	{
+		if(errno == EINTR || errno == EAGAIN)
+			return ByteView();
+
+		errors::read(errno);
+		throw StreamException(StreamException::READ);
+	}
+
+	return rxRing.commit(static_cast<std::size_t>(nbBytes));
+}
+
+ByteView ReplayByteStream::perform_read() noexcept(false)
+{
+	if(streamStatus != ByteStreamStatus::OPENED)
+	{
+		ALOGW("Can't read from closed replay stream");
+		throw StreamException(StreamException::NOT_OPENED);
+	}
+
+	return liveFd != -1 ? readLive() : readCapture();
+}
+
+void ReplayByteStream::perform_write(const std::vector<ByteVectorPtr> & messages) noexcept(false)
+{
+	if(streamStatus != ByteStreamStatus::OPENED)
+	{
+		ALOGE("Replay stream isn't opened, can't write to it.");
+		throw StreamException(StreamException::NOT_OPENED);
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(writtenMutex);
+		for(const auto & bytes : messages)
+			written.push_back(*bytes);
+	}
+
+	if(liveFd == -1)
+		return;
+
+	for(const auto & bytes : messages)
+	{
+		std::size_t done = 0;
+		while(done < bytes->size())
+		{
+			ssize_t nbBytes = ::write(liveFd, bytes->data() + done, bytes->size() - done);
+
+			if(nbBytes == -1)
+			{
+				if(errno == EINTR)
+					continue;
+
+				errors::write(errno);
+				throw StreamException(StreamException::WRITE);
+			}
+
+			done += static_cast<std::size_t>(nbBytes);
+		}
+	}
+}
+
+void ReplayByteStream::wakeup() noexcept
+{
+	if(wakeupFd == -1)
+		return;
+
+	uint64_t one = 1;
+	if(::write(wakeupFd, &one, sizeof(one)) == -1)
+		ALOGW("Unable to wake up replay %s reader", source.c_str());
+}
+
+std::vector<ByteVector> ReplayByteStream::takeWritten()
+{
+	std::unique_lock<std::mutex> lock(writtenMutex);
+	std::vector<ByteVector> out;
+	out.swap(written);
+	return out;
+}
+
+} // namespace stream
+} // namespace stm
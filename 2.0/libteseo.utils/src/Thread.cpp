@@ -32,6 +32,16 @@
 
 #include <teseo/utils/Thread.h>
 
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
 namespace stm {
 namespace priv {
 
@@ -43,7 +53,87 @@ void threadStart(void * rawThreadPtr)
 } // namespace priv
 
 Thread::CreateThreadCb Thread::createThread = nullptr;
-std::vector<std::unique_ptr<Thread::ThreadFuncArgs>> sThreadFuncArgsList;
+
+static std::mutex settingsMutex;
+static std::map<std::string, ThreadSettings> settingsByName;
+
+bool ThreadSettings::parsePolicy(const std::string & name, Policy & policy)
+{
+	static const std::pair<const char *, Policy> policies[] = {
+		{"",      Policy::INHERIT},
+		{"other", Policy::OTHER},
+		{"batch", Policy::BATCH},
+		{"idle",  Policy::IDLE},
+		{"fifo",  Policy::FIFO},
+		{"rr",    Policy::RR}
+	};
+
+	for(const auto & p : policies)
+	{
+		if(name == p.first)
+		{
+			policy = p.second;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief      Apply the settings to the calling thread
+ *
+ * @details    On Linux the scheduling functions called with pid 0 only change the calling thread.
+ * Errors are logged and the thread runs with its current settings, real-time policies need the
+ * CAP_SYS_NICE capability for example.
+ */
+static void applySettings(const std::string & name, const ThreadSettings & settings)
+{
+	using Policy = ThreadSettings::Policy;
+
+	if(!settings.affinity.empty())
+	{
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+
+		for(unsigned int cpu : settings.affinity)
+		{
+			if(cpu < CPU_SETSIZE)
+				CPU_SET(cpu, &cpus);
+		}
+
+		if(sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+			ALOGW("Unable to set the CPU affinity of thread %s: %s", name.c_str(), strerror(errno));
+	}
+
+	if(settings.policy == Policy::INHERIT)
+		return;
+
+	const bool realTime = settings.policy == Policy::FIFO || settings.policy == Policy::RR;
+	int policy = SCHED_OTHER;
+
+	switch(settings.policy)
+	{
+		case Policy::BATCH: policy = SCHED_BATCH; break;
+		case Policy::IDLE:  policy = SCHED_IDLE;  break;
+		case Policy::FIFO:  policy = SCHED_FIFO;  break;
+		case Policy::RR:    policy = SCHED_RR;    break;
+		default: break;
+	}
+
+	struct sched_param param;
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = realTime ? settings.priority : 0;
+
+	if(sched_setscheduler(0, policy, &param) != 0)
+	{
+		ALOGW("Unable to set the scheduling policy of thread %s: %s", name.c_str(), strerror(errno));
+		return;
+	}
+
+	if(!realTime && settings.policy != Policy::IDLE && setpriority(PRIO_PROCESS, 0, settings.priority) != 0)
+		ALOGW("Unable to set the nice value of thread %s: %s", name.c_str(), strerror(errno));
+}
 
 void Thread::runWrapper()
 {
@@ -79,7 +169,7 @@ int Thread::start()
 	if(!running)
 	{
 		handle = createThread(name.c_str(), &priv::threadStart, this);
-		return handle != 0;
+		return handle != 0 ? 0 : 1;
 	}
 	else
 	{
@@ -93,6 +183,20 @@ void Thread::setCreateThreadCb(CreateThreadCb cb)
 	createThread = cb;
 }
 
+void Thread::setSettings(const std::string & name, const ThreadSettings & settings)
+{
+	std::lock_guard<std::mutex> lock(settingsMutex);
+	settingsByName[name] = settings;
+}
+
+ThreadSettings Thread::getSettings(const std::string & name)
+{
+	std::lock_guard<std::mutex> lock(settingsMutex);
+	auto it = settingsByName.find(name);
+
+	return it != settingsByName.end() ? it->second : ThreadSettings();
+}
+
 bool Thread::isRunning() const
 {
 	return running;
@@ -100,28 +204,41 @@ bool Thread::isRunning() const
 
 void* Thread::threadFunc(void* arg)
 {
-    Thread::ThreadFuncArgs* threadArgs = reinterpret_cast<Thread::ThreadFuncArgs*>(arg);
+    // The thread owns its arguments, they are released when it exits
+    std::unique_ptr<Thread::ThreadFuncArgs> threadArgs(reinterpret_cast<Thread::ThreadFuncArgs*>(arg));
+    applySettings(threadArgs->name, threadArgs->settings);
     threadArgs->fptr(threadArgs->args);
     return nullptr;
 }
 
 pthread_t Thread::createPthread(const char* name,
     void (*start)(void*),
-    void* arg,
-    std::vector<std::unique_ptr<Thread::ThreadFuncArgs>> * listArgs)
+    void* arg)
 {
-    pthread_t threadId;
-    auto threadArgs = new Thread::ThreadFuncArgs(start, arg);
-    auto argPtr = std::unique_ptr<Thread::ThreadFuncArgs>(threadArgs);
+    pthread_t threadId = 0;
+    auto threadArgs = new Thread::ThreadFuncArgs(name, start, arg);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
 
-    listArgs->push_back(std::move(argPtr));
+    if (threadArgs->settings.stackSize != 0) {
+        std::size_t stackSize = std::max<std::size_t>(threadArgs->settings.stackSize, PTHREAD_STACK_MIN);
+
+        if (pthread_attr_setstacksize(&attr, stackSize) != 0) {
+            ALOGW("Invalid stack size %zu for thread %s", stackSize, name);
+        }
+    }
 
     int ret = pthread_create(&threadId,
-                nullptr,
+                &attr,
                 Thread::threadFunc,
                 reinterpret_cast<void*>(threadArgs));
+    pthread_attr_destroy(&attr);
+
     if (ret != 0) {
         ALOGE("pthread creation unsuccessful");
+        delete threadArgs;
+        threadId = 0;
     } else {
         pthread_setname_np(threadId, name);
     }
@@ -30,6 +30,7 @@
 
 #define LOG_TAG "teseo_hal_utils_Time"
 #include <log/log.h>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <cstring>
@@ -46,8 +47,18 @@ static struct {
 	time_point<system_clock> timePoint;
 } utcNow;
 
-static time_point<system_clock> utcTodayOffset;
+/**
+ * Start of the UTC day of the injected time, in milliseconds since the epoch
+ */
+static std::atomic<int64_t> utcTodayOffset(0);
+
+/**
+ * Last date converted by parseTimeAndDate(): date key in the 32 most significant bits, days since
+ * the epoch in the 32 least significant bits. A single atomic word keeps both values consistent.
+ */
+static std::atomic<uint64_t> lastDate(0);
 
+static constexpr int64_t MS_PER_DAY = 86400000;
 
 int injectTime(GnssUtcTime time, int64_t timeReference, int uncertainty)
 {
@@ -61,15 +72,13 @@ int injectTime(GnssUtcTime time, int64_t timeReference, int uncertainty)
 
 	ALOGI("Date time: %s", time2string(utcNow.timePoint).c_str());
 
-	time_t timestamp = system_clock::to_time_t(utcNow.timePoint);
-	tm timeInfo;
-	memcpy(&timeInfo, gmtime(&timestamp), sizeof(tm));
+	// Floor division, times before the epoch belong to the previous day
+	int64_t dayTime = time % MS_PER_DAY;
 
-	timeInfo.tm_sec = 0;
-	timeInfo.tm_min = 0;
-	timeInfo.tm_hour = 0;
+	if(dayTime < 0)
+		dayTime += MS_PER_DAY;
 
-	utcTodayOffset = system_clock::from_time_t(mktime(&timeInfo));
+	utcTodayOffset.store(time - dayTime, std::memory_order_relaxed);
 
 	return 0;
 }
@@ -85,62 +94,123 @@ std::optional<GnssUtcTime> parseTimestamp(const ByteVector & vec)
 	return parseTimestamp(vec.cbegin(), vec.cend());
 }
 
-constexpr int PARSER_HOUR_SIZE = 2, PARSER_HOUR_OFFSET = 0;
-constexpr int PARSER_MIN_SIZE  = 2, PARSER_MIN_OFFSET  = 2;
-constexpr int PARSER_SEC_SIZE  = 2, PARSER_SEC_OFFSET  = 4;
-constexpr int PARSER_MSEC_SIZE = 3, PARSER_MSEC_OFFSET = 7;
-constexpr int PARSER_DAY_SIZE = 2, PARSER_DAY_OFFSET = 0;
-constexpr int PARSER_MONTH_SIZE  = 2, PARSER_MONTH_OFFSET  = 2;
-constexpr int PARSER_YEAR_SIZE  = 2, PARSER_YEAR_OFFSET  = 4;
-std::optional<GnssUtcTime> parseTimeAndDate(const ByteVector & time, const ByteVector & date)
+constexpr std::size_t PARSER_HOUR_SIZE  = 2, PARSER_HOUR_OFFSET  = 0;
+constexpr std::size_t PARSER_MIN_SIZE   = 2, PARSER_MIN_OFFSET   = 2;
+constexpr std::size_t PARSER_SEC_SIZE   = 2, PARSER_SEC_OFFSET   = 4;
+constexpr std::size_t PARSER_POINT_OFFSET = 6;
+constexpr std::size_t PARSER_MSEC_OFFSET  = 7;
+constexpr std::size_t PARSER_DAY_SIZE   = 2, PARSER_DAY_OFFSET   = 0;
+constexpr std::size_t PARSER_MONTH_SIZE = 2, PARSER_MONTH_OFFSET = 2;
+constexpr std::size_t PARSER_YEAR_SIZE  = 2, PARSER_YEAR_OFFSET  = 4;
+
+/**
+ * @brief      Parse a fixed width decimal field of a time or date
+ *
+ * @return     False if the bytes are too short or aren't digits
+ */
+static bool parseDigits(ByteView bytes, std::size_t offset, std::size_t size, int & out)
 {
-	tm timestamp;
-	int msec;
-	time_point<system_clock> resultTime;
-	struct timeval tv;
-	struct timezone tz;
-
-	timestamp.tm_isdst = 0;
-	gettimeofday(&tv, &tz);
-
-	if(auto opt = utils::byteVectorParse<int>(time.begin() + PARSER_HOUR_OFFSET, time.begin() + PARSER_HOUR_OFFSET + PARSER_HOUR_SIZE))
-		timestamp.tm_hour = *opt;
-	else
-		throw std::runtime_error("Unable to parse hour");
-
-	if(auto opt = utils::byteVectorParse<int>(time.begin() + PARSER_MIN_OFFSET, time.begin() + PARSER_MIN_OFFSET + PARSER_MIN_SIZE))
-		timestamp.tm_min = *opt;
-	else
-		throw std::runtime_error("Unable to parse min");
-
-	if(auto opt = utils::byteVectorParse<int>(time.begin() + PARSER_SEC_OFFSET, time.begin() + PARSER_SEC_OFFSET + PARSER_SEC_SIZE))
-		timestamp.tm_sec = *opt;
-	else
-		throw std::runtime_error("Unable to parse sec");
-
-	if(auto opt = utils::byteVectorParse<int>(time.begin() + PARSER_MSEC_OFFSET, time.begin() + PARSER_MSEC_OFFSET + PARSER_MSEC_SIZE))
-		msec = *opt;
-	else
-		throw std::runtime_error("Unable to parse msec");
-
-	if(auto opt = utils::byteVectorParse<int>(date.begin() + PARSER_DAY_OFFSET, date.begin() + PARSER_DAY_OFFSET + PARSER_DAY_SIZE))
-		timestamp.tm_mday = *opt;
-	else
-		throw std::runtime_error("Unable to parse day");
-
-	if(auto opt = utils::byteVectorParse<int>(date.begin() + PARSER_MONTH_OFFSET, date.begin() + PARSER_MONTH_OFFSET + PARSER_MONTH_SIZE))
-		timestamp.tm_mon = *opt - 1;
-	else
-		throw std::runtime_error("Unable to parse month");
-
-	if(auto opt = utils::byteVectorParse<int>(date.begin() + PARSER_YEAR_OFFSET, date.begin() + PARSER_YEAR_OFFSET + PARSER_YEAR_SIZE))
-		timestamp.tm_year = (*opt+100);
-	else
-		throw std::runtime_error("Unable to parse year");
-
-	resultTime = system_clock::from_time_t(mktime(&timestamp));
-
-	return duration_cast<milliseconds>(resultTime.time_since_epoch()).count() + msec - (tz.tz_minuteswest*60*1000);
+	if(bytes.size() < offset + size)
+		return false;
+
+	int value = 0;
+
+	for(std::size_t i = offset; i < offset + size; i++)
+	{
+		const uint8_t digit = static_cast<uint8_t>(bytes[i] - '0');
+
+		if(digit > 9)
+			return false;
+
+		value = value * 10 + digit;
+	}
+
+	out = value;
+	return true;
+}
+
+/**
+ * @brief      Parse a 'hhmmss.sss' time to milliseconds since the beginning of the day
+ *
+ * @details    The fractional part is optional, digits after the milliseconds are ignored.
+ */
+static bool parseTimeOfDay(ByteView time, int64_t & out)
+{
+	int hour, min, sec;
+	int msec = 0;
+
+	if(!parseDigits(time, PARSER_HOUR_OFFSET, PARSER_HOUR_SIZE, hour) ||
+	   !parseDigits(time, PARSER_MIN_OFFSET, PARSER_MIN_SIZE, min) ||
+	   !parseDigits(time, PARSER_SEC_OFFSET, PARSER_SEC_SIZE, sec))
+		return false;
+
+	if(time.size() > PARSER_POINT_OFFSET)
+	{
+		if(time[PARSER_POINT_OFFSET] != '.')
+			return false;
+
+		int scale = 100;
+
+		for(std::size_t i = PARSER_MSEC_OFFSET; i < time.size(); i++, scale /= 10)
+		{
+			const uint8_t digit = static_cast<uint8_t>(time[i] - '0');
+
+			if(digit > 9)
+				return false;
+
+			msec += digit * scale;
+		}
+	}
+
+	// Seconds up to 60 to allow leap seconds
+	if(hour > 23 || min > 59 || sec > 60)
+		return false;
+
+	out = ((hour * 60 + min) * 60 + sec) * 1000LL + msec;
+	return true;
+}
+
+/**
+ * @brief      Parse a 'ddmmyy' date to days since the epoch
+ *
+ * @details    The result of the last conversion is cached, it changes once a day.
+ */
+static bool parseDate(ByteView date, int64_t & out)
+{
+	int day, month, year;
+
+	if(!parseDigits(date, PARSER_DAY_OFFSET, PARSER_DAY_SIZE, day) ||
+	   !parseDigits(date, PARSER_MONTH_OFFSET, PARSER_MONTH_SIZE, month) ||
+	   !parseDigits(date, PARSER_YEAR_OFFSET, PARSER_YEAR_SIZE, year))
+		return false;
+
+	if(day < 1 || day > 31 || month < 1 || month > 12)
+		return false;
+
+	// Never zero, the month is at least 1
+	const uint64_t key = static_cast<uint64_t>(year * 10000 + month * 100 + day);
+	const uint64_t cached = lastDate.load(std::memory_order_relaxed);
+
+	if((cached >> 32) == key)
+	{
+		out = static_cast<int64_t>(cached & 0xFFFFFFFFULL);
+		return true;
+	}
+
+	// Two digit years are in the 2000-2099 range
+	out = daysFromCivil(2000 + year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+	lastDate.store((key << 32) | static_cast<uint64_t>(out), std::memory_order_relaxed);
+	return true;
+}
+
+std::optional<GnssUtcTime> parseTimeAndDate(ByteView time, ByteView date)
+{
+	int64_t timeOfDay, days;
+
+	if(!parseTimeOfDay(time, timeOfDay) || !parseDate(date, days))
+		return {};
+
+	return days * MS_PER_DAY + timeOfDay;
 }
 
 std::string time2string(GnssUtcTime tp)
@@ -155,41 +225,19 @@ GnssUtcTime utc_timestamp_to_gps_timestamp(GnssUtcTime tp)
 	return tp - 315964800000;
 }
 
-// Timestamp expected format : hhmmss.msec
-//                             0123456789.
-// We ignore the '.' before msec field as it make the parse int function crash
-
-
 std::optional<GnssUtcTime> parseTimestamp(
 	const ByteVector::const_iterator & begin,
 	const ByteVector::const_iterator & end)
 {
-	std::optional<int> hour, min, sec, msec;
+	int64_t timeOfDay;
 
-	hour = byteVectorParse<int>(
-		begin + PARSER_HOUR_OFFSET,
-		begin + PARSER_HOUR_OFFSET + PARSER_HOUR_SIZE);
+	ByteView bytes = (begin == end) ?
+		ByteView() : ByteView(&*begin, static_cast<std::size_t>(end - begin));
 
-	min = byteVectorParse<int>(
-		begin + PARSER_MIN_OFFSET,
-		begin + PARSER_MIN_OFFSET + PARSER_MIN_SIZE);
-
-	sec = byteVectorParse<int>(
-		begin + PARSER_SEC_OFFSET,
-		begin + PARSER_SEC_OFFSET + PARSER_SEC_SIZE);
-
-	msec = byteVectorParse<int>(
-		begin + PARSER_MSEC_OFFSET,
-		begin + PARSER_MSEC_OFFSET + PARSER_MSEC_SIZE);
-
-	if(end != begin + PARSER_MSEC_OFFSET + PARSER_MSEC_SIZE)
-		ALOGW("Trailing data after timestamp");
-
-	if(hour && min && sec && msec)
-		return *msec + *sec * 1000 + *min * 60000 + *hour * 3600000 +
-			duration_cast<milliseconds>(utcTodayOffset.time_since_epoch()).count();
-	else
+	if(!parseTimeOfDay(bytes, timeOfDay))
 		return {};
+
+	return utcTodayOffset.load(std::memory_order_relaxed) + timeOfDay;
 }
 
 } // namespace utils
@@ -22,11 +22,15 @@
 #include <teseo/utils/UartByteStream.h>
 
 #include <stdexcept>
+#include <cstring>
 
 //#include <sys/types.h>
 //#include <sys/stat.h>
 #include <fcntl.h>
 #include <termios.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
 
 #define LOG_TAG "teseo_hal_UartByteStream"
 #include <log/log.h>
@@ -36,7 +40,8 @@
 #include <teseo/utils/errors.h>
 #include <unordered_map>
 
-#define UART_BYTE_STREAM_BUFFER_SIZE 255
+// Maximum number of buffers submitted to a single writev call
+#define UART_BYTE_STREAM_MAX_IOV 64
 
 namespace stm {
 namespace stream {
@@ -44,22 +49,37 @@ namespace stream {
 UartByteStream::UartByteStream(const std::string & ttyDevice, unsigned int speedDevice) :
 	AbstractByteStream(),
 	fd(-1),
+	epollFd(-1),
+	wakeupFd(-1),
 	ttyDevice(ttyDevice),
 	speedDevice(speedDevice),
+	rxBytes(0),
+	rxRing(ReceiveRing::chunkSizeForBaudrate(speedDevice)),
 	streamStatus(ByteStreamStatus::CLOSED),
-	dbgRx(13370),
-	dbgTx(13371),
 	openCount(0)
 {
-	dbgRx.start();
-	dbgTx.start();
+	// The reader sleeps in epoll_wait until the TTY has data or a wakeup is requested.
+	// Both descriptors live as long as the stream so a stop request issued while the
+	// TTY is closed is not lost.
+	epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+	CHECK_ERROR(epollFd, errors::epoll, "UART %s epoll instance created.", ttyDevice.c_str());
+
+	wakeupFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	CHECK_ERROR(wakeupFd, errors::eventfd, "UART %s wakeup event created.", ttyDevice.c_str());
+
+	if(epollFd != -1 && wakeupFd != -1)
+	{
+		struct epoll_event ev = {};
+		ev.events = EPOLLIN;
+		ev.data.fd = wakeupFd;
+
+		auto ret = ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &ev);
+		CHECK_ERROR(ret, errors::epoll, "UART %s wakeup event registered.", ttyDevice.c_str());
+	}
 }
 
 UartByteStream::~UartByteStream()
 {
-	dbgRx.stop();
-	dbgTx.stop();
-
 	if(this->isRunning())
 	{
 		this->stop();
@@ -78,6 +98,12 @@ UartByteStream::~UartByteStream()
 			ALOGE("Error: %s", ex.what());
 		}
 	}
+
+	if(wakeupFd != -1)
+		::close(wakeupFd);
+
+	if(epollFd != -1)
+		::close(epollFd);
 }
 
 const std::string & UartByteStream::name() const
@@ -90,13 +116,74 @@ ByteStreamStatus UartByteStream::status() const
 	return streamStatus;
 }
 
+unsigned int UartByteStream::baudrate() const
+{
+	return speedDevice;
+}
+
+void UartByteStream::setCaptureRecorder(std::shared_ptr<capture::CaptureRecorder> rec)
+{
+	recorder = rec;
+}
+
 static const std::unordered_map<unsigned int, speed_t> mDeviceSpeed = {
 	{9600,   B9600},
+	{19200,  B19200},
+	{38400,  B38400},
+	{57600,  B57600},
 	{115200, B115200},
+	{230400, B230400},
 	{460800, B460800},
 	{921600, B921600}
 };
 
+bool UartByteStream::setBaudrate(unsigned int speed)
+{
+	auto it = mDeviceSpeed.find(speed);
+	if(it == mDeviceSpeed.end())
+	{
+		ALOGE("UART %s doesn't support %u bauds", ttyDevice.c_str(), speed);
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(openMutex);
+
+	// Applied at next open
+	if(streamStatus != ByteStreamStatus::OPENED)
+	{
+		speedDevice = speed;
+		return true;
+	}
+
+	struct termios attr;
+	if(tcgetattr(fd, &attr) == -1)
+	{
+		ALOGE("Unable to get UART %s attributes: %s", ttyDevice.c_str(), strerror(errno));
+		return false;
+	}
+
+	cfsetispeed(&attr, it->second);
+	cfsetospeed(&attr, it->second);
+
+	// Let pending output go at the current speed, drop input received at the old speed
+	if(tcsetattr(fd, TCSADRAIN, &attr) == -1)
+	{
+		ALOGE("Unable to set UART %s speed: %s", ttyDevice.c_str(), strerror(errno));
+		return false;
+	}
+
+	tcflush(fd, TCIFLUSH);
+
+	ALOGI("UART %s speed changed from %u to %u bauds", ttyDevice.c_str(), speedDevice.load(), speed);
+	speedDevice = speed;
+	return true;
+}
+
+uint64_t UartByteStream::rxByteCount() const
+{
+	return rxBytes.load(std::memory_order_relaxed);
+}
+
 void UartByteStream::open() noexcept(false)
 {
 	// Because we use a open count we must synchronize access to open
@@ -125,7 +212,7 @@ void UartByteStream::open() noexcept(false)
 	tcgetattr(fd, &attr);
 
 	// Set input/output baudrate
-	auto it = mDeviceSpeed.find(speedDevice);
+	auto it = mDeviceSpeed.find(speedDevice.load());
 	if(it == mDeviceSpeed.end())
 	{
 		ALOGE("Error: wrong UART baud rate");
@@ -145,6 +232,22 @@ void UartByteStream::open() noexcept(false)
 	// Apply new attributes
 	tcsetattr(fd, TCSANOW, &attr);
 
+	// Watch the TTY for incoming bytes, it is removed from the set on close
+	struct epoll_event ev = {};
+	ev.events = EPOLLIN;
+	ev.data.fd = fd;
+
+	auto ret = ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+	CHECK_ERROR(ret, errors::epoll, "UART %s registered for read events.", ttyDevice.c_str());
+
+	if(ret == -1)
+	{
+		::close(fd);
+		fd = -1;
+		streamStatus = ByteStreamStatus::ERROR;
+		throw StreamOpenException();
+	}
+
 	streamStatus = ByteStreamStatus::OPENED;
 
 	flush();
@@ -200,36 +303,39 @@ void UartByteStream::close() noexcept(false)
 	}
 }
 
-ByteVector UartByteStream::perform_read() noexcept(false)
+ByteView UartByteStream::perform_read() noexcept(false)
 {
 	if(streamStatus == ByteStreamStatus::OPENED)
 	{
-		uint8_t bytes[UART_BYTE_STREAM_BUFFER_SIZE + 1] = {0};
-		ByteVector output;
+		uint8_t * bytes = rxRing.prepare();
 		ssize_t nbBytes = 0;
-fd_set set;
-		struct timeval timeout;
-		int rv;
-
-		FD_ZERO(&set); /* clear the set */
-		FD_SET(fd, &set); /* add our file descriptor to the set */
+		struct epoll_event events[2];
 
-		timeout.tv_sec = 0;
-		timeout.tv_usec = 100000;
+		// Block until bytes arrive or wakeup() is called, no timeout
+		int rv = ::epoll_wait(epollFd, events, 2, -1);
 
-		rv = select(fd + 1, &set, NULL, NULL, &timeout);
-		if(rv == 1)
-		{
-			nbBytes = ::read(fd, &bytes, UART_BYTE_STREAM_BUFFER_SIZE);
-		}
-		else if(rv == 0)
+		if(rv == -1)
 		{
-			// Not an erro, log disabled because it happens too often
-			//ALOGV("Read timeout"); /* a timeout occured */
+			// Interrupted by a signal, let the reader loop check its stop flag
+			if(errno == EINTR)
+				return ByteView();
+
+			errors::epoll(errno);
+			throw StreamException(StreamException::READ);
 		}
-		else
+
+		for(int i = 0; i < rv; i++)
 		{
-			ALOGW("Read error");
+			if(events[i].data.fd == wakeupFd)
+			{
+				uint64_t count;
+				// Reset the event counter, return value is irrelevant: the fd is non-blocking
+				(void)::read(wakeupFd, &count, sizeof(count));
+			}
+			else if(events[i].data.fd == fd)
+			{
+				nbBytes = ::read(fd, bytes, rxRing.chunkSize());
+			}
 		}
 
 		if(nbBytes == -1)
@@ -238,12 +344,11 @@ fd_set set;
 			throw StreamException(StreamException::READ);
 		}
 
-		output.reserve(nbBytes);
-
-		for(ssize_t i = 0; i < nbBytes; i++)
-			output.push_back(bytes[i]);
+		ByteView output = rxRing.commit(static_cast<std::size_t>(nbBytes));
+		rxBytes.fetch_add(output.size(), std::memory_order_relaxed);
 
-		dbgRx.send(output);
+		if(recorder)
+			recorder->append(capture::Direction::RX, output);
 		return output;
 	}
 	else
@@ -253,22 +358,56 @@ fd_set set;
 	}
 }
 
-void UartByteStream::perform_write(const ByteVectorPtr bytes) noexcept(false)
+void UartByteStream::perform_write(const std::vector<ByteVectorPtr> & messages) noexcept(false)
 {
 	if(streamStatus == ByteStreamStatus::OPENED)
 	{
-		dbgTx.send(bytes->data(), bytes->size());
-		ssize_t nbBytes = ::write(fd, bytes->data(), bytes->size());
+		struct iovec iov[UART_BYTE_STREAM_MAX_IOV];
+		std::size_t next = 0;
 
-		if(nbBytes == -1)
+		while(next < messages.size())
 		{
-			errors::write(errno);
-			throw StreamException(StreamException::WRITE);
-		}
+			// Gather as many messages as possible in one vectored write
+			int iovcnt = 0;
+			for(; next < messages.size() && iovcnt < UART_BYTE_STREAM_MAX_IOV; next++, iovcnt++)
+			{
+				const ByteVectorPtr & bytes = messages[next];
+				if(recorder)
+					recorder->append(capture::Direction::TX, *bytes);
+				iov[iovcnt].iov_base = const_cast<uint8_t *>(bytes->data());
+				iov[iovcnt].iov_len = bytes->size();
+			}
 
-		if(static_cast<std::size_t>(nbBytes) != bytes->size())
-			ALOGW("Incoherent number of bytes written: %zd != bytes->size() == %zd",
-				nbBytes, bytes->size());
+			// Resume until every byte is written, the tty may accept only part of the data
+			struct iovec * current = iov;
+			while(iovcnt > 0)
+			{
+				ssize_t nbBytes = ::writev(fd, current, iovcnt);
+
+				if(nbBytes == -1)
+				{
+					if(errno == EINTR)
+						continue;
+
+					errors::write(errno);
+					throw StreamException(StreamException::WRITE);
+				}
+
+				std::size_t written = static_cast<std::size_t>(nbBytes);
+				while(iovcnt > 0 && written >= current->iov_len)
+				{
+					written -= current->iov_len;
+					current++;
+					iovcnt--;
+				}
+
+				if(iovcnt > 0)
+				{
+					current->iov_base = static_cast<uint8_t *>(current->iov_base) + written;
+					current->iov_len -= written;
+				}
+			}
+		}
 	}
 	else
 	{
@@ -277,5 +416,15 @@ void UartByteStream::perform_write(const ByteVectorPtr bytes) noexcept(false)
 	}
 }
 
+void UartByteStream::wakeup() noexcept
+{
+	if(wakeupFd == -1)
+		return;
+
+	uint64_t one = 1;
+	if(::write(wakeupFd, &one, sizeof(one)) == -1)
+		ALOGW("Unable to wake up UART %s reader", ttyDevice.c_str());
+}
+
 } // namespace stream
 } // namespace stm
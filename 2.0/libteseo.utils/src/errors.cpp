@@ -289,4 +289,79 @@ int stm::errors::write(int err)
 	}
 
 	return err;
-}
\ No newline at end of file
+}
+int stm::errors::epoll(int err)
+{
+	switch(err)
+	{
+		case EBADF:
+			ALOGE("epoll error EBADF: epfd or fd is not a valid file descriptor.");
+			break;
+
+		case EEXIST:
+			ALOGE("epoll error EEXIST: op was EPOLL_CTL_ADD, and the supplied file descriptor fd is already registered with this epoll instance.");
+			break;
+
+		case EINTR:
+			ALOGE("epoll error EINTR: The call was interrupted by a signal handler before any of the requested events occurred.");
+			break;
+
+		case EINVAL:
+			ALOGE("epoll error EINVAL: epfd is not an epoll file descriptor, or fd is the same as epfd, or the requested operation op is not supported by this interface.");
+			break;
+
+		case EMFILE:
+			ALOGE("epoll error EMFILE: The per-process limit on the number of open file descriptors has been reached.");
+			break;
+
+		case ENFILE:
+			ALOGE("epoll error ENFILE: The system-wide limit on the total number of open files has been reached.");
+			break;
+
+		case ENOMEM:
+			ALOGE("epoll error ENOMEM: There was insufficient memory to create the kernel object or to handle the requested op control operation.");
+			break;
+
+		case EPERM:
+			ALOGE("epoll error EPERM: The target file fd does not support epoll.");
+			break;
+
+		default:
+			ALOGE("epoll error: Unknown error.");
+			break;
+	}
+
+	return err;
+}
+
+int stm::errors::eventfd(int err)
+{
+	switch(err)
+	{
+		case EINVAL:
+			ALOGE("eventfd error EINVAL: An unsupported value was specified in flags.");
+			break;
+
+		case EMFILE:
+			ALOGE("eventfd error EMFILE: The per-process limit on the number of open file descriptors has been reached.");
+			break;
+
+		case ENFILE:
+			ALOGE("eventfd error ENFILE: The system-wide limit on the total number of open files has been reached.");
+			break;
+
+		case ENODEV:
+			ALOGE("eventfd error ENODEV: Could not mount (internal) anonymous inode device.");
+			break;
+
+		case ENOMEM:
+			ALOGE("eventfd error ENOMEM: There was insufficient memory to create a new eventfd file descriptor.");
+			break;
+
+		default:
+			ALOGE("eventfd error: Unknown error.");
+			break;
+	}
+
+	return err;
+}
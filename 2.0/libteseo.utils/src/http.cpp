@@ -38,12 +38,14 @@ namespace utils {
 debug::DebugOutputStream * dbgHttp = nullptr;
 #endif
 
-void http_init()
+void http_init(thread::EventLoop & loop)
 {
 	curl_global_init(CURL_GLOBAL_ALL);
 	#ifdef DEBUG_HTTP_CLIENT
-	dbgHttp = new debug::DebugOutputStream(13372);
+	dbgHttp = new debug::DebugOutputStream(13372, loop);
 	dbgHttp->start();
+	#else
+	(void)loop;
 	#endif
 }
 